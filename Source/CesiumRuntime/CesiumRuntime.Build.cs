@@ -117,6 +117,7 @@ public class CesiumRuntime : ModuleRules
             new string[]
             {
                 "Core",
+                "DeveloperSettings",
                 // ... add other public dependencies that you statically link with here ...
             }
         );
@@ -131,6 +132,7 @@ public class CesiumRuntime : ModuleRules
                 "MeshDescription",
                 "StaticMeshDescription",
                 "HTTP",
+                "Json",
                 "LevelSequence",
                 "Projects",
                 "RenderCore",
@@ -2,7 +2,6 @@
 
 #include "Cesium3DTileset.h"
 #include "Camera/CameraTypes.h"
-#include "Camera/PlayerCameraManager.h"
 #include "Cesium3DTilesSelection/BingMapsRasterOverlay.h"
 #include "Cesium3DTilesSelection/CreditSystem.h"
 #include "Cesium3DTilesSelection/GltfContent.h"
@@ -11,26 +10,31 @@
 #include "Cesium3DTilesSelection/TilesetOptions.h"
 #include "Cesium3DTilesetRoot.h"
 #include "CesiumAsync/CachingAssetAccessor.h"
-#include "CesiumAsync/SqliteCache.h"
+#include "CesiumBoundingVolumeComponent.h"
+#include "CesiumBundle.h"
+#include "CesiumBundleAssetAccessor.h"
+#include "CesiumCacheDatabase.h"
 #include "CesiumCustomVersion.h"
+#include "CesiumExclusionZoneTileExcluder.h"
 #include "CesiumGeospatial/Cartographic.h"
 #include "CesiumGeospatial/Ellipsoid.h"
 #include "CesiumGeospatial/Transforms.h"
 #include "CesiumGltfComponent.h"
 #include "CesiumGltfPrimitiveComponent.h"
 #include "CesiumLifetime.h"
+#include "CesiumNullResourcePreparer.h"
+#include "CesiumOcclusionTileExcluder.h"
 #include "CesiumRasterOverlay.h"
 #include "CesiumRuntime.h"
+#include "CesiumStatisticsAssetAccessor.h"
 #include "CesiumTextureUtility.h"
+#include "CesiumTilesetManager.h"
+#include "CesiumTilesetStatisticsCollector.h"
 #include "CesiumTransforms.h"
-#include "Components/SceneCaptureComponent2D.h"
 #include "CreateModelOptions.h"
 #include "Engine/Engine.h"
-#include "Engine/GameViewportClient.h"
-#include "Engine/SceneCapture2D.h"
 #include "Engine/Texture.h"
 #include "Engine/Texture2D.h"
-#include "Engine/TextureRenderTarget2D.h"
 #include "Engine/World.h"
 #include "EngineUtils.h"
 #include "GameFramework/Controller.h"
@@ -41,8 +45,8 @@
 #include "LevelSequenceActor.h"
 #include "Math/UnrealMathUtility.h"
 #include "Misc/EnumRange.h"
+#include "Misc/Paths.h"
 #include "PhysicsPublicCore.h"
-#include "StereoRendering.h"
 #include "UnrealAssetAccessor.h"
 #include "UnrealTaskProcessor.h"
 #include <glm/ext/matrix_transform.hpp>
@@ -50,6 +54,7 @@
 #include <glm/trigonometric.hpp>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <type_traits>
 
 #if WITH_EDITOR
 #include "Editor.h"
@@ -64,6 +69,12 @@ ACesium3DTileset::ACesium3DTileset()
       CreditSystem(nullptr),
 
       _pTileset(nullptr),
+      _pPrefetchTileset(nullptr),
+      _pUnrealAssetAccessor(nullptr),
+      _pPrefetchUnrealAssetAccessor(nullptr),
+      _pTileAnchor(nullptr),
+      _tileAnchorPosition(0.0),
+      _tilesetToTileAnchor(1.0),
 
       _lastTilesRendered(0),
       _lastTilesLoadingLowPriority(0),
@@ -74,12 +85,25 @@ ACesium3DTileset::ACesium3DTileset()
       _lastTilesCulled(0),
       _lastMaxDepthVisited(0),
 
+      _viewUpdateRequired(true),
+      _skippedViewUpdates(0),
+
+      _collisionSettingsVersion(1),
+      _lastCollisionObjectType(ECollisionChannel::ECC_WorldStatic),
+      _lastCollisionResponses(),
+
       _captureMovieMode{false},
       _beforeMoviePreloadAncestors{PreloadAncestors},
       _beforeMoviePreloadSiblings{PreloadSiblings},
       _beforeMovieLoadingDescendantLimit{LoadingDescendantLimit},
       _beforeMovieKeepWorldOriginNearCamera{true},
-      _tilesToNoLongerRenderNextFrame{} {
+      _tilesToNoLongerRenderNextFrame{},
+      _tilesFadingIn{},
+      _tilesFadingOut{},
+      _rendererMemoryUsage{},
+      _rendererMemoryUsageMutex(),
+      _pStatisticsCollector(
+          std::make_shared<CesiumTilesetStatisticsCollector>()) {
 
   PrimaryActorTick.bCanEverTick = true;
 
@@ -89,6 +113,16 @@ ACesium3DTileset::ACesium3DTileset()
       CreateDefaultSubobject<UCesium3DTilesetRoot>(TEXT("Tileset"));
   this->RootComponent->SetMobility(EComponentMobility::Static);
 
+  // The transform of the tile anchor is computed in double precision from the
+  // root component's, so it must not be derived from its parent's.
+  this->_pTileAnchor =
+      CreateDefaultSubobject<USceneComponent>(TEXT("TileAnchor"));
+  this->_pTileAnchor->SetupAttachment(this->RootComponent);
+  this->_pTileAnchor->SetUsingAbsoluteLocation(true);
+  this->_pTileAnchor->SetUsingAbsoluteRotation(true);
+  this->_pTileAnchor->SetUsingAbsoluteScale(true);
+  this->_pTileAnchor->SetMobility(EComponentMobility::Movable);
+
   PlatformName = UGameplayStatics::GetPlatformName();
 }
 
@@ -228,6 +262,13 @@ void ACesium3DTileset::SetIonAccessToken(FString InAccessToken) {
   }
 }
 
+void ACesium3DTileset::SetOfflineBundle(FFilePath InOfflineBundle) {
+  if (this->OfflineBundle.FilePath != InOfflineBundle.FilePath) {
+    this->OfflineBundle = InOfflineBundle;
+    this->DestroyTileset();
+  }
+}
+
 void ACesium3DTileset::SetCreatePhysicsMeshes(bool bCreatePhysicsMeshes) {
   if (this->CreatePhysicsMeshes != bCreatePhysicsMeshes) {
     this->CreatePhysicsMeshes = bCreatePhysicsMeshes;
@@ -256,6 +297,23 @@ void ACesium3DTileset::SetEnableWaterMask(bool bEnableMask) {
   }
 }
 
+void ACesium3DTileset::SetMergeSmallPrimitives(bool bMergeSmallPrimitives) {
+  if (this->MergeSmallPrimitives != bMergeSmallPrimitives) {
+    this->MergeSmallPrimitives = bMergeSmallPrimitives;
+    this->DestroyTileset();
+  }
+}
+
+void ACesium3DTileset::SetMaximumMergedPrimitiveVertices(
+    int32 MaximumVertices) {
+  if (this->MaximumMergedPrimitiveVertices != MaximumVertices) {
+    this->MaximumMergedPrimitiveVertices = MaximumVertices;
+    if (this->MergeSmallPrimitives) {
+      this->DestroyTileset();
+    }
+  }
+}
+
 void ACesium3DTileset::SetMaterial(UMaterialInterface* InMaterial) {
   if (this->Material != InMaterial) {
     this->Material = InMaterial;
@@ -432,16 +490,65 @@ ACesium3DTileset::GetCesiumTilesetToUnrealRelativeWorldTransform() const {
       ->GetCesiumTilesetToUnrealRelativeWorldTransform();
 }
 
+const glm::dmat4&
+ACesium3DTileset::GetCesiumTilesetToTileAnchorTransform() const {
+  return this->_tilesetToTileAnchor;
+}
+
+namespace {
+/**
+ * The maximum distance of the tile anchor from the origin of the Unreal
+ * world, in Unreal units. Origin rebasing keeps that origin close to the
+ * camera, so beyond this distance, the single-precision positions of nearby
+ * tiles relative to the anchor would be noticeably inaccurate.
+ */
+constexpr double maximumTileAnchorDistance = 1000000.0;
+} // namespace
+
 void ACesium3DTileset::UpdateTransformFromCesium() {
+  if (!this->_pTileAnchor) {
+    return;
+  }
 
-  const glm::dmat4& CesiumToUnreal =
+  const glm::dmat4& tilesetToUnreal =
       this->GetCesiumTilesetToUnrealRelativeWorldTransform();
-  TArray<UCesiumGltfComponent*> gltfComponents;
-  this->GetComponents<UCesiumGltfComponent>(gltfComponents);
 
-  for (UCesiumGltfComponent* pGltf : gltfComponents) {
-    pGltf->UpdateTransformFromCesium(CesiumToUnreal);
+  glm::dvec3 anchorLocation =
+      glm::dvec3(tilesetToUnreal * glm::dvec4(this->_tileAnchorPosition, 1.0));
+  if (glm::length(anchorLocation) > maximumTileAnchorDistance) {
+    // Move the anchor to the origin of the Unreal world, and reposition all
+    // tiles relative to it.
+    this->_tileAnchorPosition =
+        glm::dvec3(glm::affineInverse(tilesetToUnreal)[3]);
+    this->_tilesetToTileAnchor =
+        glm::translate(glm::dmat4(1.0), -this->_tileAnchorPosition);
+
+    TArray<UCesiumGltfComponent*> gltfComponents;
+    this->GetComponents<UCesiumGltfComponent>(gltfComponents);
+
+    for (UCesiumGltfComponent* pGltf : gltfComponents) {
+      pGltf->UpdateTransformFromCesium(this->_tilesetToTileAnchor);
+    }
+
+    TArray<UCesiumBoundingVolumeComponent*> boundingVolumeComponents;
+    this->GetComponents<UCesiumBoundingVolumeComponent>(
+        boundingVolumeComponents);
+
+    for (UCesiumBoundingVolumeComponent* pBoundingVolume :
+         boundingVolumeComponents) {
+      pBoundingVolume->UpdateTransformFromCesium(this->_tilesetToTileAnchor);
+    }
   }
+
+  glm::dmat4 anchorToUnreal =
+      tilesetToUnreal *
+      glm::translate(glm::dmat4(1.0), this->_tileAnchorPosition);
+
+  this->_pTileAnchor->SetRelativeTransform(FTransform(FMatrix(
+      FVector(anchorToUnreal[0].x, anchorToUnreal[0].y, anchorToUnreal[0].z),
+      FVector(anchorToUnreal[1].x, anchorToUnreal[1].y, anchorToUnreal[1].z),
+      FVector(anchorToUnreal[2].x, anchorToUnreal[2].y, anchorToUnreal[2].z),
+      FVector(anchorToUnreal[3].x, anchorToUnreal[3].y, anchorToUnreal[3].z))));
 }
 
 // Called when the game starts or when spawned
@@ -484,9 +591,8 @@ void ACesium3DTileset::OnConstruction(const FTransform& Transform) {
     this->GetComponents<UCesiumGltfComponent>(gltfComponents);
 
     for (UCesiumGltfComponent* pGltf : gltfComponents) {
-      if (pGltf && IsValid(pGltf) && pGltf->IsVisible()) {
-        pGltf->SetVisibility(false, true);
-        pGltf->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+      if (pGltf && IsValid(pGltf)) {
+        pGltf->SetTileVisible(false);
       }
     }
   }
@@ -516,8 +622,11 @@ void ACesium3DTileset::NotifyHit(
 class UnrealResourcePreparer
     : public Cesium3DTilesSelection::IPrepareRendererResources {
 public:
-  UnrealResourcePreparer(ACesium3DTileset* pActor)
-      : _pActor(pActor)
+  UnrealResourcePreparer(
+      ACesium3DTileset* pActor,
+      const std::shared_ptr<CesiumTilesetStatisticsCollector>& pCollector)
+      : _pActor(pActor),
+        _pCollector(pCollector)
 #if PHYSICS_INTERFACE_PHYSX
         ,
         _pPhysXCooking(
@@ -531,9 +640,15 @@ public:
   virtual void* prepareInLoadThread(
       const CesiumGltf::Model& model,
       const glm::dmat4& transform) override {
+    SCOPE_CYCLE_COUNTER(STAT_CesiumLoadThreadPrepare);
+    this->_pCollector->beginLoadThreadPrepare();
+    double startTime = FPlatformTime::Seconds();
 
     CreateModelOptions options;
     options.alwaysIncludeTangents = this->_pActor->GetAlwaysIncludeTangents();
+    options.mergeSmallPrimitives = this->_pActor->GetMergeSmallPrimitives();
+    options.maximumMergedPrimitiveVertices =
+        this->_pActor->GetMaximumMergedPrimitiveVertices();
 
 #if PHYSICS_INTERFACE_PHYSX
     options.pPhysXCooking = this->_pPhysXCooking;
@@ -541,6 +656,16 @@ public:
 
     std::unique_ptr<UCesiumGltfComponent::HalfConstructed> pHalf =
         UCesiumGltfComponent::CreateOffGameThread(model, transform, options);
+
+    // The result holds its meshes and textures from now on, whether or not the
+    // tile is ever shown.
+    if (pHalf) {
+      this->_pActor->AddRendererMemoryUsage(pHalf->GetMemoryUsage());
+    }
+
+    this->_pCollector->endLoadThreadPrepare(
+        FPlatformTime::Seconds() - startTime,
+        pHalf != nullptr);
     return pHalf.release();
   }
 
@@ -550,16 +675,21 @@ public:
     const Cesium3DTilesSelection::TileContentLoadResult* pContent =
         tile.getContent();
     if (pContent && pContent->model) {
+      SCOPE_CYCLE_COUNTER(STAT_CesiumMainThreadPrepare);
+
       std::unique_ptr<UCesiumGltfComponent::HalfConstructed> pHalf(
           reinterpret_cast<UCesiumGltfComponent::HalfConstructed*>(
               pLoadThreadResult));
-      return UCesiumGltfComponent::CreateOnGameThread(
-          this->_pActor,
-          std::move(pHalf),
-          _pActor->GetCesiumTilesetToUnrealRelativeWorldTransform(),
-          this->_pActor->GetMaterial(),
-          this->_pActor->GetWaterMaterial(),
-          this->_pActor->GetCustomDepthParameters());
+      // The primitives are created by showTilesToRender, so that nothing is
+      // created for tiles that are unloaded before they are ever shown. Until
+      // then, the memory usage of the component is that of the result.
+      UCesiumGltfComponent* pGltf =
+          UCesiumGltfComponent::CreateDeferredOnGameThread(
+              this->_pActor,
+              std::move(pHalf));
+
+      this->_pCollector->recordMainThreadPrepare(pGltf != nullptr);
+      return pGltf;
     }
     // UE_LOG(LogCesium, VeryVerbose, TEXT("No content for tile"));
     return nullptr;
@@ -573,11 +703,16 @@ public:
       UCesiumGltfComponent::HalfConstructed* pHalf =
           reinterpret_cast<UCesiumGltfComponent::HalfConstructed*>(
               pLoadThreadResult);
+      this->_pActor->SubtractRendererMemoryUsage(pHalf->GetMemoryUsage());
       delete pHalf;
+      this->_pCollector->discardLoadThreadResult();
     } else if (pMainThreadResult) {
       UCesiumGltfComponent* pGltf =
           reinterpret_cast<UCesiumGltfComponent*>(pMainThreadResult);
+      bool shown = !pGltf->HasDeferredPrimitives();
+      this->_pActor->SubtractRendererMemoryUsage(pGltf->GetMemoryUsage());
       this->destroyRecursively(pGltf);
+      this->_pCollector->recordTileDestroyed(shown);
     }
   }
 
@@ -606,6 +741,7 @@ public:
 
     UTexture2D* pTexture = pLoadedTexture->pTexture;
     pTexture->AddToRoot();
+    this->_pActor->AddRendererMemoryUsage(getRasterMemoryUsage(pTexture));
 
     delete pLoadedTexture;
 
@@ -625,6 +761,8 @@ public:
 
     if (pMainThreadResult) {
       UTexture2D* pTexture = static_cast<UTexture2D*>(pMainThreadResult);
+      this->_pActor->SubtractRendererMemoryUsage(
+          getRasterMemoryUsage(pTexture));
       pTexture->RemoveFromRoot();
       CesiumLifetime::destroy(pTexture);
     }
@@ -674,6 +812,12 @@ public:
   }
 
 private:
+  static FCesiumTilesetMemoryUsage getRasterMemoryUsage(UTexture2D* pTexture) {
+    FCesiumTilesetMemoryUsage usage;
+    usage.TextureBytes = pTexture->CalcTextureMemorySizeEnum(TMC_AllMips);
+    return usage;
+  }
+
   void destroyRecursively(USceneComponent* pComponent) {
 
     UE_LOG(
@@ -702,44 +846,114 @@ private:
   }
 
   ACesium3DTileset* _pActor;
+  std::shared_ptr<CesiumTilesetStatisticsCollector> _pCollector;
 #if PHYSICS_INTERFACE_PHYSX
   IPhysXCooking* _pPhysXCooking;
 #endif
 };
 
-static std::string getCacheDatabaseName() {
-  // On Android, EngineUserDir returns a "fake" directory. UE's IPlatformFile
-  // knows how to resolve it, but we can't pass it to cesium-native because
-  // cesium-native expects a real path. IAndroidPlatformFile::FileRootPath
-  // looks like it should be able to resolve it for us, but that's difficult
-  // to call from here.
-
-  // At the same time, apps on Android are isolated from each other and so we
-  // can't really share a cache between them anyway. So we store the cache in a
-  // different directory on Android.
-#if PLATFORM_ANDROID
-  FString baseDirectory = FPaths::ProjectPersistentDownloadDir();
-#else
-  FString baseDirectory = FPaths::EngineUserDir();
-#endif
+/**
+ * Opens the offline bundle of a tileset, whose path may be relative to the
+ * project directory. Returns nullptr if the tileset has no bundle, or if it
+ * cannot be opened, in which case the tileset is loaded from the network.
+ */
+static std::shared_ptr<CesiumBundle>
+openOfflineBundle(const FFilePath& offlineBundle) {
+  if (offlineBundle.FilePath.IsEmpty()) {
+    return nullptr;
+  }
 
-  FString filename =
-      FPaths::Combine(baseDirectory, TEXT("cesium-request-cache.sqlite"));
-  UE_LOG(LogCesium, Verbose, TEXT("Caching Cesium requests in %s"), *filename);
-  return TCHAR_TO_UTF8(*filename);
+  FString path = offlineBundle.FilePath;
+  if (FPaths::IsRelative(path)) {
+    path = FPaths::Combine(FPaths::ProjectDir(), path);
+  }
+  path = FPaths::ConvertRelativePathToFull(path);
+
+  std::shared_ptr<CesiumBundle> pBundle = CesiumBundle::open(path);
+  if (!pBundle) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Could not open offline bundle %s, loading from the network"),
+        *path);
+  }
+  return pBundle;
 }
 
-void ACesium3DTileset::LoadTileset() {
-  static std::shared_ptr<CesiumAsync::IAssetAccessor> pAssetAccessor =
+/**
+ * Creates the asset accessor of a tileset. The request cache is shared by all
+ * tilesets, but each tileset gets its own caching accessor, so that the
+ * requests that miss the cache can be recorded in the statistics of the
+ * tileset that made them, and its own accessor that downloads assets, so that
+ * its downloads can be cancelled when it is destroyed. A tileset with an
+ * offline bundle loads all assets from the bundle instead, in which case
+ * pUnrealAssetAccessor is set to nullptr.
+ */
+static std::shared_ptr<CesiumAsync::IAssetAccessor> createAssetAccessor(
+    const std::shared_ptr<CesiumTilesetStatisticsCollector>& pCollector,
+    const std::shared_ptr<CesiumBundle>& pOfflineBundle,
+    UnrealAssetAccessor::Priority priority,
+    std::shared_ptr<UnrealAssetAccessor>& pUnrealAssetAccessor) {
+  if (pOfflineBundle) {
+    pUnrealAssetAccessor = nullptr;
+    return std::make_shared<CesiumStatisticsAssetAccessor>(
+        std::make_shared<CesiumBundleAssetAccessor>(pOfflineBundle),
+        pCollector,
+        CesiumStatisticsAssetAccessor::Record::Requests);
+  }
+
+  pUnrealAssetAccessor = std::make_shared<UnrealAssetAccessor>(priority);
+  return std::make_shared<CesiumStatisticsAssetAccessor>(
       std::make_shared<CesiumAsync::CachingAssetAccessor>(
           spdlog::default_logger(),
-          std::make_shared<UnrealAssetAccessor>(),
-          std::make_shared<CesiumAsync::SqliteCache>(
-              spdlog::default_logger(),
-              getCacheDatabaseName()));
+          std::make_shared<CesiumStatisticsAssetAccessor>(
+              pUnrealAssetAccessor,
+              pCollector,
+              CesiumStatisticsAssetAccessor::Record::Downloads),
+          CesiumCacheDatabase::getInstance()),
+      pCollector,
+      CesiumStatisticsAssetAccessor::Record::Requests);
+}
+
+static CesiumAsync::AsyncSystem& getAsyncSystem() {
   static CesiumAsync::AsyncSystem asyncSystem(
       std::make_shared<UnrealTaskProcessor>());
+  return asyncSystem;
+}
+
+// The tasks of prefetching only run when no tasks for the current views are
+// waiting.
+static CesiumAsync::AsyncSystem& getPrefetchAsyncSystem() {
+  static CesiumAsync::AsyncSystem asyncSystem(
+      std::make_shared<UnrealTaskProcessor>(
+          UnrealTaskProcessor::Priority::Low));
+  return asyncSystem;
+}
 
+static Cesium3DTilesSelection::Tileset* createNativeTileset(
+    ETilesetSource source,
+    const FString& url,
+    int64 ionAssetID,
+    const FString& ionAccessToken,
+    const Cesium3DTilesSelection::TilesetExternals& externals,
+    const Cesium3DTilesSelection::TilesetOptions& options) {
+  switch (source) {
+  case ETilesetSource::FromUrl:
+    return new Cesium3DTilesSelection::Tileset(
+        externals,
+        TCHAR_TO_UTF8(*url),
+        options);
+  case ETilesetSource::FromCesiumIon:
+    return new Cesium3DTilesSelection::Tileset(
+        externals,
+        static_cast<uint32_t>(ionAssetID),
+        TCHAR_TO_UTF8(*ionAccessToken),
+        options);
+  }
+  return nullptr;
+}
+
+void ACesium3DTileset::LoadTileset() {
   if (this->_pTileset) {
     // Tileset already loaded, do nothing.
     return;
@@ -751,13 +965,20 @@ void ACesium3DTileset::LoadTileset() {
   ACesiumCreditSystem* pCreditSystem = this->ResolveCreditSystem();
 
   Cesium3DTilesSelection::TilesetExternals externals{
-      pAssetAccessor,
-      std::make_shared<UnrealResourcePreparer>(this),
-      asyncSystem,
+      createAssetAccessor(
+          this->_pStatisticsCollector,
+          openOfflineBundle(this->OfflineBundle),
+          UnrealAssetAccessor::Priority::High,
+          this->_pUnrealAssetAccessor),
+      std::make_shared<UnrealResourcePreparer>(
+          this,
+          this->_pStatisticsCollector),
+      getAsyncSystem(),
       pCreditSystem ? pCreditSystem->GetExternalCreditSystem() : nullptr,
       spdlog::default_logger()};
 
   this->_startTime = std::chrono::high_resolution_clock::now();
+  this->_viewUpdateRequired = true;
 
   Cesium3DTilesSelection::TilesetOptions options;
 
@@ -770,13 +991,19 @@ void ACesium3DTileset::LoadTileset() {
   options.contentOptions.enableWaterMask = this->EnableWaterMask;
 #endif
 
+  this->_pExclusionZoneExcluder =
+      std::make_shared<CesiumExclusionZoneTileExcluder>();
+  this->_pExclusionZoneExcluder->setExclusionZones(this->ExclusionZones);
+  options.excluders.push_back(this->_pExclusionZoneExcluder);
+
+  this->_pOcclusionTileExcluder =
+      std::make_shared<CesiumOcclusionTileExcluder>(this->_pTileAnchor);
+  this->_pOcclusionTileExcluder->setEnabled(this->EnableOcclusionCulling);
+  options.excluders.push_back(this->_pOcclusionTileExcluder);
+
   switch (this->TilesetSource) {
   case ETilesetSource::FromUrl:
     UE_LOG(LogCesium, Log, TEXT("Loading tileset from URL %s"), *this->Url);
-    this->_pTileset = new Cesium3DTilesSelection::Tileset(
-        externals,
-        TCHAR_TO_UTF8(*this->Url),
-        options);
     break;
   case ETilesetSource::FromCesiumIon:
     UE_LOG(
@@ -784,14 +1011,17 @@ void ACesium3DTileset::LoadTileset() {
         Log,
         TEXT("Loading tileset for asset ID %d"),
         this->IonAssetID);
-    this->_pTileset = new Cesium3DTilesSelection::Tileset(
-        externals,
-        static_cast<uint32_t>(this->IonAssetID),
-        TCHAR_TO_UTF8(*this->IonAccessToken),
-        options);
     break;
   }
 
+  this->_pTileset = createNativeTileset(
+      this->TilesetSource,
+      this->Url,
+      this->IonAssetID,
+      this->IonAccessToken,
+      externals,
+      options);
+
   for (UCesiumRasterOverlay* pOverlay : rasterOverlays) {
     if (pOverlay->IsActive()) {
       pOverlay->AddToTileset();
@@ -813,6 +1043,89 @@ void ACesium3DTileset::LoadTileset() {
   }
 }
 
+void ACesium3DTileset::LoadPrefetchTileset() {
+  if (this->_pPrefetchTileset || !this->_pTileset) {
+    return;
+  }
+
+  // The requests of prefetching are recorded in the statistics of this
+  // tileset, but their downloads wait for the downloads of the current views.
+  Cesium3DTilesSelection::TilesetExternals externals{
+      createAssetAccessor(
+          this->_pStatisticsCollector,
+          openOfflineBundle(this->OfflineBundle),
+          UnrealAssetAccessor::Priority::Low,
+          this->_pPrefetchUnrealAssetAccessor),
+      std::make_shared<CesiumNullResourcePreparer>(),
+      getPrefetchAsyncSystem(),
+      nullptr,
+      spdlog::default_logger()};
+
+  // Prefetching aims straight for the detail needed at the prefetched views,
+  // without loading the levels of detail in between.
+  Cesium3DTilesSelection::TilesetOptions options;
+  options.preloadAncestors = false;
+  options.preloadSiblings = false;
+  options.forbidHoles = false;
+  options.loadingDescendantLimit = 10000;
+  options.excluders.push_back(this->_pExclusionZoneExcluder);
+
+  this->_pPrefetchTileset = createNativeTileset(
+      this->TilesetSource,
+      this->Url,
+      this->IonAssetID,
+      this->IonAccessToken,
+      externals,
+      options);
+}
+
+void ACesium3DTileset::DestroyPrefetchTileset() {
+  // The tileset waits for its loads in flight when it is destroyed, which
+  // would otherwise include all of its queued downloads.
+  if (this->_pPrefetchUnrealAssetAccessor) {
+    this->_pPrefetchUnrealAssetAccessor->cancelRequests();
+    this->_pPrefetchUnrealAssetAccessor.reset();
+  }
+
+  delete this->_pPrefetchTileset;
+  this->_pPrefetchTileset = nullptr;
+}
+
+void ACesium3DTileset::UpdatePrefetch(
+    const std::vector<Cesium3DTilesSelection::ViewState>& frustums) {
+  SCOPE_CYCLE_COUNTER(STAT_CesiumUpdatePrefetch);
+  CSV_SCOPED_TIMING_STAT(Cesium, UpdatePrefetch);
+  CesiumTilesetStatisticsCollector::ScopedGameThreadTimer timer(
+      *this->_pStatisticsCollector);
+
+  if (!this->EnablePrefetching) {
+    this->DestroyPrefetchTileset();
+    return;
+  }
+
+  // Destroying the prefetch tileset waits for its loads in flight, so it is
+  // kept between flights and updated without views instead, which lets its
+  // loads in flight complete and keeps its cache within its budget.
+  if (frustums.empty() && !this->_pPrefetchTileset) {
+    return;
+  }
+
+  this->LoadPrefetchTileset();
+  if (!this->_pPrefetchTileset) {
+    return;
+  }
+
+  Cesium3DTilesSelection::TilesetOptions& options =
+      this->_pPrefetchTileset->getOptions();
+  options.maximumScreenSpaceError =
+      static_cast<double>(this->MaximumScreenSpaceError);
+  options.maximumSimultaneousTileLoads =
+      static_cast<uint32_t>(this->MaximumSimultaneousPrefetchTileLoads);
+  options.maximumCachedBytes = this->MaximumPrefetchCachedBytes;
+
+  this->_pPrefetchTileset->updateView(frustums);
+}
+
 void ACesium3DTileset::DestroyTileset() {
 
   if (this->Url.Len() > 0) {
@@ -841,12 +1154,40 @@ void ACesium3DTileset::DestroyTileset() {
     }
   }
 
+  this->DestroyPrefetchTileset();
+
+  // The tiles in these lists are destroyed with the tileset.
+  this->_tilesToNoLongerRenderNextFrame.clear();
+  this->_tilesFadingIn.clear();
+  this->_tilesFadingOut.clear();
+
   if (!this->_pTileset) {
     return;
   }
 
+  // The bounding volumes refer to tiles of the tileset.
+  if (this->_pOcclusionTileExcluder) {
+    this->_pOcclusionTileExcluder->clear();
+  }
+
+  // The tileset waits for its loads in flight when it is destroyed, so its
+  // queued downloads are cancelled first.
+  if (this->_pUnrealAssetAccessor) {
+    this->_pUnrealAssetAccessor->cancelRequests();
+    this->_pUnrealAssetAccessor.reset();
+  }
+
   delete this->_pTileset;
   this->_pTileset = nullptr;
+  this->_pExclusionZoneExcluder.reset();
+  this->_pOcclusionTileExcluder.reset();
+
+  // Destroying the tileset frees all renderer resources, so this should
+  // already be zero, but make sure errors don't accumulate across tilesets.
+  {
+    std::lock_guard<std::mutex> lock(this->_rendererMemoryUsageMutex);
+    this->_rendererMemoryUsage = FCesiumTilesetMemoryUsage();
+  }
 
   if (this->Url.Len() > 0) {
     UE_LOG(
@@ -863,305 +1204,6 @@ void ACesium3DTileset::DestroyTileset() {
   }
 }
 
-std::vector<ACesium3DTileset::UnrealCameraParameters>
-ACesium3DTileset::GetCameras() const {
-  std::vector<UnrealCameraParameters> cameras = this->GetPlayerCameras();
-
-  std::vector<UnrealCameraParameters> sceneCaptures = this->GetSceneCaptures();
-  cameras.insert(
-      cameras.end(),
-      std::make_move_iterator(sceneCaptures.begin()),
-      std::make_move_iterator(sceneCaptures.end()));
-
-#if WITH_EDITOR
-  std::vector<UnrealCameraParameters> editorCameras = this->GetEditorCameras();
-  cameras.insert(
-      cameras.end(),
-      std::make_move_iterator(editorCameras.begin()),
-      std::make_move_iterator(editorCameras.end()));
-#endif
-
-  return cameras;
-}
-
-std::vector<ACesium3DTileset::UnrealCameraParameters>
-ACesium3DTileset::GetPlayerCameras() const {
-  UWorld* pWorld = this->GetWorld();
-  if (!pWorld) {
-    return {};
-  }
-
-  float worldToMeters = 100.0f;
-  AWorldSettings* pWorldSettings = pWorld->GetWorldSettings();
-  if (pWorldSettings) {
-    worldToMeters = pWorldSettings->WorldToMeters;
-  }
-
-  UGameViewportClient* pViewport = pWorld->GetGameViewport();
-  if (!pViewport) {
-    return {};
-  }
-
-  FVector2D size;
-  pViewport->GetViewportSize(size);
-  if (size.X < 1.0 || size.Y < 1.0) {
-    return {};
-  }
-
-  TSharedPtr<IStereoRendering, ESPMode::ThreadSafe> pStereoRendering = nullptr;
-  if (GEngine) {
-    pStereoRendering = GEngine->StereoRenderingDevice;
-  }
-
-  bool useStereoRendering = false;
-  if (pStereoRendering && pStereoRendering->IsStereoEnabled()) {
-    useStereoRendering = true;
-  }
-
-  uint32 stereoLeftSizeX = static_cast<uint32>(size.X);
-  uint32 stereoLeftSizeY = static_cast<uint32>(size.Y);
-  uint32 stereoRightSizeX = static_cast<uint32>(size.X);
-  uint32 stereoRightSizeY = static_cast<uint32>(size.Y);
-  if (useStereoRendering) {
-    int32 _x;
-    int32 _y;
-
-    pStereoRendering->AdjustViewRect(
-        EStereoscopicPass::eSSP_LEFT_EYE,
-        _x,
-        _y,
-        stereoLeftSizeX,
-        stereoLeftSizeY);
-
-    pStereoRendering->AdjustViewRect(
-        EStereoscopicPass::eSSP_RIGHT_EYE,
-        _x,
-        _y,
-        stereoRightSizeX,
-        stereoRightSizeY);
-  }
-
-  FVector2D stereoLeftSize(stereoLeftSizeX, stereoRightSizeY);
-  FVector2D stereoRightSize(stereoRightSizeX, stereoRightSizeY);
-
-  std::vector<ACesium3DTileset::UnrealCameraParameters> cameras;
-  cameras.reserve(pWorld->GetNumPlayerControllers());
-
-  for (auto playerControllerIt = pWorld->GetPlayerControllerIterator();
-       playerControllerIt;
-       playerControllerIt++) {
-
-    const TWeakObjectPtr<APlayerController> pPlayerController =
-        *playerControllerIt;
-    if (pPlayerController == nullptr) {
-      continue;
-    }
-
-    const APlayerCameraManager* pPlayerCameraManager =
-        pPlayerController->PlayerCameraManager;
-
-    if (!pPlayerCameraManager) {
-      continue;
-    }
-
-    double fov = pPlayerCameraManager->GetFOVAngle();
-
-    FVector location;
-    FRotator rotation;
-    pPlayerController->GetPlayerViewPoint(location, rotation);
-
-    if (useStereoRendering) {
-      if (stereoLeftSize.X >= 1.0 && stereoLeftSize.Y >= 1.0) {
-        FVector leftEyeLocation = location;
-        FRotator leftEyeRotation = rotation;
-        pStereoRendering->CalculateStereoViewOffset(
-            EStereoscopicPass::eSSP_LEFT_EYE,
-            leftEyeRotation,
-            worldToMeters,
-            leftEyeLocation);
-
-        FMatrix projection = pStereoRendering->GetStereoProjectionMatrix(
-            EStereoscopicPass::eSSP_LEFT_EYE);
-
-        // TODO: consider assymetric frustums using 4 fovs
-        float one_over_tan_half_hfov = projection.M[0][0];
-
-        float hfov =
-            glm::degrees(2.0f * glm::atan(1.0f / one_over_tan_half_hfov));
-
-        cameras.push_back(UnrealCameraParameters{
-            stereoLeftSize,
-            leftEyeLocation,
-            leftEyeRotation,
-            hfov});
-      }
-
-      if (stereoRightSize.X >= 1.0 && stereoRightSize.Y >= 1.0) {
-        FVector rightEyeLocation = location;
-        FRotator rightEyeRotation = rotation;
-        pStereoRendering->CalculateStereoViewOffset(
-            EStereoscopicPass::eSSP_RIGHT_EYE,
-            rightEyeRotation,
-            worldToMeters,
-            rightEyeLocation);
-
-        FMatrix projection = pStereoRendering->GetStereoProjectionMatrix(
-            EStereoscopicPass::eSSP_RIGHT_EYE);
-
-        float one_over_tan_half_hfov = projection.M[0][0];
-
-        float hfov =
-            glm::degrees(2.0f * glm::atan(1.0f / one_over_tan_half_hfov));
-
-        cameras.push_back(UnrealCameraParameters{
-            stereoRightSize,
-            rightEyeLocation,
-            rightEyeRotation,
-            hfov});
-      }
-    } else {
-      cameras.push_back(UnrealCameraParameters{size, location, rotation, fov});
-    }
-  }
-
-  return cameras;
-}
-
-std::vector<ACesium3DTileset::UnrealCameraParameters>
-ACesium3DTileset::GetSceneCaptures() const {
-  // TODO: really USceneCaptureComponent2D can be attached to any actor, is it
-  // worth searching every actor? Might it be better to provide an interface
-  // where users can volunteer cameras to be used with the tile selection as
-  // needed?
-  TArray<AActor*> sceneCaptures;
-  static TSubclassOf<ASceneCapture2D> SceneCapture2D =
-      ASceneCapture2D::StaticClass();
-  UGameplayStatics::GetAllActorsOfClass(this, SceneCapture2D, sceneCaptures);
-
-  std::vector<ACesium3DTileset::UnrealCameraParameters> cameras;
-  cameras.reserve(sceneCaptures.Num());
-
-  for (AActor* pActor : sceneCaptures) {
-    ASceneCapture2D* pSceneCapture = static_cast<ASceneCapture2D*>(pActor);
-    if (!pSceneCapture) {
-      continue;
-    }
-
-    USceneCaptureComponent2D* pSceneCaptureComponent =
-        pSceneCapture->GetCaptureComponent2D();
-    if (!pSceneCaptureComponent) {
-      continue;
-    }
-
-    if (pSceneCaptureComponent->ProjectionType !=
-        ECameraProjectionMode::Type::Perspective) {
-      continue;
-    }
-
-    UTextureRenderTarget2D* pRenderTarget =
-        pSceneCaptureComponent->TextureTarget;
-    if (!pRenderTarget) {
-      continue;
-    }
-
-    FVector2D renderTargetSize(pRenderTarget->SizeX, pRenderTarget->SizeY);
-    if (renderTargetSize.X < 1.0 || renderTargetSize.Y < 1.0) {
-      continue;
-    }
-
-    FVector captureLocation = pSceneCaptureComponent->GetComponentLocation();
-    FRotator captureRotation = pSceneCaptureComponent->GetComponentRotation();
-    float captureFov = pSceneCaptureComponent->FOVAngle;
-
-    cameras.push_back(UnrealCameraParameters{
-        renderTargetSize,
-        captureLocation,
-        captureRotation,
-        captureFov});
-  }
-
-  return cameras;
-}
-
-/*static*/ Cesium3DTilesSelection::ViewState
-ACesium3DTileset::CreateViewStateFromViewParameters(
-    const UnrealCameraParameters& camera,
-    const glm::dmat4& unrealWorldToTileset) {
-
-  double horizontalFieldOfView =
-      FMath::DegreesToRadians(camera.fieldOfViewDegrees);
-  double aspectRatio = camera.viewportSize.X / camera.viewportSize.Y;
-  double verticalFieldOfView =
-      atan(tan(horizontalFieldOfView * 0.5) / aspectRatio) * 2.0;
-
-  FVector direction = camera.rotation.RotateVector(FVector(1.0f, 0.0f, 0.0f));
-  FVector up = camera.rotation.RotateVector(FVector(0.0f, 0.0f, 1.0f));
-
-  glm::dvec3 tilesetCameraLocation = glm::dvec3(
-      unrealWorldToTileset *
-      glm::dvec4(camera.location.X, camera.location.Y, camera.location.Z, 1.0));
-  glm::dvec3 tilesetCameraFront = glm::normalize(glm::dvec3(
-      unrealWorldToTileset *
-      glm::dvec4(direction.X, direction.Y, direction.Z, 0.0)));
-  glm::dvec3 tilesetCameraUp = glm::normalize(
-      glm::dvec3(unrealWorldToTileset * glm::dvec4(up.X, up.Y, up.Z, 0.0)));
-
-  return Cesium3DTilesSelection::ViewState::create(
-      tilesetCameraLocation,
-      tilesetCameraFront,
-      tilesetCameraUp,
-      glm::dvec2(camera.viewportSize.X, camera.viewportSize.Y),
-      horizontalFieldOfView,
-      verticalFieldOfView);
-}
-
-#if WITH_EDITOR
-std::vector<ACesium3DTileset::UnrealCameraParameters>
-ACesium3DTileset::GetEditorCameras() const {
-  if (!GEditor) {
-    return {};
-  }
-
-  UWorld* pWorld = this->GetWorld();
-  if (!IsValid(pWorld)) {
-    return {};
-  }
-
-  // Do not include editor cameras when running in a game world (which includes
-  // Play-in-Editor)
-  if (pWorld->IsGameWorld()) {
-    return {};
-  }
-
-  const TArray<FEditorViewportClient*>& viewportClients =
-      GEditor->GetAllViewportClients();
-
-  std::vector<ACesium3DTileset::UnrealCameraParameters> cameras;
-  cameras.reserve(viewportClients.Num());
-
-  for (FEditorViewportClient* pEditorViewportClient : viewportClients) {
-    if (!pEditorViewportClient) {
-      continue;
-    }
-
-    const FVector& location = pEditorViewportClient->GetViewLocation();
-    const FRotator& rotation = pEditorViewportClient->GetViewRotation();
-    double fov = pEditorViewportClient->ViewFOV;
-    FIntPoint offset;
-    FIntPoint size;
-    pEditorViewportClient->GetViewportDimensions(offset, size);
-
-    if (size.X < 1 || size.Y < 1) {
-      continue;
-    }
-
-    cameras.push_back({size, location, rotation, fov});
-  }
-
-  return cameras;
-}
-#endif
-
 bool ACesium3DTileset::ShouldTickIfViewportsOnly() const {
   return this->UpdateInEditor;
 }
@@ -1170,47 +1212,6 @@ namespace {
 
 // TODO These could or should be members, but extracted here as a first step:
 
-/**
- * @brief Check if the given tile is contained in one of the given exclusion
- * zones.
- *
- * TODO Add details here what that means
- * Old comment:
- * Consider Exclusion zone to drop this tile... Ideally, should be
- * considered in Cesium3DTilesSelection::ViewState to avoid loading the tile
- * first...
- *
- * @param exclusionZones The exclusion zones
- * @param tile The tile
- * @return The result of the test
- */
-bool isInExclusionZone(
-    const TArray<FCesiumExclusionZone>& exclusionZones,
-    Cesium3DTilesSelection::Tile const* tile) {
-  if (exclusionZones.Num() == 0) {
-    return false;
-  }
-  // Apparently, only tiles with bounding REGIONS are
-  // checked for the exclusion...
-  const CesiumGeospatial::BoundingRegion* pRegion =
-      std::get_if<CesiumGeospatial::BoundingRegion>(&tile->getBoundingVolume());
-  if (!pRegion) {
-    return false;
-  }
-  for (FCesiumExclusionZone ExclusionZone : exclusionZones) {
-    CesiumGeospatial::GlobeRectangle cgExclusionZone =
-        CesiumGeospatial::GlobeRectangle::fromDegrees(
-            ExclusionZone.West,
-            ExclusionZone.South,
-            ExclusionZone.East,
-            ExclusionZone.North);
-    if (cgExclusionZone.computeIntersection(pRegion->getRectangle())) {
-      return true;
-    }
-  }
-  return false;
-}
-
 void removeVisibleTilesFromList(
     std::vector<Cesium3DTilesSelection::Tile*>& list,
     const std::vector<Cesium3DTilesSelection::Tile*>& visibleTiles) {
@@ -1245,8 +1246,7 @@ void hideTilesToNoLongerRender(
     UCesiumGltfComponent* Gltf =
         static_cast<UCesiumGltfComponent*>(pTile->getRendererResources());
     if (Gltf && Gltf->IsVisible()) {
-      Gltf->SetVisibility(false, true);
-      Gltf->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+      Gltf->SetTileVisible(false);
     } else {
       // TODO: why is this happening?
       UE_LOG(
@@ -1257,51 +1257,73 @@ void hideTilesToNoLongerRender(
   }
 }
 
-/**
- * @brief Applies the actor collision settings for a newly created glTF
- * component
- *
- * TODO Add details here what that means
- * @param BodyInstance ...
- * @param Gltf ...
- */
-void applyActorCollisionSettings(
-    const FBodyInstance& BodyInstance,
-    UCesiumGltfComponent* Gltf) {
-  UCesiumGltfPrimitiveComponent* PrimitiveComponent =
-      static_cast<UCesiumGltfPrimitiveComponent*>(Gltf->GetChildComponent(0));
-  if (PrimitiveComponent != nullptr) {
-    if (PrimitiveComponent->GetCollisionObjectType() !=
-        BodyInstance.GetObjectType()) {
-      PrimitiveComponent->SetCollisionObjectType(BodyInstance.GetObjectType());
-    }
-    const UEnum* ChannelEnum = StaticEnum<ECollisionChannel>();
-    if (ChannelEnum) {
-      FCollisionResponseContainer responseContainer =
-          BodyInstance.GetResponseToChannels();
-      PrimitiveComponent->SetCollisionResponseToChannels(responseContainer);
-    }
-  }
-}
 } // namespace
 
 void ACesium3DTileset::updateTilesetOptionsFromProperties() {
   Cesium3DTilesSelection::TilesetOptions& options =
       this->_pTileset->getOptions();
-  options.maximumScreenSpaceError =
-      static_cast<double>(this->MaximumScreenSpaceError);
+
+  // Assigns an option that affects which tiles are selected, noting whether
+  // it changed.
+  auto assignSelectionOption = [this](auto& option, auto value) {
+    auto newValue = static_cast<std::decay_t<decltype(option)>>(value);
+    if (option != newValue) {
+      option = newValue;
+      this->_viewUpdateRequired = true;
+    }
+  };
+
+  assignSelectionOption(
+      options.maximumScreenSpaceError,
+      static_cast<double>(this->MaximumScreenSpaceError));
   options.maximumCachedBytes = this->MaximumCachedBytes;
-  options.preloadAncestors = this->PreloadAncestors;
-  options.preloadSiblings = this->PreloadSiblings;
-  options.forbidHoles = this->ForbidHoles;
+  assignSelectionOption(options.preloadAncestors, this->PreloadAncestors);
+  assignSelectionOption(options.preloadSiblings, this->PreloadSiblings);
+  assignSelectionOption(options.forbidHoles, this->ForbidHoles);
   options.maximumSimultaneousTileLoads = this->MaximumSimultaneousTileLoads;
-  options.loadingDescendantLimit = this->LoadingDescendantLimit;
+  assignSelectionOption(
+      options.loadingDescendantLimit,
+      this->LoadingDescendantLimit);
+
+  assignSelectionOption(
+      options.enableFrustumCulling,
+      this->EnableFrustumCulling);
+  assignSelectionOption(options.enableFogCulling, this->EnableFogCulling);
+  assignSelectionOption(
+      options.enforceCulledScreenSpaceError,
+      this->EnforceCulledScreenSpaceError);
+  assignSelectionOption(
+      options.culledScreenSpaceError,
+      static_cast<double>(this->CulledScreenSpaceError));
+}
 
-  options.enableFrustumCulling = this->EnableFrustumCulling;
-  options.enableFogCulling = this->EnableFogCulling;
-  options.enforceCulledScreenSpaceError = this->EnforceCulledScreenSpaceError;
-  options.culledScreenSpaceError =
-      static_cast<double>(this->CulledScreenSpaceError);
+void ACesium3DTileset::updateExclusionZoneExcluder() {
+  if (this->_pExclusionZoneExcluder) {
+    this->_pExclusionZoneExcluder->setExclusionZones(this->ExclusionZones);
+    this->_viewUpdateRequired = true;
+  }
+}
+
+void ACesium3DTileset::updateOcclusionTileExcluder(
+    const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+    size_t renderedFrustumCount) {
+  if (!this->_pOcclusionTileExcluder) {
+    return;
+  }
+
+  if (this->_pOcclusionTileExcluder->isEnabled() !=
+      this->EnableOcclusionCulling) {
+    this->_pOcclusionTileExcluder->setEnabled(this->EnableOcclusionCulling);
+    this->_viewUpdateRequired = true;
+  }
+
+  // Tiles that become visible need to be selected again, even if the views
+  // are unchanged.
+  if (this->_pOcclusionTileExcluder->updateOcclusion(
+          frustums,
+          renderedFrustumCount)) {
+    this->_viewUpdateRequired = true;
+  }
 }
 
 void ACesium3DTileset::updateLastViewUpdateResultState(
@@ -1349,17 +1371,18 @@ void ACesium3DTileset::updateLastViewUpdateResultState(
   }
 }
 
-void ACesium3DTileset::showTilesToRender(
+bool ACesium3DTileset::showTilesToRender(
     const std::vector<Cesium3DTilesSelection::Tile*>& tiles) {
+  const double creationTimeLimit =
+      this->MaximumTileCreationTimePerFrame / 1000.0;
+  double creationTime = 0.0;
+  bool allShown = true;
+
   for (Cesium3DTilesSelection::Tile* pTile : tiles) {
     if (pTile->getState() != Cesium3DTilesSelection::Tile::LoadState::Done) {
       continue;
     }
 
-    if (isInExclusionZone(ExclusionZones, pTile)) {
-      continue;
-    }
-
     // That looks like some reeeally entertaining debug session...:
     // const Cesium3DTilesSelection::TileID& id = pTile->getTileID();
     // const CesiumGeometry::QuadtreeTileID* pQuadtreeID =
@@ -1378,14 +1401,54 @@ void ACesium3DTileset::showTilesToRender(
       continue;
     }
 
-    applyActorCollisionSettings(BodyInstance, Gltf);
+    // Tiles entirely inside an exclusion zone were excluded during tile
+    // selection. Tiles that only partly overlap one are loaded, so that their
+    // children outside of it can be refined to, but are not shown.
+    if (this->_pExclusionZoneExcluder &&
+        this->_pExclusionZoneExcluder->overlaps(*pTile)) {
+      if (Gltf->IsVisible()) {
+        Gltf->SetTileVisible(false);
+      }
+      continue;
+    }
+
+    if (Gltf->HasDeferredPrimitives()) {
+      // At least one tile is created in each frame, so that the tiles are
+      // eventually shown however long each one takes.
+      if (creationTimeLimit > 0.0 && creationTime > 0.0 &&
+          creationTime >= creationTimeLimit) {
+        allShown = false;
+        continue;
+      }
+
+      SCOPE_CYCLE_COUNTER(STAT_CesiumMainThreadPrepare);
+      double startTime = FPlatformTime::Seconds();
+
+      // The deferred result was counted since it was prepared, and is replaced
+      // by the meshes and textures created from it.
+      this->SubtractRendererMemoryUsage(Gltf->GetMemoryUsage());
+      Gltf->CreateDeferredPrimitives(
+          this->_tilesetToTileAnchor,
+          this->Material,
+          this->WaterMaterial,
+          this->CustomDepthParameters);
+      this->AddRendererMemoryUsage(Gltf->GetMemoryUsage());
+
+      double duration = FPlatformTime::Seconds() - startTime;
+      creationTime += duration;
+      this->_pStatisticsCollector->recordTileShown(duration);
+    }
+
+    Gltf->ApplyCollisionSettings(
+        this->BodyInstance,
+        this->_collisionSettingsVersion);
 
     if (Gltf->GetAttachParent() == nullptr) {
 
       // The AttachToComponent method is ridiculously complex,
       // so print a warning if attaching fails for some reason
       bool attached = Gltf->AttachToComponent(
-          this->RootComponent,
+          this->_pTileAnchor,
           FAttachmentTransformRules::KeepRelativeTransform);
       if (!attached) {
         FString tileIdString(
@@ -1395,15 +1458,164 @@ void ACesium3DTileset::showTilesToRender(
         UE_LOG(
             LogCesium,
             Warning,
-            TEXT("Tile %s could not be attached to root"),
+            TEXT("Tile %s could not be attached to the tile anchor"),
             *tileIdString);
       }
     }
 
-    if (!Gltf->IsVisible()) {
-      Gltf->SetVisibility(true, true);
-      Gltf->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+    if (this->EnableLodTransitions) {
+      TWeakObjectPtr<UCesiumGltfComponent> pGltf(Gltf);
+      auto fadingOutIt = std::find(
+          this->_tilesFadingOut.begin(),
+          this->_tilesFadingOut.end(),
+          pGltf);
+      if (fadingOutIt != this->_tilesFadingOut.end()) {
+        // Fade the tile back in from wherever its fade out got to.
+        this->_tilesFadingOut.erase(fadingOutIt);
+        this->_tilesFadingIn.push_back(pGltf);
+      } else if (!Gltf->IsVisible()) {
+        Gltf->SetFadePercentage(0.0f);
+        this->_tilesFadingIn.push_back(pGltf);
+      }
+    }
+
+    Gltf->SetTileVisible(true);
+  }
+
+  return allShown;
+}
+
+void ACesium3DTileset::fadeOutTiles(
+    const std::vector<Cesium3DTilesSelection::Tile*>& tiles) {
+  for (Cesium3DTilesSelection::Tile* pTile : tiles) {
+    if (pTile->getState() != Cesium3DTilesSelection::Tile::LoadState::Done) {
+      continue;
+    }
+
+    UCesiumGltfComponent* Gltf =
+        static_cast<UCesiumGltfComponent*>(pTile->getRendererResources());
+    if (!Gltf || !Gltf->IsVisible()) {
+      continue;
     }
+
+    TWeakObjectPtr<UCesiumGltfComponent> pGltf(Gltf);
+    auto fadingInIt = std::find(
+        this->_tilesFadingIn.begin(),
+        this->_tilesFadingIn.end(),
+        pGltf);
+    if (fadingInIt != this->_tilesFadingIn.end()) {
+      this->_tilesFadingIn.erase(fadingInIt);
+    }
+
+    if (std::find(
+            this->_tilesFadingOut.begin(),
+            this->_tilesFadingOut.end(),
+            pGltf) == this->_tilesFadingOut.end()) {
+      this->_tilesFadingOut.push_back(pGltf);
+    }
+  }
+}
+
+void ACesium3DTileset::updateLodTransitions(float DeltaTime) {
+  if (this->_tilesFadingIn.empty() && this->_tilesFadingOut.empty()) {
+    return;
+  }
+
+  // When transitions are disabled while tiles are fading, complete their
+  // transitions at once.
+  float step = 1.0f;
+  if (this->EnableLodTransitions && this->LodTransitionLength > 0.0f) {
+    step = DeltaTime / this->LodTransitionLength;
+  }
+
+  // Tiles that were unloaded while fading are destroyed along with their
+  // renderer resources, and are dropped from the lists.
+  auto fadeInIt = std::remove_if(
+      this->_tilesFadingIn.begin(),
+      this->_tilesFadingIn.end(),
+      [step](const TWeakObjectPtr<UCesiumGltfComponent>& pGltf) {
+        UCesiumGltfComponent* Gltf = pGltf.Get();
+        if (!Gltf) {
+          return true;
+        }
+        float percentage = FMath::Min(Gltf->GetFadePercentage() + step, 1.0f);
+        Gltf->SetFadePercentage(percentage);
+        return percentage >= 1.0f;
+      });
+  this->_tilesFadingIn.erase(fadeInIt, this->_tilesFadingIn.end());
+
+  auto fadeOutIt = std::remove_if(
+      this->_tilesFadingOut.begin(),
+      this->_tilesFadingOut.end(),
+      [step](const TWeakObjectPtr<UCesiumGltfComponent>& pGltf) {
+        UCesiumGltfComponent* Gltf = pGltf.Get();
+        if (!Gltf) {
+          return true;
+        }
+        float percentage = FMath::Max(Gltf->GetFadePercentage() - step, 0.0f);
+        if (percentage > 0.0f) {
+          Gltf->SetFadePercentage(percentage);
+          return false;
+        }
+        // Leave the tile fully faded in for the next time it is shown.
+        Gltf->SetTileVisible(false);
+        Gltf->SetFadePercentage(1.0f);
+        return true;
+      });
+  this->_tilesFadingOut.erase(fadeOutIt, this->_tilesFadingOut.end());
+}
+
+int64 ACesium3DTileset::GetLodTransitionCachedBytes() const {
+  return this->_tilesFadingOut.empty() ? 0
+                                       : this->MaximumLodTransitionCachedBytes;
+}
+
+FCesiumTilesetMemoryUsage ACesium3DTileset::GetMemoryUsage() const {
+  FCesiumTilesetMemoryUsage usage;
+  {
+    std::lock_guard<std::mutex> lock(this->_rendererMemoryUsageMutex);
+    usage = this->_rendererMemoryUsage;
+  }
+  if (this->_pTileset) {
+    usage.ModelBytes = this->_pTileset->getTotalDataBytes();
+  }
+  return usage;
+}
+
+FCesiumTilesetStatistics ACesium3DTileset::GetStatistics() const {
+  return this->_pStatisticsCollector->getStatistics();
+}
+
+void ACesium3DTileset::ResetStatistics() {
+  this->_pStatisticsCollector->reset();
+}
+
+void ACesium3DTileset::UpdateStatistics(
+    const Cesium3DTilesSelection::ViewUpdateResult* pResult) {
+  this->_pStatisticsCollector->endFrame(pResult);
+}
+
+void ACesium3DTileset::AddRendererMemoryUsage(
+    const FCesiumTilesetMemoryUsage& Usage) {
+  std::lock_guard<std::mutex> lock(this->_rendererMemoryUsageMutex);
+  this->_rendererMemoryUsage += Usage;
+}
+
+void ACesium3DTileset::SubtractRendererMemoryUsage(
+    const FCesiumTilesetMemoryUsage& Usage) {
+  std::lock_guard<std::mutex> lock(this->_rendererMemoryUsageMutex);
+  this->_rendererMemoryUsage -= Usage;
+}
+
+void ACesium3DTileset::updateCollisionSettingsVersion() {
+  ECollisionChannel objectType = this->BodyInstance.GetObjectType();
+  const FCollisionResponseContainer& responses =
+      this->BodyInstance.GetResponseToChannels();
+  if (objectType != this->_lastCollisionObjectType ||
+      responses != this->_lastCollisionResponses) {
+    this->_lastCollisionObjectType = objectType;
+    this->_lastCollisionResponses = responses;
+    ++this->_collisionSettingsVersion;
   }
 }
 
@@ -1411,6 +1623,11 @@ void ACesium3DTileset::showTilesToRender(
 void ACesium3DTileset::Tick(float DeltaTime) {
   Super::Tick(DeltaTime);
 
+  SCOPE_CYCLE_COUNTER(STAT_CesiumTilesetTick);
+  CSV_SCOPED_TIMING_STAT(Cesium, TilesetTick);
+  CesiumTilesetStatisticsCollector::ScopedGameThreadTimer timer(
+      *this->_pStatisticsCollector);
+
   UCesium3DTilesetRoot* pRoot = Cast<UCesium3DTilesetRoot>(this->RootComponent);
   if (!pRoot) {
     return;
@@ -1432,19 +1649,36 @@ void ACesium3DTileset::Tick(float DeltaTime) {
   }
 
   updateTilesetOptionsFromProperties();
+  updateLodTransitions(DeltaTime);
 
-  std::vector<UnrealCameraParameters> cameras = this->GetCameras();
-  if (cameras.empty()) {
-    return;
+  // The view itself is updated by the tileset manager once all tilesets have
+  // ticked, so that work can be shared between them.
+  UCesiumTilesetManager* pManager = UCesiumTilesetManager::Get(this);
+  if (pManager) {
+    pManager->RequestUpdate(this);
   }
+}
 
-  glm::dmat4 unrealWorldToTileset = glm::affineInverse(
-      this->GetCesiumTilesetToUnrealRelativeWorldTransform());
+const Cesium3DTilesSelection::ViewUpdateResult* ACesium3DTileset::UpdateView(
+    const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+    size_t renderedFrustumCount,
+    bool viewsUnchanged) {
+  if (!this->_pTileset) {
+    return nullptr;
+  }
 
-  std::vector<Cesium3DTilesSelection::ViewState> frustums;
-  for (const UnrealCameraParameters& camera : cameras) {
-    frustums.push_back(
-        CreateViewStateFromViewParameters(camera, unrealWorldToTileset));
+  SCOPE_CYCLE_COUNTER(STAT_CesiumUpdateView);
+  CSV_SCOPED_TIMING_STAT(Cesium, UpdateView);
+  CesiumTilesetStatisticsCollector::ScopedGameThreadTimer timer(
+      *this->_pStatisticsCollector);
+
+  updateOcclusionTileExcluder(frustums, renderedFrustumCount);
+
+  if (this->SkipUnchangedViewUpdates && viewsUnchanged &&
+      !this->_viewUpdateRequired && !this->_captureMovieMode &&
+      this->_skippedViewUpdates < this->MaximumSkippedViewUpdates) {
+    ++this->_skippedViewUpdates;
+    return nullptr;
   }
 
   const Cesium3DTilesSelection::ViewUpdateResult& result =
@@ -1452,12 +1686,57 @@ void ACesium3DTileset::Tick(float DeltaTime) {
                               : this->_pTileset->updateView(frustums);
   updateLastViewUpdateResultState(result);
 
+  this->_skippedViewUpdates = 0;
+  this->_viewUpdateRequired = result.tilesLoadingLowPriority > 0 ||
+                              result.tilesLoadingMediumPriority > 0 ||
+                              result.tilesLoadingHighPriority > 0;
+
+  updateCollisionSettingsVersion();
+  bool allShown = showTilesToRender(result.tilesToRenderThisFrame);
+
   removeVisibleTilesFromList(
       this->_tilesToNoLongerRenderNextFrame,
       result.tilesToRenderThisFrame);
-  hideTilesToNoLongerRender(this->_tilesToNoLongerRenderNextFrame);
-  this->_tilesToNoLongerRenderNextFrame = result.tilesToNoLongerRenderThisFrame;
-  showTilesToRender(result.tilesToRenderThisFrame);
+  if (!allShown) {
+    // Some of the tiles to render are not shown yet, so the tiles they replace
+    // remain visible until a later update has shown all of them.
+    for (Cesium3DTilesSelection::Tile* pTile :
+         result.tilesToNoLongerRenderThisFrame) {
+      if (std::find(
+              this->_tilesToNoLongerRenderNextFrame.begin(),
+              this->_tilesToNoLongerRenderNextFrame.end(),
+              pTile) == this->_tilesToNoLongerRenderNextFrame.end()) {
+        this->_tilesToNoLongerRenderNextFrame.push_back(pTile);
+      }
+    }
+  } else if (this->EnableLodTransitions) {
+    // The tiles fading out remain visible until their transition completes,
+    // so they don't need to be kept around for another frame.
+    fadeOutTiles(this->_tilesToNoLongerRenderNextFrame);
+    this->_tilesToNoLongerRenderNextFrame.clear();
+    fadeOutTiles(result.tilesToNoLongerRenderThisFrame);
+  } else {
+    hideTilesToNoLongerRender(this->_tilesToNoLongerRenderNextFrame);
+    this->_tilesToNoLongerRenderNextFrame =
+        result.tilesToNoLongerRenderThisFrame;
+  }
+
+  // The tiles that are not shown yet are shown by a later view update. The
+  // tiles that are still shown for one more frame are only hidden by the next
+  // view update, and tiles that are fading may have to be shown again or
+  // faded the other way. So updates must not be skipped while there are any.
+  this->_viewUpdateRequired = this->_viewUpdateRequired || !allShown ||
+                              !this->_tilesToNoLongerRenderNextFrame.empty() ||
+                              !this->_tilesFadingIn.empty() ||
+                              !this->_tilesFadingOut.empty();
+
+  if (this->_pOcclusionTileExcluder) {
+    this->_pOcclusionTileExcluder->updateBoundingVolumes(
+        result.tilesToRenderThisFrame,
+        this->_tilesetToTileAnchor);
+  }
+
+  return &result;
 }
 
 void ACesium3DTileset::EndPlay(const EEndPlayReason::Type EndPlayReason) {
@@ -1513,14 +1792,25 @@ void ACesium3DTileset::PostEditChangeProperty(
       PropName ==
           GET_MEMBER_NAME_CHECKED(ACesium3DTileset, GenerateSmoothNormals) ||
       PropName == GET_MEMBER_NAME_CHECKED(ACesium3DTileset, EnableWaterMask) ||
+      PropName ==
+          GET_MEMBER_NAME_CHECKED(ACesium3DTileset, MergeSmallPrimitives) ||
+      PropName == GET_MEMBER_NAME_CHECKED(
+                      ACesium3DTileset,
+                      MaximumMergedPrimitiveVertices) ||
       PropName == GET_MEMBER_NAME_CHECKED(ACesium3DTileset, Material) ||
       PropName == GET_MEMBER_NAME_CHECKED(ACesium3DTileset, WaterMaterial) ||
       // For properties nested in structs, GET_MEMBER_NAME_CHECKED will prefix
       // with the struct name, so just do a manual string comparison.
       PropNameAsString == TEXT("RenderCustomDepth") ||
       PropNameAsString == TEXT("CustomDepthStencilValue") ||
-      PropNameAsString == TEXT("CustomDepthStencilWriteMask")) {
+      PropNameAsString == TEXT("CustomDepthStencilWriteMask") ||
+      PropertyChangedEvent.GetMemberPropertyName() ==
+          GET_MEMBER_NAME_CHECKED(ACesium3DTileset, OfflineBundle)) {
     this->DestroyTileset();
+  } else if (
+      PropertyChangedEvent.GetMemberPropertyName() ==
+      GET_MEMBER_NAME_CHECKED(ACesium3DTileset, ExclusionZones)) {
+    this->updateExclusionZoneExcluder();
   } else if (
       PropName == GET_MEMBER_NAME_CHECKED(ACesium3DTileset, Georeference)) {
     this->InvalidateResolvedGeoreference();
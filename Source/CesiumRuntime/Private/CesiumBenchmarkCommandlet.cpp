@@ -0,0 +1,514 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumBenchmarkCommandlet.h"
+#include "Cesium3DTilesSelection/BoundingVolume.h"
+#include "Cesium3DTilesSelection/IPrepareRendererResources.h"
+#include "Cesium3DTilesSelection/Tile.h"
+#include "Cesium3DTilesSelection/Tileset.h"
+#include "Cesium3DTilesSelection/TilesetExternals.h"
+#include "Cesium3DTilesSelection/TilesetOptions.h"
+#include "Cesium3DTilesSelection/ViewState.h"
+#include "Cesium3DTilesSelection/ViewUpdateResult.h"
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumCommandletUtility.h"
+#include "CesiumFileAssetAccessor.h"
+#include "CesiumGeometry/BoundingSphere.h"
+#include "CesiumGeometry/OrientedBoundingBox.h"
+#include "CesiumGeospatial/BoundingRegion.h"
+#include "CesiumGeospatial/BoundingRegionWithLooseFittingHeights.h"
+#include "CesiumGeospatial/Ellipsoid.h"
+#include "CesiumGeospatial/S2CellBoundingVolume.h"
+#include "CesiumGltfComponent.h"
+#include "CesiumRuntime.h"
+#include "CesiumStatisticsAssetAccessor.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "CreateModelOptions.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UnrealTaskProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <glm/geometric.hpp>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <variant>
+#include <vector>
+
+using namespace CesiumCommandletUtility;
+
+namespace {
+
+struct BenchmarkView {
+  glm::dvec3 position;
+  glm::dvec3 direction;
+  glm::dvec3 up;
+};
+
+/**
+ * A resource preparer that only does the load-thread part of preparing a tile,
+ * exactly like the one of Cesium3DTileset, and measures how long it takes.
+ */
+class BenchmarkResourcePreparer
+    : public Cesium3DTilesSelection::IPrepareRendererResources {
+public:
+  BenchmarkResourcePreparer(const CreateModelOptions& options)
+      : _options(options),
+        _mutex(),
+        _prepareSeconds(),
+        _loadThreadPreparesInFlight(0) {}
+
+  virtual void* prepareInLoadThread(
+      const CesiumGltf::Model& model,
+      const glm::dmat4& transform) override {
+    ++this->_loadThreadPreparesInFlight;
+    double startTime = FPlatformTime::Seconds();
+
+    std::unique_ptr<UCesiumGltfComponent::HalfConstructed> pHalf =
+        UCesiumGltfComponent::CreateOffGameThread(
+            model,
+            transform,
+            this->_options);
+
+    double seconds = FPlatformTime::Seconds() - startTime;
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      this->_prepareSeconds.push_back(seconds);
+    }
+    --this->_loadThreadPreparesInFlight;
+
+    return pHalf.release();
+  }
+
+  // The result of the load thread is kept as the tile's renderer resources, so
+  // that the loaded tiles count towards the memory used by the benchmark.
+  virtual void* prepareInMainThread(
+      Cesium3DTilesSelection::Tile& /*tile*/,
+      void* pLoadThreadResult) override {
+    return pLoadThreadResult;
+  }
+
+  virtual void free(
+      Cesium3DTilesSelection::Tile& /*tile*/,
+      void* pLoadThreadResult,
+      void* pMainThreadResult) noexcept override {
+    void* pResult = pLoadThreadResult ? pLoadThreadResult : pMainThreadResult;
+    delete static_cast<UCesiumGltfComponent::HalfConstructed*>(pResult);
+  }
+
+  virtual void* prepareRasterInLoadThread(
+      const CesiumGltf::ImageCesium& /*image*/) override {
+    return nullptr;
+  }
+
+  virtual void* prepareRasterInMainThread(
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pLoadThreadResult*/) override {
+    return nullptr;
+  }
+
+  virtual void freeRaster(
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pLoadThreadResult*/,
+      void* /*pMainThreadResult*/) noexcept override {}
+
+  virtual void attachRasterInMainThread(
+      const Cesium3DTilesSelection::Tile& /*tile*/,
+      int32_t /*overlayTextureCoordinateID*/,
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pMainThreadRendererResources*/,
+      const glm::dvec2& /*translation*/,
+      const glm::dvec2& /*scale*/) override {}
+
+  virtual void detachRasterInMainThread(
+      const Cesium3DTilesSelection::Tile& /*tile*/,
+      int32_t /*overlayTextureCoordinateID*/,
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pMainThreadRendererResources*/) noexcept override {}
+
+  int32 getLoadThreadPreparesInFlight() const noexcept {
+    return this->_loadThreadPreparesInFlight;
+  }
+
+  std::vector<double> getPrepareSeconds() {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_prepareSeconds;
+  }
+
+private:
+  CreateModelOptions _options;
+  std::mutex _mutex;
+  std::vector<double> _prepareSeconds;
+  std::atomic<int32> _loadThreadPreparesInFlight;
+};
+
+struct ComputeBoundingSphere {
+  CesiumGeometry::BoundingSphere
+  operator()(const CesiumGeometry::BoundingSphere& sphere) {
+    return sphere;
+  }
+
+  CesiumGeometry::BoundingSphere
+  operator()(const CesiumGeometry::OrientedBoundingBox& orientedBoundingBox) {
+    const glm::dmat3& halfAxes = orientedBoundingBox.getHalfAxes();
+    return CesiumGeometry::BoundingSphere(
+        orientedBoundingBox.getCenter(),
+        glm::length(halfAxes[0] + halfAxes[1] + halfAxes[2]));
+  }
+
+  CesiumGeometry::BoundingSphere
+  operator()(const CesiumGeospatial::BoundingRegion& boundingRegion) {
+    return (*this)(boundingRegion.getBoundingBox());
+  }
+
+  CesiumGeometry::BoundingSphere
+  operator()(const CesiumGeospatial::BoundingRegionWithLooseFittingHeights&
+                 boundingRegionWithLooseFittingHeights) {
+    return (*this)(boundingRegionWithLooseFittingHeights.getBoundingRegion()
+                       .getBoundingBox());
+  }
+
+  CesiumGeometry::BoundingSphere
+  operator()(const CesiumGeospatial::S2CellBoundingVolume& s2) {
+    return (*this)(s2.computeBoundingRegion());
+  }
+};
+
+/**
+ * Creates a path that looks straight down at the center of the root tile,
+ * halving the distance to it in each step, from four times its radius to
+ * close to its surface.
+ */
+std::vector<BenchmarkView>
+createDefaultPath(const Cesium3DTilesSelection::Tile& rootTile, int32 steps) {
+  CesiumGeometry::BoundingSphere sphere =
+      std::visit(ComputeBoundingSphere{}, rootTile.getBoundingVolume());
+  const glm::dvec3& center = sphere.getCenter();
+
+  // A global tileset is centered at the center of the Earth, which has no
+  // surface normal.
+  glm::dvec3 normal =
+      glm::length(center) > 1.0
+          ? CesiumGeospatial::Ellipsoid::WGS84.geodeticSurfaceNormal(center)
+          : glm::dvec3(1.0, 0.0, 0.0);
+  glm::dvec3 reference = glm::abs(normal.z) < 0.9 ? glm::dvec3(0.0, 0.0, 1.0)
+                                                  : glm::dvec3(1.0, 0.0, 0.0);
+  glm::dvec3 up =
+      glm::normalize(reference - glm::dot(reference, normal) * normal);
+
+  std::vector<BenchmarkView> path;
+  double distance = 4.0 * sphere.getRadius();
+  for (int32 i = 0; i < steps; ++i) {
+    path.push_back(BenchmarkView{center + distance * normal, -normal, up});
+    distance *= 0.5;
+  }
+  return path;
+}
+
+bool readVector(
+    const TSharedPtr<FJsonObject>& pObject,
+    const FString& name,
+    glm::dvec3& result) {
+  const TArray<TSharedPtr<FJsonValue>>* pArray = nullptr;
+  if (!pObject->TryGetArrayField(name, pArray) || pArray->Num() != 3) {
+    return false;
+  }
+
+  result = glm::dvec3(
+      (*pArray)[0]->AsNumber(),
+      (*pArray)[1]->AsNumber(),
+      (*pArray)[2]->AsNumber());
+  return true;
+}
+
+bool loadCameraPath(const FString& filename, std::vector<BenchmarkView>& path) {
+  FString json;
+  if (!FFileHelper::LoadFileToString(json, *filename)) {
+    UE_LOG(LogCesium, Error, TEXT("Could not read camera path %s"), *filename);
+    return false;
+  }
+
+  TSharedPtr<FJsonObject> pRoot;
+  TSharedRef<TJsonReader<>> pReader = TJsonReaderFactory<>::Create(json);
+  const TArray<TSharedPtr<FJsonValue>>* pViews = nullptr;
+  if (!FJsonSerializer::Deserialize(pReader, pRoot) || !pRoot.IsValid() ||
+      !pRoot->TryGetArrayField(TEXT("views"), pViews)) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Camera path %s does not contain a views array"),
+        *filename);
+    return false;
+  }
+
+  for (const TSharedPtr<FJsonValue>& pValue : *pViews) {
+    const TSharedPtr<FJsonObject>* ppView = nullptr;
+    BenchmarkView view;
+    if (!pValue->TryGetObject(ppView) ||
+        !readVector(*ppView, TEXT("position"), view.position) ||
+        !readVector(*ppView, TEXT("direction"), view.direction) ||
+        !readVector(*ppView, TEXT("up"), view.up)) {
+      UE_LOG(
+          LogCesium,
+          Error,
+          TEXT(
+              "Every view of camera path %s needs a position, direction and up vector"),
+          *filename);
+      return false;
+    }
+    path.push_back(view);
+  }
+
+  return true;
+}
+
+/**
+ * Gets the given percentile of the sorted values, in milliseconds.
+ */
+double getPercentileMilliseconds(
+    const std::vector<double>& sorted,
+    double percentile) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+
+  size_t index = static_cast<size_t>(
+      percentile / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)] * 1000.0;
+}
+
+} // namespace
+
+UCesiumBenchmarkCommandlet::UCesiumBenchmarkCommandlet() {
+  this->IsClient = false;
+  this->IsServer = false;
+  this->IsEditor = false;
+  this->LogToConsole = true;
+  this->HelpDescription =
+      TEXT("Measures how fast a tileset is loaded, without rendering it.");
+  this->HelpUsage = TEXT(
+      "-run=CesiumBenchmark -Url=file:///path/to/tileset.json [-Output=result.json] [-CameraPath=path.json]");
+}
+
+int32 UCesiumBenchmarkCommandlet::Main(const FString& Params) {
+  FString url;
+  if (!FParse::Value(*Params, TEXT("Url="), url)) {
+    UE_LOG(LogCesium, Error, TEXT("Usage: %s"), *this->HelpUsage);
+    return 1;
+  }
+
+  FString outputPath =
+      FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CesiumBenchmark.json"));
+  FParse::Value(*Params, TEXT("Output="), outputPath);
+
+  int32 steps = 8;
+  int32 viewportWidth = 1920;
+  int32 viewportHeight = 1080;
+  float fieldOfViewDegrees = 90.0f;
+  float maximumScreenSpaceError = 16.0f;
+  int32 maximumSimultaneousTileLoads = 20;
+  int64 maximumCachedBytes = 256 * 1024 * 1024;
+  float timeoutSeconds = 600.0f;
+  FParse::Value(*Params, TEXT("Steps="), steps);
+  FParse::Value(*Params, TEXT("ViewportWidth="), viewportWidth);
+  FParse::Value(*Params, TEXT("ViewportHeight="), viewportHeight);
+  FParse::Value(*Params, TEXT("FieldOfView="), fieldOfViewDegrees);
+  FParse::Value(
+      *Params,
+      TEXT("MaximumScreenSpaceError="),
+      maximumScreenSpaceError);
+  FParse::Value(
+      *Params,
+      TEXT("MaximumSimultaneousTileLoads="),
+      maximumSimultaneousTileLoads);
+  FParse::Value(*Params, TEXT("MaximumCachedBytes="), maximumCachedBytes);
+  FParse::Value(*Params, TEXT("Timeout="), timeoutSeconds);
+
+  CreateModelOptions modelOptions;
+  modelOptions.alwaysIncludeTangents =
+      FParse::Param(*Params, TEXT("AlwaysIncludeTangents"));
+  modelOptions.mergeSmallPrimitives =
+      FParse::Param(*Params, TEXT("MergeSmallPrimitives"));
+  modelOptions.maximumMergedPrimitiveVertices = 1024;
+
+  std::vector<BenchmarkView> path;
+  FString cameraPathFile;
+  if (FParse::Value(*Params, TEXT("CameraPath="), cameraPathFile) &&
+      !loadCameraPath(cameraPathFile, path)) {
+    return 1;
+  }
+
+  CesiumAsync::AsyncSystem asyncSystem(std::make_shared<UnrealTaskProcessor>());
+  std::shared_ptr<CesiumTilesetStatisticsCollector> pCollector =
+      std::make_shared<CesiumTilesetStatisticsCollector>();
+  std::shared_ptr<BenchmarkResourcePreparer> pPreparer =
+      std::make_shared<BenchmarkResourcePreparer>(modelOptions);
+
+  Cesium3DTilesSelection::TilesetExternals externals{
+      std::make_shared<CesiumStatisticsAssetAccessor>(
+          std::make_shared<CesiumStatisticsAssetAccessor>(
+              std::make_shared<CesiumFileAssetAccessor>(),
+              pCollector,
+              CesiumStatisticsAssetAccessor::Record::Downloads),
+          pCollector,
+          CesiumStatisticsAssetAccessor::Record::Requests),
+      pPreparer,
+      asyncSystem,
+      nullptr,
+      spdlog::default_logger()};
+
+  Cesium3DTilesSelection::TilesetOptions options;
+  options.maximumScreenSpaceError =
+      static_cast<double>(maximumScreenSpaceError);
+  options.maximumSimultaneousTileLoads =
+      static_cast<uint32_t>(maximumSimultaneousTileLoads);
+  options.maximumCachedBytes = maximumCachedBytes;
+
+  double horizontalFieldOfView = FMath::DegreesToRadians(fieldOfViewDegrees);
+  double aspectRatio = double(viewportWidth) / double(viewportHeight);
+  double verticalFieldOfView =
+      atan(tan(horizontalFieldOfView * 0.5) / aspectRatio) * 2.0;
+
+  UE_LOG(LogCesium, Display, TEXT("Benchmarking tileset %s"), *url);
+
+  double startTime = FPlatformTime::Seconds();
+  double deadline = startTime + timeoutSeconds;
+  bool completed = true;
+  int64 frames = 0;
+  int64 peakTileDataBytes = 0;
+  uint64 peakUsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+
+  {
+    Cesium3DTilesSelection::Tileset tileset(
+        externals,
+        TCHAR_TO_UTF8(*url),
+        options);
+
+    while (!tileset.getRootTile()) {
+      if (FPlatformTime::Seconds() > deadline) {
+        UE_LOG(LogCesium, Error, TEXT("Timed out loading %s"), *url);
+        completed = false;
+        break;
+      }
+      asyncSystem.dispatchMainThreadTasks();
+      FPlatformProcess::Sleep(loadingFrameSeconds);
+    }
+
+    if (completed && path.empty()) {
+      path = createDefaultPath(*tileset.getRootTile(), steps);
+    }
+
+    for (size_t i = 0; completed && i < path.size(); ++i) {
+      const BenchmarkView& view = path[i];
+      std::vector<Cesium3DTilesSelection::ViewState> frustums{
+          Cesium3DTilesSelection::ViewState::create(
+              view.position,
+              glm::normalize(view.direction),
+              glm::normalize(view.up),
+              glm::dvec2(viewportWidth, viewportHeight),
+              horizontalFieldOfView,
+              verticalFieldOfView)};
+
+      int32 idleFrames = 0;
+      while (idleFrames < idleFramesPerView) {
+        if (FPlatformTime::Seconds() > deadline) {
+          UE_LOG(
+              LogCesium,
+              Error,
+              TEXT("Timed out loading view %d of %d"),
+              int32(i + 1),
+              int32(path.size()));
+          completed = false;
+          break;
+        }
+
+        const Cesium3DTilesSelection::ViewUpdateResult& result =
+            tileset.updateView(frustums);
+        pCollector->endFrame(&result);
+        ++frames;
+
+        peakTileDataBytes =
+            std::max(peakTileDataBytes, tileset.getTotalDataBytes());
+        peakUsedPhysicalBytes = std::max(
+            peakUsedPhysicalBytes,
+            FPlatformMemory::GetStats().UsedPhysical);
+
+        const FCesiumTilesetStatistics& statistics =
+            pCollector->getStatistics();
+        bool idle = statistics.TilesWaitingToLoad == 0 &&
+                    statistics.RequestsInFlight == 0 &&
+                    pPreparer->getLoadThreadPreparesInFlight() == 0 &&
+                    !isContentLoading(*tileset.getRootTile());
+        idleFrames = idle ? idleFrames + 1 : 0;
+
+        if (!idle) {
+          FPlatformProcess::Sleep(loadingFrameSeconds);
+        }
+      }
+    }
+  }
+
+  double seconds = FPlatformTime::Seconds() - startTime;
+
+  std::vector<double> prepareSeconds = pPreparer->getPrepareSeconds();
+  std::sort(prepareSeconds.begin(), prepareSeconds.end());
+
+  const FCesiumTilesetStatistics& statistics = pCollector->getStatistics();
+  double tilesLoaded = static_cast<double>(prepareSeconds.size());
+  double megabytesLoaded =
+      static_cast<double>(statistics.BytesDownloaded) / (1024.0 * 1024.0);
+
+  TSharedRef<FJsonObject> pResult = MakeShared<FJsonObject>();
+  pResult->SetStringField(TEXT("url"), url);
+  pResult->SetBoolField(TEXT("completed"), completed);
+  pResult->SetNumberField(TEXT("seconds"), seconds);
+  pResult->SetNumberField(TEXT("frames"), static_cast<double>(frames));
+  pResult->SetNumberField(TEXT("views"), static_cast<double>(path.size()));
+  pResult->SetNumberField(TEXT("tilesLoaded"), tilesLoaded);
+  pResult->SetNumberField(TEXT("tilesPerSecond"), tilesLoaded / seconds);
+  pResult->SetNumberField(
+      TEXT("requests"),
+      static_cast<double>(statistics.Requests));
+  pResult->SetNumberField(
+      TEXT("bytesLoaded"),
+      static_cast<double>(statistics.BytesDownloaded));
+  pResult->SetNumberField(
+      TEXT("megabytesPerSecond"),
+      megabytesLoaded / seconds);
+  pResult->SetNumberField(
+      TEXT("requestLatencyAverageMilliseconds"),
+      statistics.RequestLatency.AverageMilliseconds);
+  pResult->SetNumberField(
+      TEXT("prepareLatencyP50Milliseconds"),
+      getPercentileMilliseconds(prepareSeconds, 50.0));
+  pResult->SetNumberField(
+      TEXT("prepareLatencyP99Milliseconds"),
+      getPercentileMilliseconds(prepareSeconds, 99.0));
+  pResult->SetNumberField(
+      TEXT("prepareLatencyMaximumMilliseconds"),
+      getPercentileMilliseconds(prepareSeconds, 100.0));
+  pResult->SetNumberField(
+      TEXT("peakMemoryBytes"),
+      static_cast<double>(peakUsedPhysicalBytes));
+  pResult->SetNumberField(
+      TEXT("peakTileDataBytes"),
+      static_cast<double>(peakTileDataBytes));
+
+  FString json;
+  TSharedRef<TJsonWriter<>> pWriter = TJsonWriterFactory<>::Create(&json);
+  FJsonSerializer::Serialize(pResult, pWriter);
+
+  UE_LOG(LogCesium, Display, TEXT("%s"), *json);
+
+  if (!FFileHelper::SaveStringToFile(json, *outputPath)) {
+    UE_LOG(LogCesium, Error, TEXT("Could not write %s"), *outputPath);
+    return 1;
+  }
+
+  return completed ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+#include "CesiumBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures how fast a tileset is loaded, without rendering it, and writes the
+ * results to a JSON file.
+ *
+ * The tileset is read from the local file system and selected for a scripted
+ * camera path. Each tile goes through the same load-thread preparation as in
+ * a Cesium3DTileset, but no Unreal components are created, so the benchmark
+ * runs without a GPU:
+ *
+ *   UE4Editor-Cmd Project.uproject -run=CesiumBenchmark -nullrhi
+ *     -Url=file:///path/to/tileset.json -Output=/path/to/result.json
+ *
+ * Optional parameters:
+ *   -CameraPath=<file>  A JSON file with the views to load, see below.
+ *                       Without it, the camera descends towards the center
+ *                       of the root tile in a number of steps.
+ *   -Steps=<n>          The number of steps of the default path (8).
+ *   -ViewportWidth=<n>, -ViewportHeight=<n>  The viewport size (1920x1080).
+ *   -FieldOfView=<deg>  The horizontal field of view in degrees (90).
+ *   -MaximumScreenSpaceError=<n>  (16)
+ *   -MaximumSimultaneousTileLoads=<n>  (20)
+ *   -MaximumCachedBytes=<n>  (268435456)
+ *   -Timeout=<seconds>  The time after which the benchmark gives up (600).
+ *   -MergeSmallPrimitives, -AlwaysIncludeTangents
+ *
+ * The camera path file contains the views in the tileset's coordinate system,
+ * which is usually Earth-Centered, Earth-Fixed:
+ *
+ *   { "views": [ { "position": [x, y, z], "direction": [x, y, z],
+ *                  "up": [x, y, z] }, ... ] }
+ *
+ * Each view is held until all of its tiles are loaded, then the next one is
+ * selected. The commandlet returns 0 if all views were loaded before the
+ * timeout, and 1 otherwise.
+ */
+UCLASS()
+class UCesiumBenchmarkCommandlet : public UCommandlet {
+  GENERATED_BODY()
+
+public:
+  UCesiumBenchmarkCommandlet();
+
+  virtual int32 Main(const FString& Params) override;
+};
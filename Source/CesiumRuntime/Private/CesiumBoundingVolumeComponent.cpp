@@ -0,0 +1,154 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumBoundingVolumeComponent.h"
+#include "CesiumGeometry/BoundingSphere.h"
+#include "CesiumGeometry/OrientedBoundingBox.h"
+#include "CesiumGeospatial/BoundingRegion.h"
+#include "CesiumGeospatial/BoundingRegionWithLooseFittingHeights.h"
+#include "CesiumGeospatial/S2CellBoundingVolume.h"
+#include "Engine/World.h"
+#include "PrimitiveSceneProxy.h"
+#include "SceneManagement.h"
+#include <variant>
+
+namespace {
+/**
+ * The minimum time, in seconds, for which a bounding volume must not have been
+ * rendered before it is considered occluded. Occlusion query results arrive a
+ * frame or two late, so a single frame without them does not mean much.
+ */
+constexpr double minimumOcclusionSeconds = 0.1;
+
+/**
+ * The minimum number of frames for which a bounding volume must not have been
+ * rendered before it is considered occluded.
+ */
+constexpr double minimumOcclusionFrames = 3.0;
+
+/**
+ * A scene proxy that draws nothing, so that only the bounds of the component
+ * are tested for occlusion.
+ */
+class FCesiumBoundingVolumeSceneProxy final : public FPrimitiveSceneProxy {
+public:
+  FCesiumBoundingVolumeSceneProxy(UCesiumBoundingVolumeComponent* pComponent)
+      : FPrimitiveSceneProxy(pComponent) {}
+
+  virtual SIZE_T GetTypeHash() const override {
+    static size_t UniquePointer;
+    return reinterpret_cast<size_t>(&UniquePointer);
+  }
+
+  virtual FPrimitiveViewRelevance
+  GetViewRelevance(const FSceneView* View) const override {
+    FPrimitiveViewRelevance Result;
+    Result.bDrawRelevance = IsShown(View);
+    Result.bDynamicRelevance = true;
+    Result.bShadowRelevance = false;
+    return Result;
+  }
+
+  virtual bool CanBeOccluded() const override { return true; }
+
+  virtual uint32 GetMemoryFootprint() const override {
+    return sizeof(*this) + GetAllocatedSize();
+  }
+};
+
+struct ComputeBounds {
+  FBox operator()(const CesiumGeometry::BoundingSphere& sphere) {
+    const glm::dvec3& center = sphere.getCenter();
+    return FBox::BuildAABB(
+        FVector(center.x, center.y, center.z),
+        FVector(sphere.getRadius()));
+  }
+
+  FBox
+  operator()(const CesiumGeometry::OrientedBoundingBox& orientedBoundingBox) {
+    const glm::dvec3& center = orientedBoundingBox.getCenter();
+    const glm::dmat3& halfAxes = orientedBoundingBox.getHalfAxes();
+    glm::dvec3 extent = glm::abs(halfAxes[0]) + glm::abs(halfAxes[1]) +
+                        glm::abs(halfAxes[2]);
+    return FBox::BuildAABB(
+        FVector(center.x, center.y, center.z),
+        FVector(extent.x, extent.y, extent.z));
+  }
+
+  FBox operator()(const CesiumGeospatial::BoundingRegion& boundingRegion) {
+    return (*this)(boundingRegion.getBoundingBox());
+  }
+
+  FBox operator()(const CesiumGeospatial::BoundingRegionWithLooseFittingHeights&
+                      boundingRegionWithLooseFittingHeights) {
+    return (*this)(boundingRegionWithLooseFittingHeights.getBoundingRegion()
+                       .getBoundingBox());
+  }
+
+  FBox operator()(const CesiumGeospatial::S2CellBoundingVolume& s2) {
+    return (*this)(s2.computeBoundingRegion());
+  }
+};
+} // namespace
+
+UCesiumBoundingVolumeComponent::UCesiumBoundingVolumeComponent()
+    : _localBounds(ForceInit), _creationTime(0.0) {
+  PrimaryComponentTick.bCanEverTick = false;
+  this->SetMobility(EComponentMobility::Movable);
+  this->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+  this->SetGenerateOverlapEvents(false);
+  this->SetCastShadow(false);
+  this->bUseAsOccluder = false;
+  this->bSelectable = false;
+}
+
+void UCesiumBoundingVolumeComponent::SetBoundingVolume(
+    const Cesium3DTilesSelection::BoundingVolume& BoundingVolume) {
+  this->_localBounds = std::visit(ComputeBounds{}, BoundingVolume);
+
+  UWorld* pWorld = this->GetWorld();
+  this->_creationTime = pWorld ? pWorld->GetTimeSeconds() : 0.0;
+
+  this->UpdateBounds();
+  this->MarkRenderTransformDirty();
+}
+
+void UCesiumBoundingVolumeComponent::UpdateTransformFromCesium(
+    const glm::dmat4& CesiumToAnchorTransform) {
+  const glm::dmat4& transform = CesiumToAnchorTransform;
+  this->SetRelativeTransform(FTransform(FMatrix(
+      FVector(transform[0].x, transform[0].y, transform[0].z),
+      FVector(transform[1].x, transform[1].y, transform[1].z),
+      FVector(transform[2].x, transform[2].y, transform[2].z),
+      FVector(transform[3].x, transform[3].y, transform[3].z))));
+}
+
+bool UCesiumBoundingVolumeComponent::IsOccluded(
+    double InRenderedViewSince) const {
+  const UWorld* pWorld = this->GetWorld();
+  if (!pWorld || !this->IsRegistered() || !this->IsVisible()) {
+    return false;
+  }
+
+  const double time = pWorld->GetTimeSeconds();
+  const double tolerance = FMath::Max(
+      minimumOcclusionSeconds,
+      minimumOcclusionFrames * pWorld->GetDeltaSeconds());
+
+  if (time - FMath::Max(this->_creationTime, InRenderedViewSince) <
+      tolerance) {
+    // The renderer may not have tested the bounding volume in a view that
+    // contains it yet.
+    return false;
+  }
+
+  return time - this->GetLastRenderTimeOnScreen() > tolerance;
+}
+
+FPrimitiveSceneProxy* UCesiumBoundingVolumeComponent::CreateSceneProxy() {
+  return new FCesiumBoundingVolumeSceneProxy(this);
+}
+
+FBoxSphereBounds UCesiumBoundingVolumeComponent::CalcBounds(
+    const FTransform& LocalToWorld) const {
+  return FBoxSphereBounds(this->_localBounds).TransformBy(LocalToWorld);
+}
@@ -0,0 +1,60 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/BoundingVolume.h"
+#include "Components/PrimitiveComponent.h"
+#include "CoreMinimal.h"
+#include <glm/mat4x4.hpp>
+#include "CesiumBoundingVolumeComponent.generated.h"
+
+/**
+ * An invisible primitive with the bounding volume of a tile, which lets the
+ * renderer's occlusion culling determine whether the tile is occluded.
+ *
+ * Nothing is drawn for this component, but it takes part in occlusion culling
+ * like any other primitive, so its last render time tells whether its bounds
+ * were visible in the previous frames.
+ */
+UCLASS()
+class UCesiumBoundingVolumeComponent : public UPrimitiveComponent {
+  GENERATED_BODY()
+
+public:
+  UCesiumBoundingVolumeComponent();
+
+  /**
+   * Sets the bounding volume of the tile, in the "Cesium Tileset" reference
+   * frame.
+   */
+  void SetBoundingVolume(
+      const Cesium3DTilesSelection::BoundingVolume& BoundingVolume);
+
+  /**
+   * Updates this component's transform from a new double-precision
+   * transformation from the Cesium world to the tile anchor of the tileset.
+   */
+  void UpdateTransformFromCesium(const glm::dmat4& CesiumToAnchorTransform);
+
+  /**
+   * Returns true if the renderer did not draw the bounding volume in any of
+   * the recent frames, although it was inside the frustum of a rendered view.
+   * A bounding volume that has not been tested yet is not considered
+   * occluded.
+   *
+   * @param InRenderedViewSince The world time since which the bounding volume
+   * has been inside the frustum of a rendered view.
+   */
+  bool IsOccluded(double InRenderedViewSince) const;
+
+  virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+  virtual FBoxSphereBounds
+  CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+  // The axis-aligned bounds of the tile in the "Cesium Tileset" frame.
+  FBox _localBounds;
+
+  // The world time at which the bounding volume was last set.
+  double _creationTime;
+};
@@ -0,0 +1,340 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumBundle.h"
+#include "Async/MappedFileHandle.h"
+#include "CesiumRecordSerialization.h"
+#include "CesiumRuntime.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Hash/CityHash.h"
+#include "Misc/Paths.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace CesiumRecordSerialization;
+
+namespace {
+constexpr uint32 recordMagic = 0x52424343; // "CCBR"
+constexpr uint32 footerMagic = 0x46424343; // "CCBF"
+constexpr uint32 bundleVersion = 1;
+
+struct RecordHeader {
+  uint32 magic;
+  uint32 keySize;
+  uint32 metadataSize;
+  uint32 dataSize;
+};
+
+struct Footer {
+  uint32 magic;
+  uint32 version;
+  uint64 indexOffset;
+  uint64 entryCount;
+};
+
+uint64 hashUrl(const std::string& url) {
+  return CityHash64(url.data(), static_cast<uint32>(url.size()));
+}
+} // namespace
+
+/*static*/ std::shared_ptr<CesiumBundle>
+CesiumBundle::open(const FString& path) {
+  // A bundle used by several tilesets, or by a tileset and its prefetching,
+  // is only mapped once.
+  static std::mutex mutex;
+  static TMap<FString, std::weak_ptr<CesiumBundle>> bundles;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::weak_ptr<CesiumBundle>* ppOpenBundle = bundles.Find(path);
+  if (ppOpenBundle) {
+    std::shared_ptr<CesiumBundle> pOpenBundle = ppOpenBundle->lock();
+    if (pOpenBundle) {
+      return pOpenBundle;
+    }
+  }
+
+  std::shared_ptr<CesiumBundle> pBundle(new CesiumBundle());
+  if (!pBundle->load(path)) {
+    return nullptr;
+  }
+
+  bundles.Add(path, pBundle);
+  return pBundle;
+}
+
+CesiumBundle::CesiumBundle()
+    : _path(),
+      _pMappedFile(),
+      _pMappedRegion(),
+      _pData(nullptr),
+      _size(0),
+      _index() {}
+
+CesiumBundle::~CesiumBundle() {
+  this->_pMappedRegion.Reset();
+  this->_pMappedFile.Reset();
+}
+
+bool CesiumBundle::load(const FString& path) {
+  this->_path = path;
+
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  int64 size = platformFile.FileSize(*path);
+  if (size < static_cast<int64>(sizeof(Footer))) {
+    return false;
+  }
+
+  this->_pMappedFile.Reset(platformFile.OpenMapped(*path));
+  if (this->_pMappedFile) {
+    this->_pMappedRegion.Reset(this->_pMappedFile->MapRegion(0, size));
+  }
+
+  if (!this->_pMappedRegion) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT(
+            "Could not memory map the bundle %s. Bundles must be loose files, see Additional Non-Asset Directories To Copy in the Packaging project settings."),
+        *path);
+    this->_pMappedFile.Reset();
+    return false;
+  }
+
+  this->_pData = this->_pMappedRegion->GetMappedPtr();
+  this->_size = this->_pMappedRegion->GetMappedSize();
+
+  if (this->_size < static_cast<int64>(sizeof(Footer))) {
+    return false;
+  }
+
+  Footer footer;
+  std::memcpy(
+      &footer,
+      this->_pData + this->_size - sizeof(Footer),
+      sizeof(Footer));
+
+  uint64 indexEnd = static_cast<uint64>(this->_size) - sizeof(Footer);
+  if (footer.magic != footerMagic || footer.version != bundleVersion ||
+      footer.indexOffset > indexEnd ||
+      footer.entryCount > indexEnd / sizeof(IndexEntry) ||
+      footer.entryCount * sizeof(IndexEntry) !=
+          indexEnd - footer.indexOffset) {
+    return false;
+  }
+
+  this->_index.resize(footer.entryCount);
+  std::memcpy(
+      this->_index.data(),
+      this->_pData + footer.indexOffset,
+      footer.entryCount * sizeof(IndexEntry));
+
+  for (const IndexEntry& entry : this->_index) {
+    if (entry.offset > footer.indexOffset ||
+        entry.size > footer.indexOffset - entry.offset) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::optional<CesiumBundle::Response>
+CesiumBundle::find(const std::string& url) const {
+  auto range = std::equal_range(
+      this->_index.begin(),
+      this->_index.end(),
+      IndexEntry{hashUrl(url), 0, 0},
+      [](const IndexEntry& a, const IndexEntry& b) {
+        return a.keyHash < b.keyHash;
+      });
+
+  // Records whose URL has the same hash are told apart by their URL.
+  for (auto it = range.first; it != range.second; ++it) {
+    Reader reader(this->_pData + it->offset, static_cast<int64>(it->size));
+    RecordHeader header;
+    if (!reader.read(&header, sizeof(header)) || header.magic != recordMagic) {
+      continue;
+    }
+
+    const uint8* pKey = reader.take(header.keySize);
+    if (!pKey || header.keySize != url.size() ||
+        std::memcmp(pKey, url.data(), url.size()) != 0) {
+      continue;
+    }
+
+    const uint8* pMetadata = reader.take(header.metadataSize);
+    const uint8* pData = reader.take(header.dataSize);
+    if (!pMetadata || !pData) {
+      continue;
+    }
+
+    Reader metadata(pMetadata, header.metadataSize);
+    Response response;
+    uint32 statusCode;
+    if (!metadata.read(&statusCode, sizeof(statusCode)) ||
+        !metadata.readHeaders(response.headers)) {
+      continue;
+    }
+
+    response.statusCode = static_cast<uint16>(statusCode);
+    response.data = gsl::span<const std::byte>(
+        reinterpret_cast<const std::byte*>(pData),
+        header.dataSize);
+    return response;
+  }
+
+  return std::nullopt;
+}
+
+CesiumBundleWriter::CesiumBundleWriter(const FString& path)
+    : _path(path),
+      _temporaryPath(path + TEXT(".tmp")),
+      _mutex(),
+      _pFile(),
+      _urls(),
+      _index(),
+      _size(0),
+      _failed(false) {
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  platformFile.CreateDirectoryTree(*FPaths::GetPath(path));
+
+  this->_pFile.Reset(platformFile.OpenWrite(*this->_temporaryPath));
+  if (!this->_pFile) {
+    UE_LOG(LogCesium, Error, TEXT("Could not write %s"), *this->_temporaryPath);
+    this->_failed = true;
+  }
+}
+
+CesiumBundleWriter::~CesiumBundleWriter() {
+  // A bundle that was not finished is incomplete, so it is not kept.
+  if (this->_pFile) {
+    this->_pFile.Reset();
+    FPlatformFileManager::Get().GetPlatformFile().DeleteFile(
+        *this->_temporaryPath);
+  }
+}
+
+bool CesiumBundleWriter::isValid() const {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return !this->_failed;
+}
+
+void CesiumBundleWriter::add(
+    const std::string& url,
+    uint16 statusCode,
+    const CesiumAsync::HttpHeaders& headers,
+    const gsl::span<const std::byte>& data) {
+  if (url.size() > MAX_uint32 || data.size() > MAX_uint32) {
+    UE_LOG(
+        LogCesium,
+        Warning,
+        TEXT("Skipping %s, which is too large for a bundle"),
+        UTF8_TO_TCHAR(url.c_str()));
+    return;
+  }
+
+  TArray<uint8> metadata;
+  uint32 status = statusCode;
+  appendBytes(metadata, &status, sizeof(status));
+  appendHeaders(metadata, headers);
+
+  RecordHeader header{
+      recordMagic,
+      static_cast<uint32>(url.size()),
+      static_cast<uint32>(metadata.Num()),
+      static_cast<uint32>(data.size())};
+
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (!this->_pFile || this->_failed || !this->_urls.insert(url).second) {
+    return;
+  }
+
+  bool written =
+      this->_pFile->Write(
+          reinterpret_cast<const uint8*>(&header),
+          sizeof(header)) &&
+      this->_pFile->Write(
+          reinterpret_cast<const uint8*>(url.data()),
+          url.size()) &&
+      this->_pFile->Write(metadata.GetData(), metadata.Num()) &&
+      this->_pFile->Write(
+          reinterpret_cast<const uint8*>(data.data()),
+          data.size());
+  if (!written) {
+    UE_LOG(LogCesium, Error, TEXT("Could not write %s"), *this->_temporaryPath);
+    this->_failed = true;
+    return;
+  }
+
+  int64 recordSize = sizeof(header) + url.size() + metadata.Num() + data.size();
+  this->_index.push_back(CesiumBundle::IndexEntry{
+      hashUrl(url),
+      static_cast<uint64>(this->_size),
+      static_cast<uint64>(recordSize)});
+  this->_size += recordSize;
+}
+
+bool CesiumBundleWriter::finish() {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  if (!this->_pFile) {
+    return false;
+  }
+
+  std::sort(
+      this->_index.begin(),
+      this->_index.end(),
+      [](const CesiumBundle::IndexEntry& a, const CesiumBundle::IndexEntry& b) {
+        return a.keyHash < b.keyHash;
+      });
+
+  Footer footer{
+      footerMagic,
+      bundleVersion,
+      static_cast<uint64>(this->_size),
+      static_cast<uint64>(this->_index.size())};
+  int64 indexSize = this->_index.size() * sizeof(CesiumBundle::IndexEntry);
+
+  bool written =
+      !this->_failed &&
+      this->_pFile->Write(
+          reinterpret_cast<const uint8*>(this->_index.data()),
+          indexSize) &&
+      this->_pFile->Write(
+          reinterpret_cast<const uint8*>(&footer),
+          sizeof(footer)) &&
+      this->_pFile->Flush();
+  this->_pFile.Reset();
+
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  if (!written) {
+    UE_LOG(LogCesium, Error, TEXT("Could not write %s"), *this->_temporaryPath);
+    platformFile.DeleteFile(*this->_temporaryPath);
+    this->_failed = true;
+    return false;
+  }
+
+  this->_size += indexSize + sizeof(footer);
+
+  platformFile.DeleteFile(*this->_path);
+  if (!platformFile.MoveFile(*this->_path, *this->_temporaryPath)) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Could not replace %s, it may be open in another process"),
+        *this->_path);
+    this->_failed = true;
+    return false;
+  }
+
+  return true;
+}
+
+uint64 CesiumBundleWriter::getResponseCount() const {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_index.size();
+}
+
+int64 CesiumBundleWriter::getSize() const {
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  return this->_size;
+}
@@ -0,0 +1,148 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/IAssetResponse.h"
+#include "CoreMinimal.h"
+#include <cstddef>
+#include <gsl/span>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * @brief A portable file with the responses of all assets that a tileset and
+ * its raster overlays need to be shown in a region, so that they can be
+ * loaded without a network connection. Bundles are written with the
+ * CesiumPackage commandlet.
+ *
+ * The file starts with the records of the responses, each with the URL it was
+ * requested from, its status code and headers, and its body. They are
+ * followed by an index of the records sorted by a 64-bit hash of their URL,
+ * and a footer with the location of the index. A bundle is memory mapped
+ * when it is opened, so that only the parts of it that are used are read.
+ * Bundles that cannot be mapped, such as bundles in a pak file, cannot be
+ * opened, rather than being read into memory as a whole.
+ */
+class CesiumBundle {
+public:
+  /**
+   * @brief A response in a bundle, whose body stays valid as long as the
+   * bundle is open.
+   */
+  struct Response {
+    uint16 statusCode;
+    CesiumAsync::HttpHeaders headers;
+    gsl::span<const std::byte> data;
+  };
+
+  /**
+   * @brief Opens a bundle, or returns the bundle that is already open at the
+   * same path.
+   *
+   * @param path The absolute path of the bundle.
+   * @return The bundle, or nullptr if it cannot be read or is not a bundle.
+   */
+  static std::shared_ptr<CesiumBundle> open(const FString& path);
+
+  ~CesiumBundle();
+
+  /**
+   * @brief Finds the response of the asset requested from a URL.
+   */
+  std::optional<Response> find(const std::string& url) const;
+
+  /**
+   * @brief Gets the number of responses in the bundle.
+   */
+  uint64 getResponseCount() const noexcept { return this->_index.size(); }
+
+private:
+  friend class CesiumBundleWriter;
+
+  struct IndexEntry {
+    uint64 keyHash;
+    uint64 offset;
+    uint64 size;
+  };
+
+  CesiumBundle();
+
+  bool load(const FString& path);
+
+  FString _path;
+
+  TUniquePtr<IMappedFileHandle> _pMappedFile;
+  TUniquePtr<IMappedFileRegion> _pMappedRegion;
+  const uint8* _pData;
+  int64 _size;
+
+  std::vector<IndexEntry> _index;
+};
+
+/**
+ * @brief Writes a bundle of responses, see {@link CesiumBundle}.
+ *
+ * Responses may be added from any thread. The bundle is written to a
+ * temporary file next to it, which replaces the bundle once it is finished.
+ */
+class CesiumBundleWriter {
+public:
+  /**
+   * @brief Starts writing a bundle, creating its directory if needed.
+   */
+  CesiumBundleWriter(const FString& path);
+
+  ~CesiumBundleWriter();
+
+  /**
+   * @brief Returns false if the bundle could not be written.
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Adds the response of the asset requested from a URL, unless the
+   * bundle already contains a response for the URL.
+   */
+  void add(
+      const std::string& url,
+      uint16 statusCode,
+      const CesiumAsync::HttpHeaders& headers,
+      const gsl::span<const std::byte>& data);
+
+  /**
+   * @brief Writes the index of the bundle and replaces any bundle at its path
+   * with it. No responses may be added afterwards.
+   *
+   * @return Whether the bundle was written completely.
+   */
+  bool finish();
+
+  /**
+   * @brief Gets the number of responses added so far.
+   */
+  uint64 getResponseCount() const;
+
+  /**
+   * @brief Gets the size of the bundle written so far, in bytes.
+   */
+  int64 getSize() const;
+
+private:
+  FString _path;
+  FString _temporaryPath;
+
+  mutable std::mutex _mutex;
+  TUniquePtr<IFileHandle> _pFile;
+  std::unordered_set<std::string> _urls;
+  std::vector<CesiumBundle::IndexEntry> _index;
+  int64 _size;
+  bool _failed;
+};
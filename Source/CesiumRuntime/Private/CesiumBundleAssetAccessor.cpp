@@ -0,0 +1,119 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumBundleAssetAccessor.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CesiumAsync/IAssetResponse.h"
+#include "CesiumBundle.h"
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+class CesiumBundleAssetResponse : public CesiumAsync::IAssetResponse {
+public:
+  CesiumBundleAssetResponse(
+      const std::shared_ptr<CesiumBundle>& pBundle,
+      std::optional<CesiumBundle::Response>&& response)
+      : _pBundle(pBundle),
+        _statusCode(response ? response->statusCode : 404),
+        _headers(),
+        _data() {
+    if (response) {
+      this->_headers = std::move(response->headers);
+      this->_data = response->data;
+    }
+  }
+
+  virtual uint16_t statusCode() const override { return this->_statusCode; }
+
+  virtual std::string contentType() const override {
+    auto it = this->_headers.find("Content-Type");
+    return it != this->_headers.end() ? it->second : std::string();
+  }
+
+  virtual const CesiumAsync::HttpHeaders& headers() const override {
+    return this->_headers;
+  }
+
+  virtual gsl::span<const std::byte> data() const override {
+    return this->_data;
+  }
+
+private:
+  // Keeps the bundle that the data points into open.
+  std::shared_ptr<CesiumBundle> _pBundle;
+  uint16_t _statusCode;
+  CesiumAsync::HttpHeaders _headers;
+  gsl::span<const std::byte> _data;
+};
+
+class CesiumBundleAssetRequest : public CesiumAsync::IAssetRequest {
+public:
+  CesiumBundleAssetRequest(
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+      std::unique_ptr<CesiumBundleAssetResponse>&& pResponse)
+      : _method("GET"),
+        _url(url),
+        _headers(headers.begin(), headers.end()),
+        _pResponse(std::move(pResponse)) {}
+
+  virtual const std::string& method() const override { return this->_method; }
+
+  virtual const std::string& url() const override { return this->_url; }
+
+  virtual const CesiumAsync::HttpHeaders& headers() const override {
+    return this->_headers;
+  }
+
+  virtual const CesiumAsync::IAssetResponse* response() const override {
+    return this->_pResponse.get();
+  }
+
+private:
+  std::string _method;
+  std::string _url;
+  CesiumAsync::HttpHeaders _headers;
+  std::unique_ptr<CesiumBundleAssetResponse> _pResponse;
+};
+
+} // namespace
+
+CesiumBundleAssetAccessor::CesiumBundleAssetAccessor(
+    const std::shared_ptr<CesiumBundle>& pBundle)
+    : _pBundle(pBundle) {}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumBundleAssetAccessor::requestAsset(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& url,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) {
+  // The lookup is done in a worker thread, because reading the headers of the
+  // response may page in parts of the bundle.
+  return asyncSystem.runInWorkerThread(
+      [pBundle = this->_pBundle, url, headers]() {
+        return std::shared_ptr<CesiumAsync::IAssetRequest>(
+            std::make_shared<CesiumBundleAssetRequest>(
+                url,
+                headers,
+                std::make_unique<CesiumBundleAssetResponse>(
+                    pBundle,
+                    pBundle->find(url))));
+      });
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumBundleAssetAccessor::post(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& /*url*/,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& /*headers*/,
+    const gsl::span<const std::byte>& /*contentPayload*/) {
+  return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
+      [](const auto& promise) {
+        promise.reject(std::runtime_error(
+            "Posting is not supported while loading from a bundle."));
+      });
+}
+
+void CesiumBundleAssetAccessor::tick() noexcept {}
@@ -0,0 +1,41 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumAsync/IAssetAccessor.h"
+#include <memory>
+
+class CesiumBundle;
+
+/**
+ * @brief An asset accessor that loads assets from a bundle written by the
+ * CesiumPackage commandlet, without any network traffic.
+ *
+ * The bodies of the responses are not copied, but read from the bundle's
+ * mapping, which stays open as long as a response uses it. An asset that is
+ * not in the bundle results in a response with status code 404. Posting is
+ * not supported.
+ */
+class CesiumBundleAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+  CesiumBundleAssetAccessor(const std::shared_ptr<CesiumBundle>& pBundle);
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+  requestAsset(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+      override;
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> post(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+      const gsl::span<const std::byte>& contentPayload) override;
+
+  virtual void tick() noexcept override;
+
+private:
+  std::shared_ptr<CesiumBundle> _pBundle;
+};
@@ -0,0 +1,464 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumCacheDatabase.h"
+#include "CesiumAsync/CacheItem.h"
+#include "CesiumFlatFileCache.h"
+#include "CesiumSqliteCache.h"
+#include "CesiumRequestScheduler.h"
+#include "CesiumRuntime.h"
+#include "CesiumRuntimeSettings.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Crc.h"
+#include "Misc/Paths.h"
+#include <algorithm>
+#include <chrono>
+
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Request Cache Hits"),
+    STAT_CesiumRequestCacheHits,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Request Cache Misses"),
+    STAT_CesiumRequestCacheMisses,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Request Cache Bytes Read"),
+    STAT_CesiumRequestCacheBytesRead,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Request Cache Bytes Written"),
+    STAT_CesiumRequestCacheBytesWritten,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Request Cache Writes Dropped"),
+    STAT_CesiumRequestCacheWritesDropped,
+    STATGROUP_Cesium);
+DECLARE_DWORD_ACCUMULATOR_STAT(
+    TEXT("Request Cache Size (MB)"),
+    STAT_CesiumRequestCacheSize,
+    STATGROUP_Cesium);
+
+namespace {
+// How often the cache is pruned, in addition to when it is opened and when
+// pruning is requested. Tilesets only request it after many requests.
+constexpr std::chrono::minutes pruneInterval(10);
+
+// The size of the responses that may wait to be written. Responses stored
+// while more wait are not cached.
+constexpr size_t maximumPendingBytes = 64 * 1024 * 1024;
+
+std::shared_ptr<CesiumCacheDatabase> pInstance;
+
+void recordHit(size_t bytes) {
+  INC_DWORD_STAT(STAT_CesiumRequestCacheHits);
+  INC_DWORD_STAT_BY(STAT_CesiumRequestCacheBytesRead, bytes);
+  CSV_CUSTOM_STAT(Cesium, RequestCacheHits, 1, ECsvCustomStatOp::Accumulate);
+}
+
+FString getDefaultCacheDirectory() {
+  // On Android, EngineUserDir returns a "fake" directory. UE's IPlatformFile
+  // knows how to resolve it, but we can't pass it to cesium-native because
+  // cesium-native expects a real path. IAndroidPlatformFile::FileRootPath
+  // looks like it should be able to resolve it for us, but that's difficult
+  // to call from here.
+
+  // At the same time, apps on Android are isolated from each other and so we
+  // can't really share a cache between them anyway. So we store the cache in a
+  // different directory on Android.
+#if PLATFORM_ANDROID
+  return FPaths::ProjectPersistentDownloadDir();
+#else
+  return FPaths::EngineUserDir();
+#endif
+}
+
+std::string getCacheDatabaseName(
+    ECesiumRequestCacheType type,
+    const FString& directory) {
+  FString baseDirectory;
+  if (!directory.IsEmpty()) {
+    baseDirectory =
+        FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), directory);
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(
+        *baseDirectory);
+  } else {
+    baseDirectory = getDefaultCacheDirectory();
+  }
+
+  // The flat-file cache is a directory of segment files.
+  FString filename = FPaths::Combine(
+      baseDirectory,
+      type == ECesiumRequestCacheType::FlatFile
+          ? TEXT("cesium-request-cache")
+          : TEXT("cesium-request-cache.sqlite"));
+  UE_LOG(LogCesium, Verbose, TEXT("Caching Cesium requests in %s"), *filename);
+  return TCHAR_TO_UTF8(*filename);
+}
+
+/**
+ * Gets the path of a shard of the database, which is the path of the database
+ * for the first shard, and has the index of the shard appended to the file
+ * name for the others.
+ */
+std::string getShardName(const std::string& databaseName, int32 shard) {
+  if (shard == 0) {
+    return databaseName;
+  }
+
+  size_t extension = databaseName.rfind('.');
+  size_t separator = databaseName.find_last_of("/\\");
+  if (extension == std::string::npos ||
+      (separator != std::string::npos && extension < separator)) {
+    extension = databaseName.size();
+  }
+
+  return databaseName.substr(0, extension) + "-" + std::to_string(shard) +
+         databaseName.substr(extension);
+}
+} // namespace
+
+class CesiumCacheDatabase::Writer : public FRunnable {
+public:
+  Writer(CesiumCacheDatabase& database) : _database(database) {}
+
+  virtual uint32 Run() override {
+    this->_database.runWriter();
+    return 0;
+  }
+
+private:
+  CesiumCacheDatabase& _database;
+};
+
+/*static*/ const std::shared_ptr<CesiumCacheDatabase>&
+CesiumCacheDatabase::getInstance() {
+  if (!pInstance) {
+    const UCesiumRuntimeSettings* pSettings =
+        GetDefault<UCesiumRuntimeSettings>();
+    ECesiumRequestCacheType type = pSettings->RequestCacheType;
+    pInstance = std::make_shared<CesiumCacheDatabase>(
+        getCacheDatabaseName(type, pSettings->RequestCacheDirectory.Path),
+        pSettings->RequestCacheShardCount,
+        static_cast<uint64>(pSettings->RequestCacheMaximumItems),
+        pSettings->RequestCacheMaximumBytes,
+        static_cast<std::time_t>(pSettings->RequestCacheMaximumAgeDays) *
+            24 * 60 * 60,
+        [type](
+            const std::string& name,
+            uint64 maximumItems,
+            int64 maximumBytes)
+            -> std::unique_ptr<CesiumCacheShard> {
+          if (type == ECesiumRequestCacheType::FlatFile) {
+            return std::make_unique<CesiumFlatFileCache>(
+                name,
+                maximumItems,
+                maximumBytes);
+          }
+
+          return std::make_unique<CesiumSqliteCache>(
+              name,
+              maximumItems,
+              maximumBytes);
+        });
+  }
+  return pInstance;
+}
+
+/*static*/ void CesiumCacheDatabase::shutdown() {
+  if (pInstance) {
+    pInstance->stop();
+  }
+}
+
+CesiumCacheDatabase::CesiumCacheDatabase(
+    const std::string& databaseName,
+    int32 shardCount,
+    uint64 maximumItems,
+    int64 maximumBytes,
+    std::time_t maximumAge,
+    const CreateShard& createShard)
+    : _shards(),
+      _maximumAge(maximumAge),
+      _mutex(),
+      _pendingChanged(),
+      _pending(),
+      _writing(),
+      _pendingBytes(0),
+      _pruneRequested(false),
+      _stopping(false),
+      _pWriter(),
+      _pThread(nullptr) {
+  shardCount = FMath::Max(shardCount, 1);
+  uint64 maximumItemsPerShard =
+      FMath::Max(maximumItems / static_cast<uint64>(shardCount), uint64(1));
+  int64 maximumBytesPerShard = FMath::Max(maximumBytes, int64(0)) / shardCount;
+  for (int32 i = 0; i < shardCount; ++i) {
+    this->_shards.push_back(createShard(
+        getShardName(databaseName, i),
+        maximumItemsPerShard,
+        maximumBytesPerShard));
+  }
+
+  this->_pWriter = std::make_unique<Writer>(*this);
+  this->_pThread = FRunnableThread::Create(
+      this->_pWriter.get(),
+      TEXT("CesiumCacheWriter"),
+      0,
+      TPri_BelowNormal);
+
+  // Without a thread, for example when multithreading is disabled, responses
+  // are written right away.
+  if (!this->_pThread) {
+    this->_stopping = true;
+  }
+}
+
+CesiumCacheDatabase::~CesiumCacheDatabase() { this->stop(); }
+
+std::optional<CesiumAsync::CacheItem>
+CesiumCacheDatabase::getEntry(const std::string& key) const {
+  // Responses that wait to be written stay there for the background thread,
+  // so the reading thread never waits for a batch to be written.
+  std::shared_ptr<const PendingEntry> pEntry;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto it = this->_pending.find(key);
+    if (it != this->_pending.end()) {
+      pEntry = it->second;
+    } else if ((it = this->_writing.find(key)) != this->_writing.end()) {
+      pEntry = it->second;
+    }
+  }
+
+  if (!pEntry) {
+    std::optional<CesiumAsync::CacheItem> item =
+        this->getShard(key).getEntry(key);
+    if (item) {
+      recordHit(item->cacheResponse.data.size());
+    } else {
+      INC_DWORD_STAT(STAT_CesiumRequestCacheMisses);
+      CSV_CUSTOM_STAT(
+          Cesium,
+          RequestCacheMisses,
+          1,
+          ECsvCustomStatOp::Accumulate);
+    }
+    return item;
+  }
+
+  recordHit(pEntry->responseData.size());
+  return CesiumAsync::CacheItem(
+      pEntry->expiryTime,
+      CesiumAsync::CacheRequest(
+          CesiumAsync::HttpHeaders(pEntry->requestHeaders),
+          std::string(pEntry->requestMethod),
+          std::string(pEntry->url)),
+      CesiumAsync::CacheResponse(
+          pEntry->statusCode,
+          CesiumAsync::HttpHeaders(pEntry->responseHeaders),
+          std::vector<std::byte>(pEntry->responseData)));
+}
+
+bool CesiumCacheDatabase::storeEntry(
+    const std::string& key,
+    std::time_t expiryTime,
+    const std::string& url,
+    const std::string& requestMethod,
+    const CesiumAsync::HttpHeaders& requestHeaders,
+    uint16_t statusCode,
+    const CesiumAsync::HttpHeaders& responseHeaders,
+    const gsl::span<const std::byte>& responseData) {
+  if (this->_maximumAge > 0) {
+    expiryTime = std::min(expiryTime, std::time(nullptr) + this->_maximumAge);
+  }
+
+  // Checked before copying the response, and again when adding it.
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    if (!this->_stopping && this->_pendingBytes >= maximumPendingBytes) {
+      INC_DWORD_STAT(STAT_CesiumRequestCacheWritesDropped);
+      return false;
+    }
+  }
+
+  std::shared_ptr<PendingEntry> pEntry = std::make_shared<PendingEntry>();
+  pEntry->expiryTime = expiryTime;
+  pEntry->url = url;
+  pEntry->requestMethod = requestMethod;
+  pEntry->requestHeaders = requestHeaders;
+  pEntry->statusCode = statusCode;
+  pEntry->responseHeaders = responseHeaders;
+  pEntry->responseData.assign(responseData.begin(), responseData.end());
+
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  if (this->_stopping) {
+    lock.unlock();
+    this->write(key, *pEntry);
+    return true;
+  }
+
+  // The response is not cached rather than making the thread wait for the
+  // background thread to catch up.
+  if (this->_pendingBytes >= maximumPendingBytes) {
+    INC_DWORD_STAT(STAT_CesiumRequestCacheWritesDropped);
+    return false;
+  }
+
+  std::shared_ptr<const PendingEntry>& pPending = this->_pending[key];
+  if (pPending) {
+    this->_pendingBytes -= pPending->responseData.size();
+  }
+  this->_pendingBytes += pEntry->responseData.size();
+  pPending = std::move(pEntry);
+  this->_pendingChanged.notify_all();
+  return true;
+}
+
+bool CesiumCacheDatabase::prune() {
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  if (this->_stopping) {
+    lock.unlock();
+    this->pruneShards();
+    return true;
+  }
+
+  this->_pruneRequested = true;
+  this->_pendingChanged.notify_all();
+  return true;
+}
+
+bool CesiumCacheDatabase::clearAll() {
+  {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_pending.clear();
+    this->_pendingBytes = 0;
+    this->_pendingChanged.notify_all();
+
+    // Responses that are being written would be written after clearing.
+    this->_pendingChanged.wait(lock, [this]() {
+      return this->_writing.empty();
+    });
+  }
+
+  bool result = true;
+  for (const std::unique_ptr<CesiumCacheShard>& pShard : this->_shards) {
+    result = pShard->clearAll() && result;
+  }
+  return result;
+}
+
+CesiumCacheShard&
+CesiumCacheDatabase::getShard(const std::string& key) const {
+  if (this->_shards.size() == 1) {
+    return *this->_shards[0];
+  }
+
+  std::string host = CesiumRequestScheduler::getHostName(key);
+  uint32 hash = FCrc::MemCrc32(host.data(), static_cast<int32>(host.size()));
+  return *this->_shards[hash % this->_shards.size()];
+}
+
+void CesiumCacheDatabase::write(
+    const std::string& key,
+    const PendingEntry& entry) {
+  INC_DWORD_STAT_BY(
+      STAT_CesiumRequestCacheBytesWritten,
+      entry.responseData.size());
+  this->getShard(key).storeEntry(
+      key,
+      entry.expiryTime,
+      entry.url,
+      entry.requestMethod,
+      entry.requestHeaders,
+      entry.statusCode,
+      entry.responseHeaders,
+      gsl::span<const std::byte>(entry.responseData));
+}
+
+void CesiumCacheDatabase::runWriter() {
+  // The first wait times out right away, so that the cache is pruned when it
+  // is opened.
+  std::chrono::steady_clock::time_point nextPruneTime =
+      std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  for (;;) {
+    bool woken =
+        this->_pendingChanged.wait_until(lock, nextPruneTime, [this]() {
+          return !this->_pending.empty() || this->_pruneRequested ||
+                 this->_stopping;
+        });
+    if (!woken) {
+      this->_pruneRequested = true;
+    }
+
+    // Everything that waits to be written is written as one batch, outside
+    // the lock so that tiles can keep storing and reading responses.
+    if (!this->_pending.empty()) {
+      this->_writing.swap(this->_pending);
+      this->_pendingBytes = 0;
+      this->_pendingChanged.notify_all();
+
+      lock.unlock();
+      for (const std::unique_ptr<CesiumCacheShard>& pShard : this->_shards) {
+        pShard->beginBatch();
+      }
+      for (const auto& pair : this->_writing) {
+        this->write(pair.first, *pair.second);
+      }
+      for (const std::unique_ptr<CesiumCacheShard>& pShard : this->_shards) {
+        pShard->endBatch();
+      }
+      lock.lock();
+
+      this->_writing.clear();
+      this->_pendingChanged.notify_all();
+      continue;
+    }
+
+    if (this->_pruneRequested) {
+      this->_pruneRequested = false;
+
+      lock.unlock();
+      this->pruneShards();
+      lock.lock();
+
+      nextPruneTime = std::chrono::steady_clock::now() + pruneInterval;
+      continue;
+    }
+
+    if (this->_stopping) {
+      return;
+    }
+  }
+}
+
+void CesiumCacheDatabase::pruneShards() {
+  int64 size = 0;
+  for (const std::unique_ptr<CesiumCacheShard>& pShard : this->_shards) {
+    pShard->prune();
+    size += pShard->getSize();
+  }
+
+  SET_DWORD_STAT(
+      STAT_CesiumRequestCacheSize,
+      static_cast<uint32>(size / (1024 * 1024)));
+}
+
+void CesiumCacheDatabase::stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_stopping = true;
+  }
+  this->_pendingChanged.notify_all();
+
+  // The writer writes the pending responses before it returns.
+  if (this->_pThread) {
+    this->_pThread->WaitForCompletion();
+    delete this->_pThread;
+    this->_pThread = nullptr;
+  }
+}
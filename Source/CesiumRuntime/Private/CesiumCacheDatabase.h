@@ -0,0 +1,149 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/ICacheDatabase.h"
+#include "CesiumCacheShard.h"
+#include "CoreMinimal.h"
+#include <condition_variable>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FRunnableThread;
+
+/**
+ * @brief The request cache shared by all tilesets.
+ *
+ * Responses are stored by a background thread, so that the threads that load
+ * tiles never wait for the database to write. The background thread writes
+ * all responses that wait to be written as one batch. The responses that wait
+ * are kept in memory and served from there in the meantime, and storing the
+ * same response again before it was written only writes it once. When too
+ * many bytes wait, further responses are not cached rather than making the
+ * threads that load tiles wait.
+ * Pruning also runs on the background thread, when the cache is opened, at
+ * regular intervals, and when it is requested.
+ *
+ * The cache can be sharded by host into several databases, so that requests
+ * to different hosts do not contend for the same database. The databases are
+ * either SQLite databases or flat-file caches, as chosen in the Cesium project
+ * settings.
+ *
+ * The cache is created on first use with the settings of the Cesium project
+ * settings, and its pending writes are flushed when the module shuts down.
+ */
+class CesiumCacheDatabase : public CesiumAsync::ICacheDatabase {
+public:
+  /**
+   * @brief Creates the database of a shard, given its path and the maximum
+   * number and size of the responses it keeps. A maximum size of zero means
+   * no limit.
+   */
+  using CreateShard = std::function<std::unique_ptr<CesiumCacheShard>(
+      const std::string& name,
+      uint64 maximumItems,
+      int64 maximumBytes)>;
+
+  /**
+   * @brief Gets the request cache, creating it if needed.
+   */
+  static const std::shared_ptr<CesiumCacheDatabase>& getInstance();
+
+  /**
+   * @brief Writes the pending responses and stops the background thread.
+   * Responses stored afterwards are written right away.
+   */
+  static void shutdown();
+
+  /**
+   * @brief Creates a cache.
+   *
+   * @param databaseName The path of the first database. The paths of the other
+   * shards have the index of the shard appended to the file name.
+   * @param shardCount The number of databases to shard the requests into by
+   * host.
+   * @param maximumItems The maximum number of responses kept in the cache, all
+   * shards combined. Pruning removes expired responses first, and then the
+   * least recently used ones.
+   * @param maximumBytes The maximum size of the responses kept in the cache,
+   * all shards combined, or zero for no limit.
+   * @param maximumAge The time after which a response expires at the latest,
+   * and is removed when the cache is pruned, in seconds, or zero for no limit.
+   * @param createShard Creates the database of each shard.
+   */
+  CesiumCacheDatabase(
+      const std::string& databaseName,
+      int32 shardCount,
+      uint64 maximumItems,
+      int64 maximumBytes,
+      std::time_t maximumAge,
+      const CreateShard& createShard);
+
+  virtual ~CesiumCacheDatabase();
+
+  virtual std::optional<CesiumAsync::CacheItem>
+  getEntry(const std::string& key) const override;
+
+  virtual bool storeEntry(
+      const std::string& key,
+      std::time_t expiryTime,
+      const std::string& url,
+      const std::string& requestMethod,
+      const CesiumAsync::HttpHeaders& requestHeaders,
+      uint16_t statusCode,
+      const CesiumAsync::HttpHeaders& responseHeaders,
+      const gsl::span<const std::byte>& responseData) override;
+
+  /**
+   * @brief Requests the background thread to prune the cache, and returns
+   * right away.
+   */
+  virtual bool prune() override;
+
+  virtual bool clearAll() override;
+
+private:
+  struct PendingEntry {
+    std::time_t expiryTime;
+    std::string url;
+    std::string requestMethod;
+    CesiumAsync::HttpHeaders requestHeaders;
+    uint16_t statusCode;
+    CesiumAsync::HttpHeaders responseHeaders;
+    std::vector<std::byte> responseData;
+  };
+
+  using PendingEntries =
+      std::unordered_map<std::string, std::shared_ptr<const PendingEntry>>;
+
+  class Writer;
+
+  CesiumCacheShard& getShard(const std::string& key) const;
+  void write(const std::string& key, const PendingEntry& entry);
+  void runWriter();
+  void pruneShards();
+  void stop();
+
+  std::vector<std::unique_ptr<CesiumCacheShard>> _shards;
+  std::time_t _maximumAge;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _pendingChanged;
+
+  // The entries that wait to be written, and the ones being written.
+  PendingEntries _pending;
+  PendingEntries _writing;
+  size_t _pendingBytes;
+  bool _pruneRequested;
+  bool _stopping;
+
+  std::unique_ptr<Writer> _pWriter;
+  FRunnableThread* _pThread;
+};
@@ -0,0 +1,31 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/ICacheDatabase.h"
+#include "CoreMinimal.h"
+
+/**
+ * @brief A database that the request cache is sharded into.
+ *
+ * The background thread of the request cache writes the responses that wait
+ * to be written in batches. A database may write all responses of a batch,
+ * which are stored between beginBatch and endBatch, in one transaction.
+ */
+class CesiumCacheShard : public CesiumAsync::ICacheDatabase {
+public:
+  /**
+   * @brief Gets the size of the database, in bytes.
+   */
+  virtual int64 getSize() const = 0;
+
+  /**
+   * @brief Begins a batch of responses. Only called by one thread at a time.
+   */
+  virtual void beginBatch() {}
+
+  /**
+   * @brief Ends the batch of responses that was begun with beginBatch.
+   */
+  virtual void endBatch() {}
+};
@@ -0,0 +1,499 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumCameraSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "CesiumRuntimeSettings.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Engine/Engine.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/Level.h"
+#include "Engine/SceneCapture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "StereoRendering.h"
+#include <glm/trigonometric.hpp>
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#endif
+
+/*static*/ UCesiumCameraSubsystem*
+UCesiumCameraSubsystem::Get(const UObject* WorldContextObject) {
+  if (!WorldContextObject) {
+    return nullptr;
+  }
+  UWorld* pWorld = WorldContextObject->GetWorld();
+  if (!IsValid(pWorld)) {
+    return nullptr;
+  }
+  return pWorld->GetSubsystem<UCesiumCameraSubsystem>();
+}
+
+int32 UCesiumCameraSubsystem::AddCamera(const FCesiumCamera& Camera) {
+  int32 cameraId = this->_nextCameraId++;
+  this->_registeredCameras.Add(cameraId, Camera);
+  this->_camerasChanged = true;
+  return cameraId;
+}
+
+bool UCesiumCameraSubsystem::UpdateCamera(
+    int32 CameraId,
+    const FCesiumCamera& Camera) {
+  FCesiumCamera* pCamera = this->_registeredCameras.Find(CameraId);
+  if (!pCamera) {
+    return false;
+  }
+  *pCamera = Camera;
+  this->_camerasChanged = true;
+  return true;
+}
+
+bool UCesiumCameraSubsystem::RemoveCamera(int32 CameraId) {
+  bool removed = this->_registeredCameras.Remove(CameraId) > 0;
+  if (removed) {
+    this->_camerasChanged = true;
+  }
+  return removed;
+}
+
+int32 UCesiumCameraSubsystem::AddPrefetchCameras(
+    const TArray<FCesiumCamera>& Cameras) {
+  int32 prefetchId = this->_nextPrefetchId++;
+  this->_registeredPrefetchCameras.Add(prefetchId, Cameras);
+  this->_lastPrefetchFrameNumber = MAX_uint64;
+  return prefetchId;
+}
+
+bool UCesiumCameraSubsystem::RemovePrefetchCameras(int32 PrefetchId) {
+  bool removed = this->_registeredPrefetchCameras.Remove(PrefetchId) > 0;
+  if (removed) {
+    this->_lastPrefetchFrameNumber = MAX_uint64;
+  }
+  return removed;
+}
+
+void UCesiumCameraSubsystem::AddSceneCapture(
+    USceneCaptureComponent2D* SceneCapture) {
+  if (IsValid(SceneCapture)) {
+    this->_sceneCaptures.AddUnique(SceneCapture);
+    this->_camerasChanged = true;
+  }
+}
+
+void UCesiumCameraSubsystem::RemoveSceneCapture(
+    USceneCaptureComponent2D* SceneCapture) {
+  this->_sceneCaptures.Remove(SceneCapture);
+  this->_camerasChanged = true;
+}
+
+void UCesiumCameraSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+  Super::Initialize(Collection);
+
+  UWorld* pWorld = this->GetWorld();
+  if (pWorld) {
+    this->_actorSpawnedHandle = pWorld->AddOnActorSpawnedHandler(
+        FOnActorSpawned::FDelegate::CreateUObject(
+            this,
+            &UCesiumCameraSubsystem::OnActorSpawned));
+  }
+
+  this->_levelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(
+      this,
+      &UCesiumCameraSubsystem::OnLevelAdded);
+
+#if WITH_EDITOR
+  if (GEngine) {
+    // Actors that are pasted or duplicated in the Editor do not go through
+    // SpawnActor, so they are not reported by OnActorSpawned.
+    this->_levelActorAddedHandle = GEngine->OnLevelActorAdded().AddUObject(
+        this,
+        &UCesiumCameraSubsystem::OnActorSpawned);
+  }
+#endif
+}
+
+void UCesiumCameraSubsystem::Deinitialize() {
+  UWorld* pWorld = this->GetWorld();
+  if (pWorld) {
+    pWorld->RemoveOnActorSpawnedHandler(this->_actorSpawnedHandle);
+  }
+
+  FWorldDelegates::LevelAddedToWorld.Remove(this->_levelAddedHandle);
+
+#if WITH_EDITOR
+  if (GEngine) {
+    GEngine->OnLevelActorAdded().Remove(this->_levelActorAddedHandle);
+  }
+#endif
+
+  this->_sceneCaptures.Empty();
+  this->_registeredCameras.Empty();
+  this->_registeredPrefetchCameras.Empty();
+  this->_cameras.clear();
+  this->_previousCameras.clear();
+  this->_prefetchCameras.clear();
+
+  Super::Deinitialize();
+}
+
+const std::vector<FCesiumCamera>& UCesiumCameraSubsystem::GetCameras() {
+  bool newFrame = this->_lastFrameNumber != GFrameCounter;
+  if (!newFrame && !this->_camerasChanged) {
+    return this->_cameras;
+  }
+
+  // Cameras that change during a frame are gathered again, but the previous
+  // cameras are only replaced once per frame, so that the velocities estimated
+  // from them always span a whole frame.
+  if (newFrame) {
+    this->_lastFrameNumber = GFrameCounter;
+    std::swap(this->_previousCameras, this->_cameras);
+    this->_previousCamerasTime = this->_camerasTime;
+    this->_camerasTime = FPlatformTime::Seconds();
+  }
+  this->_camerasChanged = false;
+  this->_cameras.clear();
+
+  this->AddPlayerCameras(this->_cameras);
+#if WITH_EDITOR
+  this->AddEditorCameras(this->_cameras);
+#endif
+  this->_renderedCameraCount = this->_cameras.size();
+
+  this->AddSceneCaptureCameras(this->_cameras);
+
+  for (const TPair<int32, FCesiumCamera>& registered :
+       this->_registeredCameras) {
+    this->_cameras.push_back(registered.Value);
+  }
+
+  return this->_cameras;
+}
+
+size_t UCesiumCameraSubsystem::GetRenderedCameraCount() {
+  // Make sure that the cameras are up to date.
+  this->GetCameras();
+  return this->_renderedCameraCount;
+}
+
+const std::vector<FCesiumCamera>& UCesiumCameraSubsystem::GetPrefetchCameras() {
+  if (this->_lastPrefetchFrameNumber == GFrameCounter) {
+    return this->_prefetchCameras;
+  }
+
+  this->_lastPrefetchFrameNumber = GFrameCounter;
+  this->_prefetchCameras.clear();
+
+  for (const TPair<int32, TArray<FCesiumCamera>>& registered :
+       this->_registeredPrefetchCameras) {
+    this->_prefetchCameras.insert(
+        this->_prefetchCameras.end(),
+        registered.Value.GetData(),
+        registered.Value.GetData() + registered.Value.Num());
+  }
+
+  float lookaheadSeconds =
+      GetDefault<UCesiumRuntimeSettings>()->CameraPrefetchLookaheadSeconds;
+  if (lookaheadSeconds > 0.0f) {
+    // Make sure that the current and previous cameras are up to date.
+    this->GetCameras();
+    this->AddExtrapolatedCameras(this->_prefetchCameras, lookaheadSeconds);
+  }
+
+  return this->_prefetchCameras;
+}
+
+void UCesiumCameraSubsystem::OnActorSpawned(AActor* Actor) {
+  if (Actor && Actor->GetWorld() == this->GetWorld()) {
+    this->TrackActor(Actor);
+  }
+}
+
+void UCesiumCameraSubsystem::OnLevelAdded(ULevel* Level, UWorld* World) {
+  if (World != this->GetWorld() || !IsValid(Level)) {
+    return;
+  }
+
+  for (AActor* pActor : Level->Actors) {
+    this->TrackActor(pActor);
+  }
+}
+
+void UCesiumCameraSubsystem::TrackActor(AActor* Actor) {
+  ASceneCapture2D* pSceneCapture = Cast<ASceneCapture2D>(Actor);
+  if (pSceneCapture) {
+    this->AddSceneCapture(pSceneCapture->GetCaptureComponent2D());
+  }
+}
+
+void UCesiumCameraSubsystem::ScanWorldForSceneCaptures() {
+  // Actors that already exist when the subsystem is created are not reported
+  // by the spawn and level events, so find them once.
+  for (TActorIterator<ASceneCapture2D> it(this->GetWorld()); it; ++it) {
+    this->TrackActor(*it);
+  }
+}
+
+void UCesiumCameraSubsystem::AddPlayerCameras(
+    std::vector<FCesiumCamera>& cameras) const {
+  UWorld* pWorld = this->GetWorld();
+  if (!pWorld) {
+    return;
+  }
+
+  float worldToMeters = 100.0f;
+  AWorldSettings* pWorldSettings = pWorld->GetWorldSettings();
+  if (pWorldSettings) {
+    worldToMeters = pWorldSettings->WorldToMeters;
+  }
+
+  UGameViewportClient* pViewport = pWorld->GetGameViewport();
+  if (!pViewport) {
+    return;
+  }
+
+  FVector2D size;
+  pViewport->GetViewportSize(size);
+  if (size.X < 1.0 || size.Y < 1.0) {
+    return;
+  }
+
+  TSharedPtr<IStereoRendering, ESPMode::ThreadSafe> pStereoRendering = nullptr;
+  if (GEngine) {
+    pStereoRendering = GEngine->StereoRenderingDevice;
+  }
+
+  bool useStereoRendering = false;
+  if (pStereoRendering && pStereoRendering->IsStereoEnabled()) {
+    useStereoRendering = true;
+  }
+
+  uint32 stereoLeftSizeX = static_cast<uint32>(size.X);
+  uint32 stereoLeftSizeY = static_cast<uint32>(size.Y);
+  uint32 stereoRightSizeX = static_cast<uint32>(size.X);
+  uint32 stereoRightSizeY = static_cast<uint32>(size.Y);
+  if (useStereoRendering) {
+    int32 _x;
+    int32 _y;
+
+    pStereoRendering->AdjustViewRect(
+        EStereoscopicPass::eSSP_LEFT_EYE,
+        _x,
+        _y,
+        stereoLeftSizeX,
+        stereoLeftSizeY);
+
+    pStereoRendering->AdjustViewRect(
+        EStereoscopicPass::eSSP_RIGHT_EYE,
+        _x,
+        _y,
+        stereoRightSizeX,
+        stereoRightSizeY);
+  }
+
+  FVector2D stereoLeftSize(stereoLeftSizeX, stereoRightSizeY);
+  FVector2D stereoRightSize(stereoRightSizeX, stereoRightSizeY);
+
+  for (auto playerControllerIt = pWorld->GetPlayerControllerIterator();
+       playerControllerIt;
+       playerControllerIt++) {
+
+    const TWeakObjectPtr<APlayerController> pPlayerController =
+        *playerControllerIt;
+    if (pPlayerController == nullptr) {
+      continue;
+    }
+
+    const APlayerCameraManager* pPlayerCameraManager =
+        pPlayerController->PlayerCameraManager;
+
+    if (!pPlayerCameraManager) {
+      continue;
+    }
+
+    float fov = pPlayerCameraManager->GetFOVAngle();
+
+    FVector location;
+    FRotator rotation;
+    pPlayerController->GetPlayerViewPoint(location, rotation);
+
+    if (useStereoRendering) {
+      if (stereoLeftSize.X >= 1.0 && stereoLeftSize.Y >= 1.0) {
+        FVector leftEyeLocation = location;
+        FRotator leftEyeRotation = rotation;
+        pStereoRendering->CalculateStereoViewOffset(
+            EStereoscopicPass::eSSP_LEFT_EYE,
+            leftEyeRotation,
+            worldToMeters,
+            leftEyeLocation);
+
+        FMatrix projection = pStereoRendering->GetStereoProjectionMatrix(
+            EStereoscopicPass::eSSP_LEFT_EYE);
+
+        // TODO: consider assymetric frustums using 4 fovs
+        float one_over_tan_half_hfov = projection.M[0][0];
+
+        float hfov =
+            glm::degrees(2.0f * glm::atan(1.0f / one_over_tan_half_hfov));
+
+        cameras.emplace_back(
+            stereoLeftSize,
+            leftEyeLocation,
+            leftEyeRotation,
+            hfov);
+      }
+
+      if (stereoRightSize.X >= 1.0 && stereoRightSize.Y >= 1.0) {
+        FVector rightEyeLocation = location;
+        FRotator rightEyeRotation = rotation;
+        pStereoRendering->CalculateStereoViewOffset(
+            EStereoscopicPass::eSSP_RIGHT_EYE,
+            rightEyeRotation,
+            worldToMeters,
+            rightEyeLocation);
+
+        FMatrix projection = pStereoRendering->GetStereoProjectionMatrix(
+            EStereoscopicPass::eSSP_RIGHT_EYE);
+
+        float one_over_tan_half_hfov = projection.M[0][0];
+
+        float hfov =
+            glm::degrees(2.0f * glm::atan(1.0f / one_over_tan_half_hfov));
+
+        cameras.emplace_back(
+            stereoRightSize,
+            rightEyeLocation,
+            rightEyeRotation,
+            hfov);
+      }
+    } else {
+      cameras.emplace_back(size, location, rotation, fov);
+    }
+  }
+}
+
+void UCesiumCameraSubsystem::AddSceneCaptureCameras(
+    std::vector<FCesiumCamera>& cameras) {
+  if (!this->_initialScanDone) {
+    this->ScanWorldForSceneCaptures();
+    this->_initialScanDone = true;
+  }
+
+  // Destroyed scene captures are dropped here rather than tracked with
+  // per-actor delegates.
+  this->_sceneCaptures.RemoveAll(
+      [](const TWeakObjectPtr<USceneCaptureComponent2D>& pCapture) {
+        return !pCapture.IsValid();
+      });
+
+  for (const TWeakObjectPtr<USceneCaptureComponent2D>& pCapture :
+       this->_sceneCaptures) {
+    USceneCaptureComponent2D* pSceneCaptureComponent = pCapture.Get();
+
+    if (pSceneCaptureComponent->ProjectionType !=
+        ECameraProjectionMode::Type::Perspective) {
+      continue;
+    }
+
+    UTextureRenderTarget2D* pRenderTarget =
+        pSceneCaptureComponent->TextureTarget;
+    if (!pRenderTarget) {
+      continue;
+    }
+
+    FVector2D renderTargetSize(pRenderTarget->SizeX, pRenderTarget->SizeY);
+    if (renderTargetSize.X < 1.0 || renderTargetSize.Y < 1.0) {
+      continue;
+    }
+
+    FVector captureLocation = pSceneCaptureComponent->GetComponentLocation();
+    FRotator captureRotation = pSceneCaptureComponent->GetComponentRotation();
+    float captureFov = pSceneCaptureComponent->FOVAngle;
+
+    cameras.emplace_back(
+        renderTargetSize,
+        captureLocation,
+        captureRotation,
+        captureFov);
+  }
+}
+
+void UCesiumCameraSubsystem::AddExtrapolatedCameras(
+    std::vector<FCesiumCamera>& cameras,
+    float lookaheadSeconds) const {
+  // The cameras are gathered in the same order every frame, so a camera is
+  // matched with its previous state by index. If the set of cameras changed,
+  // there is no meaningful velocity.
+  if (this->_cameras.size() != this->_previousCameras.size()) {
+    return;
+  }
+
+  double deltaSeconds = this->_camerasTime - this->_previousCamerasTime;
+  if (deltaSeconds <= 0.0) {
+    return;
+  }
+
+  float scale = static_cast<float>(lookaheadSeconds / deltaSeconds);
+
+  for (size_t i = 0; i < this->_cameras.size(); ++i) {
+    const FCesiumCamera& camera = this->_cameras[i];
+    const FCesiumCamera& previous = this->_previousCameras[i];
+
+    FVector offset = (camera.Location - previous.Location) * scale;
+    if (offset.IsNearlyZero()) {
+      continue;
+    }
+
+    cameras.emplace_back(
+        camera.ViewportSize,
+        camera.Location + offset,
+        camera.Rotation,
+        camera.FieldOfViewDegrees);
+  }
+}
+
+#if WITH_EDITOR
+void UCesiumCameraSubsystem::AddEditorCameras(
+    std::vector<FCesiumCamera>& cameras) const {
+  if (!GEditor) {
+    return;
+  }
+
+  UWorld* pWorld = this->GetWorld();
+  if (!IsValid(pWorld)) {
+    return;
+  }
+
+  // Do not include editor cameras when running in a game world (which includes
+  // Play-in-Editor)
+  if (pWorld->IsGameWorld()) {
+    return;
+  }
+
+  const TArray<FEditorViewportClient*>& viewportClients =
+      GEditor->GetAllViewportClients();
+
+  for (FEditorViewportClient* pEditorViewportClient : viewportClients) {
+    if (!pEditorViewportClient) {
+      continue;
+    }
+
+    const FVector& location = pEditorViewportClient->GetViewLocation();
+    const FRotator& rotation = pEditorViewportClient->GetViewRotation();
+    float fov = pEditorViewportClient->ViewFOV;
+    FIntPoint offset;
+    FIntPoint size;
+    pEditorViewportClient->GetViewportDimensions(offset, size);
+
+    if (size.X < 1 || size.Y < 1) {
+      continue;
+    }
+
+    cameras.emplace_back(FVector2D(size.X, size.Y), location, rotation, fov);
+  }
+}
+#endif
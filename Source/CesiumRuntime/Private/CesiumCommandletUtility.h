@@ -0,0 +1,49 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/Tile.h"
+#include "CoreMinimal.h"
+#include <vector>
+
+/**
+ * Helpers for the commandlets that load the tiles of a tileset for a series
+ * of views, without rendering them.
+ */
+namespace CesiumCommandletUtility {
+
+/**
+ * The number of consecutive frames in which nothing may be loading before a
+ * view is considered loaded. Tiles that finished loading only become
+ * renderable in the next frame, which may start loading their children.
+ */
+constexpr int32 idleFramesPerView = 2;
+
+/**
+ * The time to wait between frames while tiles are loading, in seconds, so
+ * that the commandlet doesn't compete with the workers that load them.
+ */
+constexpr float loadingFrameSeconds = 0.001f;
+
+/**
+ * Returns true if the content of any loaded tile is still being loaded.
+ */
+inline bool isContentLoading(const Cesium3DTilesSelection::Tile& rootTile) {
+  std::vector<const Cesium3DTilesSelection::Tile*> tiles{&rootTile};
+  while (!tiles.empty()) {
+    const Cesium3DTilesSelection::Tile* pTile = tiles.back();
+    tiles.pop_back();
+
+    if (pTile->getState() ==
+        Cesium3DTilesSelection::Tile::LoadState::ContentLoading) {
+      return true;
+    }
+
+    for (const Cesium3DTilesSelection::Tile& child : pTile->getChildren()) {
+      tiles.push_back(&child);
+    }
+  }
+  return false;
+}
+
+} // namespace CesiumCommandletUtility
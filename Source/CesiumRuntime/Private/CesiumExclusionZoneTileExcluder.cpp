@@ -0,0 +1,92 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumExclusionZoneTileExcluder.h"
+#include "Cesium3DTilesSelection/Tile.h"
+#include "CesiumGeospatial/BoundingRegion.h"
+#include "CesiumUtility/Math.h"
+
+namespace {
+const CesiumGeospatial::GlobeRectangle*
+getTileRectangle(const Cesium3DTilesSelection::Tile& tile) {
+  const CesiumGeospatial::BoundingRegion* pRegion =
+      std::get_if<CesiumGeospatial::BoundingRegion>(&tile.getBoundingVolume());
+  return pRegion ? &pRegion->getRectangle() : nullptr;
+}
+
+/**
+ * Determines whether the inner rectangle lies entirely inside the outer one.
+ * Longitudes are measured eastwards from the west edge of the outer
+ * rectangle, so that either may cross the antimeridian.
+ */
+bool containsRectangle(
+    const CesiumGeospatial::GlobeRectangle& outer,
+    const CesiumGeospatial::GlobeRectangle& inner) {
+  if (inner.getSouth() < outer.getSouth() ||
+      inner.getNorth() > outer.getNorth()) {
+    return false;
+  }
+
+  double west = inner.getWest() - outer.getWest();
+  if (west < 0.0) {
+    west += CesiumUtility::Math::TWO_PI;
+  }
+  return west + inner.computeWidth() <= outer.computeWidth();
+}
+} // namespace
+
+void CesiumExclusionZoneTileExcluder::setExclusionZones(
+    const TArray<FCesiumExclusionZone>& exclusionZones) {
+  this->_rectangles.clear();
+  this->_rectangles.reserve(exclusionZones.Num());
+
+  for (const FCesiumExclusionZone& exclusionZone : exclusionZones) {
+    this->_rectangles.emplace_back(
+        CesiumGeospatial::GlobeRectangle::fromDegrees(
+            exclusionZone.West,
+            exclusionZone.South,
+            exclusionZone.East,
+            exclusionZone.North));
+  }
+}
+
+bool CesiumExclusionZoneTileExcluder::shouldExclude(
+    const Cesium3DTilesSelection::Tile& tile) const noexcept {
+  if (this->_rectangles.empty()) {
+    return false;
+  }
+
+  const CesiumGeospatial::GlobeRectangle* pTileRectangle =
+      getTileRectangle(tile);
+  if (!pTileRectangle) {
+    return false;
+  }
+
+  for (const CesiumGeospatial::GlobeRectangle& rectangle : this->_rectangles) {
+    if (containsRectangle(rectangle, *pTileRectangle)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool CesiumExclusionZoneTileExcluder::overlaps(
+    const Cesium3DTilesSelection::Tile& tile) const noexcept {
+  if (this->_rectangles.empty()) {
+    return false;
+  }
+
+  const CesiumGeospatial::GlobeRectangle* pTileRectangle =
+      getTileRectangle(tile);
+  if (!pTileRectangle) {
+    return false;
+  }
+
+  for (const CesiumGeospatial::GlobeRectangle& rectangle : this->_rectangles) {
+    if (rectangle.computeIntersection(*pTileRectangle)) {
+      return true;
+    }
+  }
+
+  return false;
+}
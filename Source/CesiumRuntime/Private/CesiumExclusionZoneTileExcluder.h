@@ -0,0 +1,48 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/ITileExcluder.h"
+#include "CesiumExclusionZone.h"
+#include "CesiumGeospatial/GlobeRectangle.h"
+#include "CoreMinimal.h"
+#include <vector>
+
+/**
+ * @brief A tile excluder that excludes tiles whose bounding region lies
+ * entirely inside any of a set of {@link FCesiumExclusionZone} rectangles.
+ *
+ * The exclusion zones are converted to {@link GlobeRectangle} instances once,
+ * when they are set, rather than every time a tile is tested. Because this
+ * excluder is consulted during tile selection, excluded tiles and all of
+ * their descendants are never loaded. Tiles that only partly overlap a zone
+ * are not excluded, because their descendants may lie outside of it, like
+ * with the RasterizedPolygonsTileExcluder. Use {@link overlaps} to hide them
+ * when they are rendered.
+ *
+ * Only tiles with a bounding region are considered. Tiles with any other type
+ * of bounding volume are never excluded.
+ */
+class CesiumExclusionZoneTileExcluder
+    : public Cesium3DTilesSelection::ITileExcluder {
+public:
+  /**
+   * @brief Replaces the exclusion zones used by this excluder.
+   *
+   * @param exclusionZones The new exclusion zones.
+   */
+  void setExclusionZones(const TArray<FCesiumExclusionZone>& exclusionZones);
+
+  virtual bool
+  shouldExclude(const Cesium3DTilesSelection::Tile& tile) const noexcept
+      override;
+
+  /**
+   * @brief Determines whether the bounding region of a tile overlaps any of
+   * the exclusion zones, even if only partly.
+   */
+  bool overlaps(const Cesium3DTilesSelection::Tile& tile) const noexcept;
+
+private:
+  std::vector<CesiumGeospatial::GlobeRectangle> _rectangles;
+};
@@ -0,0 +1,127 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumFileAssetAccessor.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CesiumAsync/IAssetResponse.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "Misc/FileHelper.h"
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+class CesiumFileAssetResponse : public CesiumAsync::IAssetResponse {
+public:
+  CesiumFileAssetResponse(uint16_t statusCode, TArray<uint8>&& data)
+      : _statusCode(statusCode), _headers(), _data(MoveTemp(data)) {}
+
+  virtual uint16_t statusCode() const override { return this->_statusCode; }
+
+  virtual std::string contentType() const override { return std::string(); }
+
+  virtual const CesiumAsync::HttpHeaders& headers() const override {
+    return this->_headers;
+  }
+
+  virtual gsl::span<const std::byte> data() const override {
+    return gsl::span(
+        reinterpret_cast<const std::byte*>(this->_data.GetData()),
+        this->_data.Num());
+  }
+
+private:
+  uint16_t _statusCode;
+  CesiumAsync::HttpHeaders _headers;
+  TArray<uint8> _data;
+};
+
+class CesiumFileAssetRequest : public CesiumAsync::IAssetRequest {
+public:
+  CesiumFileAssetRequest(
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+      std::unique_ptr<CesiumFileAssetResponse>&& pResponse)
+      : _method("GET"),
+        _url(url),
+        _headers(headers.begin(), headers.end()),
+        _pResponse(std::move(pResponse)) {}
+
+  virtual const std::string& method() const override { return this->_method; }
+
+  virtual const std::string& url() const override { return this->_url; }
+
+  virtual const CesiumAsync::HttpHeaders& headers() const override {
+    return this->_headers;
+  }
+
+  virtual const CesiumAsync::IAssetResponse* response() const override {
+    return this->_pResponse.get();
+  }
+
+private:
+  std::string _method;
+  std::string _url;
+  CesiumAsync::HttpHeaders _headers;
+  std::unique_ptr<CesiumFileAssetResponse> _pResponse;
+};
+
+/**
+ * Converts a `file://` URL to a path in the local file system. The query and
+ * fragment are ignored.
+ */
+FString urlToPath(const std::string& url) {
+  FString path = UTF8_TO_TCHAR(url.c_str());
+
+  int32 end = INDEX_NONE;
+  if (path.FindChar('?', end) || path.FindChar('#', end)) {
+    path = path.Left(end);
+  }
+
+  path.RemoveFromStart(TEXT("file://"), ESearchCase::IgnoreCase);
+
+#if PLATFORM_WINDOWS
+  // file:///C:/path has a leading slash before the drive letter.
+  if (path.Len() > 2 && path[0] == '/' && path[2] == ':') {
+    path = path.RightChop(1);
+  }
+#endif
+
+  return FGenericPlatformHttp::UrlDecode(path);
+}
+
+} // namespace
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumFileAssetAccessor::requestAsset(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& url,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) {
+  return asyncSystem.runInWorkerThread([url, headers]() {
+    TArray<uint8> data;
+    uint16_t statusCode =
+        FFileHelper::LoadFileToArray(data, *urlToPath(url)) ? 200 : 404;
+
+    return std::shared_ptr<CesiumAsync::IAssetRequest>(
+        std::make_shared<CesiumFileAssetRequest>(
+            url,
+            headers,
+            std::make_unique<CesiumFileAssetResponse>(
+                statusCode,
+                MoveTemp(data))));
+  });
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumFileAssetAccessor::post(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& /*url*/,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& /*headers*/,
+    const gsl::span<const std::byte>& /*contentPayload*/) {
+  return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
+      [](const auto& promise) {
+        promise.reject(
+            std::runtime_error("Posting to a file is not supported."));
+      });
+}
+
+void CesiumFileAssetAccessor::tick() noexcept {}
@@ -0,0 +1,902 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumFlatFileCache.h"
+#include "Async/MappedFileHandle.h"
+#include "CesiumAsync/CacheItem.h"
+#include "CesiumRecordSerialization.h"
+#include "CesiumRuntime.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace CesiumRecordSerialization;
+
+namespace {
+constexpr uint32 recordMagic = 0x52464343;    // "CCFR"
+constexpr uint32 tombstoneMagic = 0x54464343; // "CCFT"
+constexpr uint32 indexMagic = 0x49464343;     // "CCFI"
+constexpr uint32 indexVersion = 1;
+
+// The size at which the active segment is sealed and a new one is started.
+constexpr int64 maximumSegmentSize = 256 * 1024 * 1024;
+
+// The share of a sealed segment that must still be used by responses in the
+// index, below which its responses are copied to the active segment when the
+// cache is pruned.
+constexpr double compactionThreshold = 0.5;
+
+// Segment ids start at one, so that zero means no segment.
+constexpr uint32 noSegment = 0;
+
+struct RecordHeader {
+  uint32 magic;
+  uint32 keySize;
+  uint32 metadataSize;
+  uint32 dataSize;
+  int64 expiryTime;
+};
+
+struct IndexFileHeader {
+  uint32 magic;
+  uint32 version;
+  int64 segmentSize;
+  uint64 entryCount;
+};
+
+struct IndexFileEntry {
+  uint64 keyHash;
+  uint64 offset;
+  uint32 size;
+  uint32 reserved;
+  int64 expiryTime;
+  int64 lastAccessTime;
+};
+
+uint64 hashKey(const char* pKey, size_t size) {
+  return CityHash64(pKey, static_cast<uint32>(size));
+}
+
+/**
+ * A tombstone is a record without metadata or body, whose key is the hash of
+ * the key of the response it removes.
+ */
+void appendTombstone(TArray<uint8>& buffer, uint64 keyHash) {
+  RecordHeader header;
+  header.magic = tombstoneMagic;
+  header.keySize = sizeof(keyHash);
+  header.metadataSize = 0;
+  header.dataSize = 0;
+  header.expiryTime = 0;
+  appendBytes(buffer, &header, sizeof(header));
+  appendBytes(buffer, &keyHash, sizeof(keyHash));
+}
+} // namespace
+
+struct CesiumFlatFileCache::Segment {
+  uint32 id = noSegment;
+  FString path;
+
+  // Grows while records are appended to the active segment, which lookups
+  // may read at the same time.
+  std::atomic<int64> size{0};
+
+  // The responses of the segment that are in the index, and their size.
+  uint64 liveItems = 0;
+  int64 liveBytes = 0;
+
+  // Whether the saved index of the segment is out of date. Access times alone
+  // are only saved along with other changes.
+  bool indexChanged = false;
+
+  TUniquePtr<IMappedFileHandle> pMappedFile;
+  TUniquePtr<IMappedFileRegion> pMappedRegion;
+
+  // Guards the file handles below, which lookups share with the writer.
+  std::mutex fileMutex;
+
+  // Only the active segment is open for writing.
+  TUniquePtr<IFileHandle> pWriter;
+  bool unflushed = false;
+
+  // Reads segments that are not mapped, because they are still active or the
+  // platform cannot map files.
+  TUniquePtr<IFileHandle> pReader;
+};
+
+CesiumFlatFileCache::IndexEntry::IndexEntry(
+    uint32 segment_,
+    uint32 size_,
+    uint64 offset_,
+    std::time_t expiryTime_,
+    std::time_t lastAccessTime_)
+    : segment(segment_),
+      size(size_),
+      offset(offset_),
+      expiryTime(expiryTime_),
+      lastAccessTime(lastAccessTime_) {}
+
+CesiumFlatFileCache::IndexEntry::IndexEntry(const IndexEntry& rhs)
+    : segment(rhs.segment),
+      size(rhs.size),
+      offset(rhs.offset),
+      expiryTime(rhs.expiryTime),
+      lastAccessTime(rhs.lastAccessTime.load(std::memory_order_relaxed)) {}
+
+CesiumFlatFileCache::IndexEntry&
+CesiumFlatFileCache::IndexEntry::operator=(const IndexEntry& rhs) {
+  this->segment = rhs.segment;
+  this->size = rhs.size;
+  this->offset = rhs.offset;
+  this->expiryTime = rhs.expiryTime;
+  this->lastAccessTime.store(
+      rhs.lastAccessTime.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  return *this;
+}
+
+CesiumFlatFileCache::CesiumFlatFileCache(
+    const std::string& directory,
+    uint64 maximumItems,
+    int64 maximumBytes)
+    : _directory(UTF8_TO_TCHAR(directory.c_str())),
+      _maximumItems(maximumItems),
+      _maximumBytes(maximumBytes),
+      _writeMutex(),
+      _mutex(),
+      _segments(),
+      _index(),
+      _activeSegment(noSegment),
+      _nextSegment(noSegment + 1) {
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  platformFile.CreateDirectoryTree(*this->_directory);
+
+  TArray<FString> paths;
+  platformFile.FindFiles(paths, *this->_directory, TEXT(".segment"));
+
+  // Later segments hold the newer responses, which replace the older ones in
+  // the index.
+  std::vector<std::pair<uint32, FString>> segments;
+  for (FString& path : paths) {
+    int64 id = FCString::Atoi64(*FPaths::GetBaseFilename(path));
+    if (id > noSegment && id <= MAX_uint32) {
+      segments.emplace_back(static_cast<uint32>(id), MoveTemp(path));
+    }
+  }
+  std::sort(
+      segments.begin(),
+      segments.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  for (const auto& pair : segments) {
+    this->openSegment(pair.first, pair.second);
+    this->_nextSegment = FMath::Max(this->_nextSegment, pair.first + 1);
+  }
+
+  UE_LOG(
+      LogCesium,
+      Verbose,
+      TEXT("Opened request cache in %s with %d responses in %d segments"),
+      *this->_directory,
+      static_cast<int32>(this->_index.size()),
+      static_cast<int32>(this->_segments.size()));
+}
+
+CesiumFlatFileCache::~CesiumFlatFileCache() {
+  std::lock_guard<std::mutex> lock(this->_writeMutex);
+  this->sealActiveSegment();
+  this->saveIndexes();
+}
+
+std::optional<CesiumAsync::CacheItem>
+CesiumFlatFileCache::getEntry(const std::string& key) const {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+
+  auto it = this->_index.find(hashKey(key.data(), key.size()));
+  if (it == this->_index.end()) {
+    return std::nullopt;
+  }
+
+  const IndexEntry& entry = it->second;
+  TArray<uint8> buffer;
+  const uint8* pRecord = this->readSegment(
+      *this->_segments.at(entry.segment),
+      entry.offset,
+      entry.size,
+      buffer);
+  if (!pRecord) {
+    return std::nullopt;
+  }
+
+  Reader record(pRecord, entry.size);
+  RecordHeader header;
+  if (!record.read(&header, sizeof(header)) || header.magic != recordMagic) {
+    return std::nullopt;
+  }
+
+  // Different keys may have the same hash.
+  const uint8* pKey = record.take(header.keySize);
+  if (!pKey || header.keySize != key.size() ||
+      std::memcmp(pKey, key.data(), key.size()) != 0) {
+    return std::nullopt;
+  }
+
+  const uint8* pMetadata = record.take(header.metadataSize);
+  const uint8* pData = record.take(header.dataSize);
+  if (!pMetadata || !pData) {
+    return std::nullopt;
+  }
+
+  std::string url;
+  std::string requestMethod;
+  CesiumAsync::HttpHeaders requestHeaders;
+  uint16_t statusCode;
+  CesiumAsync::HttpHeaders responseHeaders;
+  Reader metadata(pMetadata, header.metadataSize);
+  if (!metadata.readString(url) || !metadata.readString(requestMethod) ||
+      !metadata.readHeaders(requestHeaders) ||
+      !metadata.read(&statusCode, sizeof(statusCode)) ||
+      !metadata.readHeaders(responseHeaders)) {
+    return std::nullopt;
+  }
+
+  entry.lastAccessTime.store(std::time(nullptr), std::memory_order_relaxed);
+
+  const std::byte* pBody = reinterpret_cast<const std::byte*>(pData);
+  return CesiumAsync::CacheItem(
+      static_cast<std::time_t>(header.expiryTime),
+      CesiumAsync::CacheRequest(
+          std::move(requestHeaders),
+          std::move(requestMethod),
+          std::move(url)),
+      CesiumAsync::CacheResponse(
+          statusCode,
+          std::move(responseHeaders),
+          std::vector<std::byte>(pBody, pBody + header.dataSize)));
+}
+
+bool CesiumFlatFileCache::storeEntry(
+    const std::string& key,
+    std::time_t expiryTime,
+    const std::string& url,
+    const std::string& requestMethod,
+    const CesiumAsync::HttpHeaders& requestHeaders,
+    uint16_t statusCode,
+    const CesiumAsync::HttpHeaders& responseHeaders,
+    const gsl::span<const std::byte>& responseData) {
+  TArray<uint8> metadata;
+  appendString(metadata, url);
+  appendString(metadata, requestMethod);
+  appendHeaders(metadata, requestHeaders);
+  appendBytes(metadata, &statusCode, sizeof(statusCode));
+  appendHeaders(metadata, responseHeaders);
+
+  int64 recordSize = static_cast<int64>(sizeof(RecordHeader)) +
+                     static_cast<int64>(key.size()) + metadata.Num() +
+                     static_cast<int64>(responseData.size());
+  if (recordSize > MAX_int32) {
+    return false;
+  }
+
+  RecordHeader header;
+  header.magic = recordMagic;
+  header.keySize = static_cast<uint32>(key.size());
+  header.metadataSize = static_cast<uint32>(metadata.Num());
+  header.dataSize = static_cast<uint32>(responseData.size());
+  header.expiryTime = static_cast<int64>(expiryTime);
+
+  TArray<uint8> prefix;
+  prefix.Reserve(
+      static_cast<int32>(recordSize - static_cast<int64>(responseData.size())));
+  appendBytes(prefix, &header, sizeof(header));
+  appendBytes(prefix, key.data(), key.size());
+  prefix.Append(metadata);
+
+  std::lock_guard<std::mutex> lock(this->_writeMutex);
+  return this->appendRecord(
+      hashKey(key.data(), key.size()),
+      expiryTime,
+      std::time(nullptr),
+      prefix.GetData(),
+      prefix.Num(),
+      reinterpret_cast<const uint8*>(responseData.data()),
+      static_cast<int64>(responseData.size()));
+}
+
+bool CesiumFlatFileCache::prune() {
+  std::lock_guard<std::mutex> writeLock(this->_writeMutex);
+
+  // The index only changes with _writeMutex held, so the responses to remove
+  // are chosen without blocking lookups.
+  uint64 itemCount = this->_index.size();
+  int64 liveBytes = 0;
+  for (const auto& pair : this->_segments) {
+    liveBytes += pair.second->liveBytes;
+  }
+
+  std::time_t now = std::time(nullptr);
+  std::vector<uint64> removed;
+  std::vector<std::pair<std::time_t, uint64>> accessTimes;
+  accessTimes.reserve(this->_index.size());
+  for (const auto& pair : this->_index) {
+    if (pair.second.expiryTime < now) {
+      removed.push_back(pair.first);
+      --itemCount;
+      liveBytes -= pair.second.size;
+    } else {
+      accessTimes.emplace_back(
+          pair.second.lastAccessTime.load(std::memory_order_relaxed),
+          pair.first);
+    }
+  }
+
+  auto isFull = [this, &itemCount, &liveBytes]() {
+    return itemCount > this->_maximumItems ||
+           (this->_maximumBytes > 0 && liveBytes > this->_maximumBytes);
+  };
+
+  if (isFull()) {
+    std::sort(accessTimes.begin(), accessTimes.end());
+    for (size_t i = 0; i < accessTimes.size() && isFull(); ++i) {
+      removed.push_back(accessTimes[i].second);
+      --itemCount;
+      liveBytes -= this->_index.at(accessTimes[i].second).size;
+    }
+  }
+
+  this->removeEntries(removed);
+  this->compactSegments();
+  this->saveIndexes();
+  return true;
+}
+
+bool CesiumFlatFileCache::clearAll() {
+  std::lock_guard<std::mutex> writeLock(this->_writeMutex);
+
+  std::vector<uint32> ids;
+  {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    this->_index.clear();
+    for (const auto& pair : this->_segments) {
+      ids.push_back(pair.first);
+    }
+  }
+
+  this->_activeSegment = noSegment;
+  this->deleteSegments(ids);
+  return true;
+}
+
+int64 CesiumFlatFileCache::getSize() const {
+  std::shared_lock<std::shared_mutex> lock(this->_mutex);
+
+  int64 size = 0;
+  for (const auto& pair : this->_segments) {
+    size += pair.second->size;
+  }
+  return size;
+}
+
+FString CesiumFlatFileCache::getSegmentPath(uint32 id) const {
+  return FPaths::Combine(
+      this->_directory,
+      FString::Printf(TEXT("%08u.segment"), id));
+}
+
+FString CesiumFlatFileCache::getIndexPath(uint32 id) const {
+  return FPaths::Combine(
+      this->_directory,
+      FString::Printf(TEXT("%08u.index"), id));
+}
+
+void CesiumFlatFileCache::openSegment(uint32 id, const FString& path) {
+  std::unique_ptr<Segment> pSegment = std::make_unique<Segment>();
+  pSegment->id = id;
+  pSegment->path = path;
+  pSegment->size = FPlatformFileManager::Get().GetPlatformFile().FileSize(
+      *pSegment->path);
+  if (pSegment->size < 0) {
+    return;
+  }
+
+  Segment& segment = *pSegment;
+  this->_segments.emplace(id, std::move(pSegment));
+  this->mapSegment(segment);
+
+  if (!this->loadIndex(segment)) {
+    UE_LOG(
+        LogCesium,
+        Verbose,
+        TEXT("Rebuilding the request cache index of %s"),
+        *segment.path);
+    this->scanSegment(segment);
+    segment.indexChanged = true;
+  }
+}
+
+void CesiumFlatFileCache::mapSegment(Segment& segment) const {
+  if (segment.size <= 0) {
+    return;
+  }
+
+  segment.pMappedFile.Reset(
+      FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*segment.path));
+  if (segment.pMappedFile) {
+    segment.pMappedRegion.Reset(
+        segment.pMappedFile->MapRegion(0, segment.size));
+  }
+  if (!segment.pMappedRegion) {
+    segment.pMappedFile.Reset();
+  }
+}
+
+bool CesiumFlatFileCache::loadIndex(Segment& segment) {
+  TArray<uint8> data;
+  if (!FFileHelper::LoadFileToArray(
+          data,
+          *this->getIndexPath(segment.id),
+          FILEREAD_Silent)) {
+    return false;
+  }
+
+  Reader reader(data.GetData(), data.Num());
+  IndexFileHeader header;
+  if (!reader.read(&header, sizeof(header)) || header.magic != indexMagic ||
+      header.version != indexVersion || header.segmentSize != segment.size ||
+      header.entryCount * sizeof(IndexFileEntry) !=
+          data.Num() - sizeof(IndexFileHeader)) {
+    return false;
+  }
+
+  std::vector<IndexFileEntry> entries(header.entryCount);
+  for (IndexFileEntry& entry : entries) {
+    if (!reader.read(&entry, sizeof(entry)) ||
+        entry.offset + entry.size > static_cast<uint64>(segment.size)) {
+      return false;
+    }
+  }
+
+  for (const IndexFileEntry& entry : entries) {
+    this->addEntry(
+        entry.keyHash,
+        IndexEntry{
+            segment.id,
+            entry.size,
+            entry.offset,
+            static_cast<std::time_t>(entry.expiryTime),
+            static_cast<std::time_t>(entry.lastAccessTime)});
+  }
+  segment.indexChanged = false;
+  return true;
+}
+
+void CesiumFlatFileCache::scanSegment(Segment& segment) {
+  std::time_t now = std::time(nullptr);
+  TArray<uint8> buffer;
+
+  int64 offset = 0;
+  while (offset + static_cast<int64>(sizeof(RecordHeader)) <= segment.size) {
+    const uint8* pHeader =
+        this->readSegment(segment, offset, sizeof(RecordHeader), buffer);
+    if (!pHeader) {
+      break;
+    }
+
+    RecordHeader header;
+    std::memcpy(&header, pHeader, sizeof(header));
+    int64 recordSize = static_cast<int64>(sizeof(RecordHeader)) +
+                       header.keySize + header.metadataSize + header.dataSize;
+
+    // The end of a segment that was being written when the application
+    // stopped may hold an incomplete record.
+    if ((header.magic != recordMagic && header.magic != tombstoneMagic) ||
+        offset + recordSize > segment.size || recordSize > MAX_int32) {
+      break;
+    }
+
+    const uint8* pKey = this->readSegment(
+        segment,
+        offset + sizeof(RecordHeader),
+        header.keySize,
+        buffer);
+    if (!pKey) {
+      break;
+    }
+
+    // A tombstone removes the response from an earlier record.
+    if (header.magic == tombstoneMagic) {
+      uint64 keyHash;
+      if (header.keySize != sizeof(keyHash)) {
+        break;
+      }
+      std::memcpy(&keyHash, pKey, sizeof(keyHash));
+
+      auto it = this->_index.find(keyHash);
+      if (it != this->_index.end()) {
+        this->removeFromSegment(it->second);
+        this->_index.erase(it);
+      }
+      offset += recordSize;
+      continue;
+    }
+
+    this->addEntry(
+        hashKey(reinterpret_cast<const char*>(pKey), header.keySize),
+        IndexEntry{
+            segment.id,
+            static_cast<uint32>(recordSize),
+            static_cast<uint64>(offset),
+            static_cast<std::time_t>(header.expiryTime),
+            now});
+    offset += recordSize;
+  }
+}
+
+void CesiumFlatFileCache::saveIndexes() {
+  std::map<uint32, TArray<uint8>> indexes;
+  for (const auto& pair : this->_segments) {
+    const Segment& segment = *pair.second;
+    if (segment.indexChanged && segment.id != this->_activeSegment) {
+      indexes.emplace(segment.id, TArray<uint8>());
+    }
+  }
+
+  if (indexes.empty()) {
+    return;
+  }
+
+  for (const auto& pair : this->_index) {
+    auto it = indexes.find(pair.second.segment);
+    if (it == indexes.end()) {
+      continue;
+    }
+
+    IndexFileEntry entry;
+    entry.keyHash = pair.first;
+    entry.offset = pair.second.offset;
+    entry.size = pair.second.size;
+    entry.reserved = 0;
+    entry.expiryTime = static_cast<int64>(pair.second.expiryTime);
+    entry.lastAccessTime = static_cast<int64>(
+        pair.second.lastAccessTime.load(std::memory_order_relaxed));
+    appendBytes(it->second, &entry, sizeof(entry));
+  }
+
+  for (const auto& pair : indexes) {
+    Segment& segment = *this->_segments.at(pair.first);
+
+    IndexFileHeader header;
+    header.magic = indexMagic;
+    header.version = indexVersion;
+    header.segmentSize = segment.size;
+    header.entryCount = pair.second.Num() / sizeof(IndexFileEntry);
+
+    TArray<uint8> data;
+    data.Reserve(sizeof(header) + pair.second.Num());
+    appendBytes(data, &header, sizeof(header));
+    data.Append(pair.second);
+
+    if (FFileHelper::SaveArrayToFile(data, *this->getIndexPath(segment.id))) {
+      segment.indexChanged = false;
+    }
+  }
+}
+
+CesiumFlatFileCache::Segment*
+CesiumFlatFileCache::getActiveSegment(int64 recordSize) {
+  if (this->_activeSegment != noSegment) {
+    Segment& segment = *this->_segments.at(this->_activeSegment);
+    if (segment.size == 0 || segment.size + recordSize <= maximumSegmentSize) {
+      return &segment;
+    }
+    this->sealActiveSegment();
+  }
+
+  std::unique_ptr<Segment> pSegment = std::make_unique<Segment>();
+  pSegment->id = this->_nextSegment;
+  pSegment->path = this->getSegmentPath(pSegment->id);
+  pSegment->pWriter.Reset(
+      FPlatformFileManager::Get().GetPlatformFile().OpenWrite(
+          *pSegment->path,
+          false,
+          true));
+  if (!pSegment->pWriter) {
+    UE_LOG(
+        LogCesium,
+        Warning,
+        TEXT("Could not create request cache segment %s"),
+        *pSegment->path);
+    return nullptr;
+  }
+
+  ++this->_nextSegment;
+  this->_activeSegment = pSegment->id;
+  Segment* pResult = pSegment.get();
+  {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    this->_segments.emplace(pSegment->id, std::move(pSegment));
+  }
+  return pResult;
+}
+
+void CesiumFlatFileCache::sealActiveSegment() {
+  if (this->_activeSegment == noSegment) {
+    return;
+  }
+
+  Segment& segment = *this->_segments.at(this->_activeSegment);
+  this->_activeSegment = noSegment;
+
+  {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    segment.pWriter.Reset();
+    segment.pReader.Reset();
+    segment.unflushed = false;
+    this->mapSegment(segment);
+  }
+
+  segment.indexChanged = true;
+  this->saveIndexes();
+}
+
+const uint8* CesiumFlatFileCache::readSegment(
+    Segment& segment,
+    uint64 offset,
+    int64 size,
+    TArray<uint8>& buffer) const {
+  if (static_cast<int64>(offset) + size > segment.size) {
+    return nullptr;
+  }
+
+  if (segment.pMappedRegion) {
+    return segment.pMappedRegion->GetMappedPtr() + offset;
+  }
+
+  std::lock_guard<std::mutex> lock(segment.fileMutex);
+  if (segment.unflushed) {
+    segment.pWriter->Flush();
+    segment.unflushed = false;
+  }
+
+  if (!segment.pReader) {
+    segment.pReader.Reset(
+        FPlatformFileManager::Get().GetPlatformFile().OpenRead(
+            *segment.path,
+            true));
+    if (!segment.pReader) {
+      return nullptr;
+    }
+  }
+
+  buffer.SetNumUninitialized(static_cast<int32>(size));
+  if (!segment.pReader->Seek(static_cast<int64>(offset)) ||
+      !segment.pReader->Read(buffer.GetData(), size)) {
+    return nullptr;
+  }
+  return buffer.GetData();
+}
+
+CesiumFlatFileCache::Segment* CesiumFlatFileCache::writeToActiveSegment(
+    const uint8* pPrefix,
+    int64 prefixSize,
+    const uint8* pData,
+    int64 dataSize,
+    uint64& offset) {
+  int64 recordSize = prefixSize + dataSize;
+  Segment* pSegment = this->getActiveSegment(recordSize);
+  if (!pSegment) {
+    return nullptr;
+  }
+
+  bool written;
+  {
+    std::lock_guard<std::mutex> lock(pSegment->fileMutex);
+    written = pSegment->pWriter->Write(pPrefix, prefixSize) &&
+              (dataSize == 0 || pSegment->pWriter->Write(pData, dataSize));
+    if (written) {
+      offset = static_cast<uint64>(pSegment->size.load());
+      pSegment->size += recordSize;
+      pSegment->unflushed = true;
+    }
+  }
+
+  if (!written) {
+    // Records appended after a partly written one could not be found by
+    // scanning the segment, so the segment is sealed at the last complete
+    // record.
+    this->sealActiveSegment();
+    return nullptr;
+  }
+  return pSegment;
+}
+
+bool CesiumFlatFileCache::appendRecord(
+    uint64 keyHash,
+    std::time_t expiryTime,
+    std::time_t lastAccessTime,
+    const uint8* pPrefix,
+    int64 prefixSize,
+    const uint8* pData,
+    int64 dataSize) {
+  uint64 offset;
+  Segment* pSegment =
+      this->writeToActiveSegment(pPrefix, prefixSize, pData, dataSize, offset);
+  if (!pSegment) {
+    return false;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(this->_mutex);
+  this->addEntry(
+      keyHash,
+      IndexEntry{
+          pSegment->id,
+          static_cast<uint32>(prefixSize + dataSize),
+          offset,
+          expiryTime,
+          lastAccessTime});
+  return true;
+}
+
+void CesiumFlatFileCache::removeEntries(const std::vector<uint64>& keyHashes) {
+  if (keyHashes.empty()) {
+    return;
+  }
+
+  TArray<uint8> tombstones;
+  {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    for (uint64 keyHash : keyHashes) {
+      auto it = this->_index.find(keyHash);
+      if (it == this->_index.end()) {
+        continue;
+      }
+
+      // Sealed segments save their index without the response instead.
+      if (it->second.segment == this->_activeSegment) {
+        appendTombstone(tombstones, keyHash);
+      }
+      this->removeFromSegment(it->second);
+      this->_index.erase(it);
+    }
+  }
+
+  if (tombstones.Num() > 0) {
+    uint64 offset;
+    this->writeToActiveSegment(
+        tombstones.GetData(),
+        tombstones.Num(),
+        nullptr,
+        0,
+        offset);
+  }
+}
+
+void CesiumFlatFileCache::addEntry(uint64 keyHash, const IndexEntry& entry) {
+  auto result = this->_index.emplace(keyHash, entry);
+  if (!result.second) {
+    this->removeFromSegment(result.first->second);
+    result.first->second = entry;
+  }
+
+  Segment& segment = *this->_segments.at(entry.segment);
+  ++segment.liveItems;
+  segment.liveBytes += entry.size;
+  segment.indexChanged = true;
+}
+
+void CesiumFlatFileCache::removeFromSegment(const IndexEntry& entry) {
+  auto it = this->_segments.find(entry.segment);
+  if (it == this->_segments.end()) {
+    return;
+  }
+
+  Segment& segment = *it->second;
+  --segment.liveItems;
+  segment.liveBytes -= entry.size;
+  segment.indexChanged = true;
+}
+
+void CesiumFlatFileCache::compactSegments() {
+  std::map<uint32, std::vector<uint64>> compacted;
+  std::vector<uint32> unused;
+  for (const auto& pair : this->_segments) {
+    const Segment& segment = *pair.second;
+    if (segment.id == this->_activeSegment) {
+      continue;
+    }
+
+    if (segment.liveItems == 0) {
+      unused.push_back(segment.id);
+    } else if (
+        static_cast<double>(segment.liveBytes) <
+        static_cast<double>(segment.size) * compactionThreshold) {
+      compacted.emplace(segment.id, std::vector<uint64>());
+    }
+  }
+
+  if (!compacted.empty()) {
+    for (const auto& pair : this->_index) {
+      auto it = compacted.find(pair.second.segment);
+      if (it != compacted.end()) {
+        it->second.push_back(pair.first);
+      }
+    }
+  }
+
+  // The records are copied without the lock, and then replace the original
+  // ones in the index at once.
+  TArray<uint8> buffer;
+  for (const auto& pair : compacted) {
+    Segment& segment = *this->_segments.at(pair.first);
+
+    std::vector<std::pair<uint64, IndexEntry>> moved;
+    moved.reserve(pair.second.size());
+    for (uint64 keyHash : pair.second) {
+      const IndexEntry& entry = this->_index.at(keyHash);
+      const uint8* pRecord =
+          this->readSegment(segment, entry.offset, entry.size, buffer);
+      uint64 offset;
+      Segment* pActiveSegment =
+          pRecord ? this->writeToActiveSegment(
+                        pRecord,
+                        entry.size,
+                        nullptr,
+                        0,
+                        offset)
+                  : nullptr;
+      if (!pActiveSegment) {
+        break;
+      }
+
+      moved.emplace_back(
+          keyHash,
+          IndexEntry{
+              pActiveSegment->id,
+              entry.size,
+              offset,
+              entry.expiryTime,
+              entry.lastAccessTime.load(std::memory_order_relaxed)});
+    }
+
+    {
+      std::unique_lock<std::shared_mutex> lock(this->_mutex);
+      for (const auto& movedEntry : moved) {
+        this->addEntry(movedEntry.first, movedEntry.second);
+      }
+    }
+
+    if (segment.liveItems == 0) {
+      unused.push_back(segment.id);
+    }
+  }
+
+  this->deleteSegments(unused);
+}
+
+void CesiumFlatFileCache::deleteSegments(const std::vector<uint32>& ids) {
+  std::vector<std::unique_ptr<Segment>> deleted;
+  {
+    std::unique_lock<std::shared_mutex> lock(this->_mutex);
+    for (uint32 id : ids) {
+      auto it = this->_segments.find(id);
+      if (it != this->_segments.end()) {
+        deleted.push_back(std::move(it->second));
+        this->_segments.erase(it);
+      }
+    }
+  }
+
+  // The file handles must be closed before the files can be deleted.
+  IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+  for (std::unique_ptr<Segment>& pSegment : deleted) {
+    FString path = pSegment->path;
+    uint32 id = pSegment->id;
+    pSegment.reset();
+
+    platformFile.DeleteFile(*path);
+    platformFile.DeleteFile(*this->getIndexPath(id));
+  }
+}
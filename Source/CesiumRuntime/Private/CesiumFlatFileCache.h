@@ -0,0 +1,182 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumCacheShard.h"
+#include "CoreMinimal.h"
+#include <atomic>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A request cache that appends responses to large segment files, as an
+ * alternative to SQLite for big caches that are mostly read, such as caches
+ * that were filled in advance.
+ *
+ * Each response is stored as one record with its key, request and response
+ * headers, and body. Records are appended to the active segment until it
+ * reaches 256 MiB, after which it is sealed and never written again. Sealed
+ * segments are memory mapped, so that a cache hit reads the record from the
+ * mapping rather than with a file read. The body is still copied into the
+ * returned cache item.
+ *
+ * The records are found with an index in memory, which maps a 64-bit hash of
+ * each key to the location of its latest record. The index of each sealed
+ * segment is saved next to it, so that the segments do not need to be
+ * scanned when the cache is opened again. The active segment has no saved
+ * index, so removing one of its responses appends a tombstone record, which
+ * removes the response again if the segment is scanned after a crash.
+ *
+ * Pruning removes the expired responses first, and then the least recently
+ * used ones until the cache is within its number of responses and size.
+ * Segments without responses left are deleted, and the responses left in
+ * segments that are mostly unused are copied to the active segment so that
+ * those segments can be deleted too.
+ *
+ * Lookups only share a lock, and record their access time atomically, so that
+ * they run in parallel with each other. Storing, pruning and compacting
+ * segments write the files without the lock, and only take it exclusively to
+ * update the index.
+ */
+class CesiumFlatFileCache : public CesiumCacheShard {
+public:
+  /**
+   * @brief Opens the cache in a directory, creating the directory if needed.
+   *
+   * @param directory The directory of the segment files.
+   * @param maximumItems The maximum number of responses kept when the cache is
+   * pruned.
+   * @param maximumBytes The maximum size of the responses kept when the cache
+   * is pruned, or zero for no limit. The segment files may be larger by the
+   * space of removed responses that was not reclaimed yet.
+   */
+  CesiumFlatFileCache(
+      const std::string& directory,
+      uint64 maximumItems,
+      int64 maximumBytes);
+
+  virtual ~CesiumFlatFileCache();
+
+  virtual std::optional<CesiumAsync::CacheItem>
+  getEntry(const std::string& key) const override;
+
+  virtual bool storeEntry(
+      const std::string& key,
+      std::time_t expiryTime,
+      const std::string& url,
+      const std::string& requestMethod,
+      const CesiumAsync::HttpHeaders& requestHeaders,
+      uint16_t statusCode,
+      const CesiumAsync::HttpHeaders& responseHeaders,
+      const gsl::span<const std::byte>& responseData) override;
+
+  virtual bool prune() override;
+
+  virtual bool clearAll() override;
+
+  /**
+   * @brief Gets the size of the segment files, including the space of removed
+   * responses that was not reclaimed yet.
+   */
+  virtual int64 getSize() const override;
+
+private:
+  struct Segment;
+
+  struct IndexEntry {
+    IndexEntry(
+        uint32 segment_,
+        uint32 size_,
+        uint64 offset_,
+        std::time_t expiryTime_,
+        std::time_t lastAccessTime_);
+    IndexEntry(const IndexEntry& rhs);
+    IndexEntry& operator=(const IndexEntry& rhs);
+
+    uint32 segment;
+    uint32 size;
+    uint64 offset;
+    std::time_t expiryTime;
+
+    // Updated by lookups, which only share the lock.
+    mutable std::atomic<std::time_t> lastAccessTime;
+  };
+
+  FString getSegmentPath(uint32 id) const;
+  FString getIndexPath(uint32 id) const;
+
+  void openSegment(uint32 id, const FString& path);
+  void mapSegment(Segment& segment) const;
+  bool loadIndex(Segment& segment);
+  void scanSegment(Segment& segment);
+  void saveIndexes();
+
+  // Gets the segment that a record of the given size is appended to, sealing
+  // the active segment and starting a new one if the record does not fit.
+  Segment* getActiveSegment(int64 recordSize);
+  void sealActiveSegment();
+
+  // Reads bytes of a segment, from its mapping if it is mapped, or else into
+  // the buffer. Returns nullptr if they cannot be read. Requires a lock on
+  // _mutex or _writeMutex.
+  const uint8* readSegment(
+      Segment& segment,
+      uint64 offset,
+      int64 size,
+      TArray<uint8>& buffer) const;
+
+  // Appends bytes to the active segment without adding them to the index.
+  // Returns the segment and sets the offset they were written at, or returns
+  // nullptr if they could not be written.
+  Segment* writeToActiveSegment(
+      const uint8* pPrefix,
+      int64 prefixSize,
+      const uint8* pData,
+      int64 dataSize,
+      uint64& offset);
+
+  bool appendRecord(
+      uint64 keyHash,
+      std::time_t expiryTime,
+      std::time_t lastAccessTime,
+      const uint8* pPrefix,
+      int64 prefixSize,
+      const uint8* pData,
+      int64 dataSize);
+
+  // Removes responses from the index, and appends tombstones for the ones in
+  // the active segment.
+  void removeEntries(const std::vector<uint64>& keyHashes);
+
+  // Requires an exclusive lock on _mutex.
+  void addEntry(uint64 keyHash, const IndexEntry& entry);
+  void removeFromSegment(const IndexEntry& entry);
+
+  void compactSegments();
+  void deleteSegments(const std::vector<uint32>& ids);
+
+  FString _directory;
+  uint64 _maximumItems;
+  int64 _maximumBytes;
+
+  // Held by everything that changes the cache, so that it may read the index
+  // and segments without _mutex, and write files without blocking lookups.
+  std::mutex _writeMutex;
+
+  // Guards the index, the segments, and the file handles and mappings of the
+  // segments. Changes also require _writeMutex.
+  mutable std::shared_mutex _mutex;
+  std::map<uint32, std::unique_ptr<Segment>> _segments;
+  std::unordered_map<uint64, IndexEntry> _index;
+
+  // Only used with _writeMutex held.
+  uint32 _activeSegment;
+  uint32 _nextSegment;
+};
@@ -13,6 +13,7 @@
 #include "CesiumGltf/TextureInfo.h"
 #include "CesiumGltfPrimitiveComponent.h"
 #include "CesiumMaterialUserData.h"
+#include "CesiumMeshBuildTimer.h"
 #include "CesiumRasterOverlays.h"
 #include "CesiumRuntime.h"
 #include "CesiumTextureUtility.h"
@@ -34,11 +35,13 @@
 #include "StaticMeshResources.h"
 #include "UObject/ConstructorHelpers.h"
 #include "mikktspace.h"
+#include <algorithm>
 #include <cstddef>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/mat3x3.hpp>
 #include <iostream>
+#include <unordered_set>
 
 #if PHYSICS_INTERFACE_PHYSX
 #include "IPhysXCooking.h"
@@ -63,12 +66,28 @@ struct LoadModelResult {
   const CesiumGltf::MeshPrimitive* pMeshPrimitive = nullptr;
   const CesiumGltf::Material* pMaterial = nullptr;
   glm::dmat4x4 transform{1.0};
+  // If this primitive's mesh is referenced by several nodes, the transforms
+  // of all of them. The primitive is then drawn once for each, and
+  // `transform` is not used.
+  std::vector<glm::dmat4x4> instanceTransforms{};
+  // The vertices and indices of this primitive, kept until its render data is
+  // created by loadPrimitiveRenderData. The indices are already in Unreal's
+  // winding order.
+  TArray<FStaticMeshBuildVertex> vertices{};
+  TArray<uint32> indices{};
+  FBox boundingBox{ForceInit};
+  uint32_t textureCoordinateCount = 0;
+  bool hasVertexColors = false;
+  bool duplicateVertices = false;
 #if PHYSICS_INTERFACE_PHYSX
   PxTriangleMesh* pCollisionMesh = nullptr;
 #else
   TSharedPtr<Chaos::FTriangleMeshImplicitObject, ESPMode::ThreadSafe>
       pCollisionMesh = nullptr;
 #endif
+  // The estimated size of the collision mesh, from the vertices and indices it
+  // was cooked from.
+  int64 collisionMeshBytes = 0;
   std::string name{};
 
   CesiumTextureUtility::LoadedTextureResult* baseColorTexture = nullptr;
@@ -538,6 +557,8 @@ static void loadPrimitive(
     const TIndexAccessor& indicesView) {
 
   CESIUM_TRACE("loadPrimitive<T>");
+  CesiumMeshBuildTimer::Scope primitiveStage(
+      CesiumMeshBuildTimer::Stage::LoadPrimitive);
 
   if (primitive.mode != CesiumGltf::MeshPrimitive::Mode::TRIANGLES &&
       primitive.mode != CesiumGltf::MeshPrimitive::Mode::TRIANGLE_STRIP) {
@@ -667,11 +688,6 @@ static void loadPrimitive(
     needsTangents = true;
   }
 
-  FStaticMeshRenderData* RenderData = new FStaticMeshRenderData();
-  RenderData->AllocateLODResources(1);
-
-  FStaticMeshLODResources& LODResources = RenderData->LODResources[0];
-
   {
     CESIUM_TRACE("compute AA bounding box");
 
@@ -694,19 +710,15 @@ static void loadPrimitive(
       maxPosition = glm::dvec3(max[0], max[1], max[2]);
     }
 
-    FBox aaBox(
+    primitiveResult.boundingBox = FBox(
         FVector(minPosition.x, minPosition.y, minPosition.z),
         FVector(maxPosition.x, maxPosition.y, maxPosition.z));
-
-    aaBox.GetCenterAndExtents(
-        RenderData->Bounds.Origin,
-        RenderData->Bounds.BoxExtent);
-    RenderData->Bounds.SphereRadius = 0.0f;
   }
 
   TArray<uint32> indices;
   if (primitive.mode == CesiumGltf::MeshPrimitive::Mode::TRIANGLES) {
     CESIUM_TRACE("copy TRIANGLE indices");
+    CesiumMeshBuildTimer::Scope stage(CesiumMeshBuildTimer::Stage::CopyIndices);
     indices.SetNum(static_cast<TArray<uint32>::SizeType>(indicesView.size()));
 
     for (int32 i = 0; i < indicesView.size(); ++i) {
@@ -715,6 +727,7 @@ static void loadPrimitive(
   } else {
     // assume TRIANGLE_STRIP because all others are rejected earlier.
     CESIUM_TRACE("copy TRIANGLE_STRIP indices");
+    CesiumMeshBuildTimer::Scope stage(CesiumMeshBuildTimer::Stage::CopyIndices);
     indices.SetNum(
         static_cast<TArray<uint32>::SizeType>(3 * (indicesView.size() - 2)));
     for (int32 i = 0; i < indicesView.size() - 2; ++i) {
@@ -744,26 +757,24 @@ static void loadPrimitive(
   {
     if (duplicateVertices) {
       CESIUM_TRACE("copy duplicated positions");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyPositions);
       for (int64_t i = 0; i < indices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         uint32 vertexIndex = indices[i];
         vertex.Position = positionView[vertexIndex];
         vertex.UVs[0] = FVector2D(0.0f, 0.0f);
         vertex.UVs[2] = FVector2D(0.0f, 0.0f);
-        RenderData->Bounds.SphereRadius = FMath::Max(
-            (vertex.Position - RenderData->Bounds.Origin).Size(),
-            RenderData->Bounds.SphereRadius);
       }
     } else {
       CESIUM_TRACE("copy positions");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyPositions);
       for (int64_t i = 0; i < StaticMeshBuildVertices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         vertex.Position = positionView[i];
         vertex.UVs[0] = FVector2D(0.0f, 0.0f);
         vertex.UVs[2] = FVector2D(0.0f, 0.0f);
-        RenderData->Bounds.SphereRadius = FMath::Max(
-            (vertex.Position - RenderData->Bounds.Origin).Size(),
-            RenderData->Bounds.SphereRadius);
       }
     }
   }
@@ -773,6 +784,7 @@ static void loadPrimitive(
   auto colorAccessorIt = primitive.attributes.find("COLOR_0");
   if (colorAccessorIt != primitive.attributes.end()) {
     CESIUM_TRACE("copy colors");
+    CesiumMeshBuildTimer::Scope stage(CesiumMeshBuildTimer::Stage::CopyColors);
     int colorAccessorID = colorAccessorIt->second;
     hasVertexColors = CesiumGltf::createAccessorView(
         model,
@@ -780,28 +792,15 @@ static void loadPrimitive(
         ColorVisitor{duplicateVertices, StaticMeshBuildVertices, indices});
   }
 
-  LODResources.bHasColorVertexData = hasVertexColors;
-
   // We need to copy the texture coordinates associated with each texture (if
   // any) into the the appropriate UVs slot in FStaticMeshBuildVertex.
 
   std::unordered_map<uint32_t, uint32_t> textureCoordinateMap;
 
-  {
-    CESIUM_TRACE("loadTextures");
-    primitiveResult.baseColorTexture =
-        loadTexture(model, pbrMetallicRoughness.baseColorTexture);
-    primitiveResult.metallicRoughnessTexture =
-        loadTexture(model, pbrMetallicRoughness.metallicRoughnessTexture);
-    primitiveResult.normalTexture = loadTexture(model, material.normalTexture);
-    primitiveResult.occlusionTexture =
-        loadTexture(model, material.occlusionTexture);
-    primitiveResult.emissiveTexture =
-        loadTexture(model, material.emissiveTexture);
-  }
-
   {
     CESIUM_TRACE("updateTextureCoordinates");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::UpdateTextureCoordinates);
     primitiveResult
         .textureCoordinateParameters["baseColorTextureCoordinateIndex"] =
         updateTextureCoordinates(
@@ -880,6 +879,8 @@ static void loadPrimitive(
   if (hasNormals) {
     if (duplicateVertices) {
       CESIUM_TRACE("copy normals for duplicated vertices");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyNormals);
       for (int64_t i = 0; i < indices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         uint32 vertexIndex = indices[i];
@@ -889,6 +890,8 @@ static void loadPrimitive(
       }
     } else {
       CESIUM_TRACE("copy normals");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyNormals);
       for (int64_t i = 0; i < StaticMeshBuildVertices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         vertex.TangentX = FVector(0.0f, 0.0f, 0.0f);
@@ -898,12 +901,16 @@ static void loadPrimitive(
     }
   } else {
     CESIUM_TRACE("compute flat normals");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::ComputeFlatNormals);
     computeFlatNormals(indices, StaticMeshBuildVertices);
   }
 
   if (hasTangents) {
     if (duplicateVertices) {
       CESIUM_TRACE("copy tangents for duplicated vertices");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyTangents);
       for (int64_t i = 0; i < indices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         uint32 vertexIndex = indices[i];
@@ -914,6 +921,8 @@ static void loadPrimitive(
       }
     } else {
       CESIUM_TRACE("copy tangents");
+      CesiumMeshBuildTimer::Scope stage(
+          CesiumMeshBuildTimer::Stage::CopyTangents);
       for (int64_t i = 0; i < StaticMeshBuildVertices.Num(); ++i) {
         FStaticMeshBuildVertex& vertex = StaticMeshBuildVertices[i];
         const FVector4& tangent = tangentAccessor[i];
@@ -928,39 +937,11 @@ static void loadPrimitive(
     // Use mikktspace to calculate the tangents.
     // Note that this assumes normals and UVs are already populated.
     CESIUM_TRACE("compute tangents");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::ComputeTangentSpace);
     computeTangentSpace(StaticMeshBuildVertices);
   }
 
-  {
-    CESIUM_TRACE("init buffers");
-    LODResources.VertexBuffers.PositionVertexBuffer.Init(
-        StaticMeshBuildVertices,
-        false);
-
-    FColorVertexBuffer& ColorVertexBuffer =
-        LODResources.VertexBuffers.ColorVertexBuffer;
-    if (hasVertexColors) {
-      ColorVertexBuffer.Init(StaticMeshBuildVertices, false);
-    }
-
-    LODResources.VertexBuffers.StaticMeshVertexBuffer.Init(
-        StaticMeshBuildVertices,
-        textureCoordinateMap.size() == 0 ? 1 : textureCoordinateMap.size(),
-        false);
-  }
-
-  FStaticMeshLODResources::FStaticMeshSectionArray& Sections =
-      LODResources.Sections;
-  FStaticMeshSection& section = Sections.AddDefaulted_GetRef();
-  section.bEnableCollision = true;
-
-  section.NumTriangles = indices.Num() / 3;
-  section.FirstIndex = 0;
-  section.MinVertexIndex = 0;
-  section.MaxVertexIndex = StaticMeshBuildVertices.Num() - 1;
-  section.bEnableCollision = true;
-  section.bCastShadow = true;
-
   // Note that we're reversing the order of the indices, because the change
   // from the glTF right-handed to the Unreal left-handed coordinate system
   // reverses the winding order.
@@ -968,6 +949,8 @@ static void loadPrimitive(
   // will change the order of the faces.
   if (duplicateVertices) {
     CESIUM_TRACE("reverse winding order of duplicated vertices");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::ReverseWindingOrder);
     for (int32 i = 2; i < indices.Num(); i += 3) {
       indices[i - 2] = i;
       indices[i - 1] = i - 1;
@@ -975,74 +958,23 @@ static void loadPrimitive(
     }
   } else {
     CESIUM_TRACE("reverse winding order");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::ReverseWindingOrder);
     for (int32 i = 2; i < indices.Num(); i += 3) {
       std::swap(indices[i - 2], indices[i]);
     }
   }
 
-  {
-    CESIUM_TRACE("SetIndices");
-    LODResources.IndexBuffer.SetIndices(
-        indices,
-        indices.Num() > std::numeric_limits<uint16>::max()
-            ? EIndexBufferStride::Type::Force32Bit
-            : EIndexBufferStride::Type::Force16Bit);
-  }
-
-  LODResources.bHasDepthOnlyIndices = false;
-  LODResources.bHasReversedIndices = false;
-  LODResources.bHasReversedDepthOnlyIndices = false;
-  LODResources.bHasAdjacencyInfo = false;
-
   primitiveResult.pModel = &model;
   primitiveResult.pMeshPrimitive = &primitive;
-  primitiveResult.RenderData = RenderData;
   primitiveResult.transform = transform;
   primitiveResult.pMaterial = &material;
-
-  section.MaterialIndex = 0;
-
-  primitiveResult.pCollisionMesh = nullptr;
-
-#if PHYSICS_INTERFACE_PHYSX
-  if (options.pPhysXCooking) {
-    CESIUM_TRACE("PhysX cook");
-    // TODO: use PhysX interface directly so we don't need to copy the
-    // vertices (it takes a stride parameter).
-    TArray<FVector> vertices;
-    vertices.SetNum(StaticMeshBuildVertices.Num());
-
-    for (size_t i = 0; i < StaticMeshBuildVertices.Num(); ++i) {
-      vertices[i] = StaticMeshBuildVertices[i].Position;
-    }
-
-    TArray<FTriIndices> physicsIndices;
-    physicsIndices.SetNum(indices.Num() / 3);
-
-    for (size_t i = 0; i < indices.Num() / 3; ++i) {
-      physicsIndices[i].v0 = indices[3 * i];
-      physicsIndices[i].v1 = indices[3 * i + 1];
-      physicsIndices[i].v2 = indices[3 * i + 2];
-    }
-
-    options.pPhysXCooking->CreateTriMesh(
-        "PhysXGeneric",
-        EPhysXMeshCookFlags::Default,
-        vertices,
-        physicsIndices,
-        TArray<uint16>(),
-        true,
-        primitiveResult.pCollisionMesh);
-  }
-#else
-  if (StaticMeshBuildVertices.Num() != 0 && indices.Num() != 0) {
-    CESIUM_TRACE("Chaos cook");
-    primitiveResult.pCollisionMesh = BuildChaosTriangleMeshes(
-        duplicateVertices,
-        StaticMeshBuildVertices,
-        indices);
-  }
-#endif
+  primitiveResult.vertices = MoveTemp(StaticMeshBuildVertices);
+  primitiveResult.indices = MoveTemp(indices);
+  primitiveResult.textureCoordinateCount =
+      static_cast<uint32_t>(textureCoordinateMap.size());
+  primitiveResult.hasVertexColors = hasVertexColors;
+  primitiveResult.duplicateVertices = duplicateVertices;
 
   // load primitive metadata
   primitiveResult.Metadata = loadMetadataPrimitive(model, primitive);
@@ -1201,12 +1133,38 @@ static void loadMesh(
   }
 }
 
+namespace {
+/**
+ * The transforms of the nodes that reference each mesh, in the order in which
+ * the meshes are first referenced.
+ */
+class MeshInstances {
+public:
+  void add(int meshId, const glm::dmat4x4& transform) {
+    auto it = this->_indices.find(meshId);
+    if (it == this->_indices.end()) {
+      it = this->_indices.emplace(meshId, this->_meshes.size()).first;
+      this->_meshes.emplace_back(meshId, std::vector<glm::dmat4x4>());
+    }
+    this->_meshes[it->second].second.push_back(transform);
+  }
+
+  const std::vector<std::pair<int, std::vector<glm::dmat4x4>>>&
+  getMeshes() const {
+    return this->_meshes;
+  }
+
+private:
+  std::vector<std::pair<int, std::vector<glm::dmat4x4>>> _meshes;
+  std::unordered_map<int, size_t> _indices;
+};
+} // namespace
+
 static void loadNode(
-    std::vector<LoadModelResult>& result,
+    MeshInstances& meshInstances,
     const CesiumGltf::Model& model,
     const CesiumGltf::Node& node,
-    const glm::dmat4x4& transform,
-    const CreateModelOptions& options) {
+    const glm::dmat4x4& transform) {
   static constexpr std::array<double, 16> identityMatrix = {
       1.0,
       0.0,
@@ -1275,15 +1233,374 @@ static void loadNode(
 
   int meshId = node.mesh;
   if (meshId >= 0 && meshId < model.meshes.size()) {
-    const CesiumGltf::Mesh& mesh = model.meshes[meshId];
-    loadMesh(result, model, mesh, nodeTransform, options);
+    meshInstances.add(meshId, nodeTransform);
   }
 
   for (int childNodeId : node.children) {
     if (childNodeId >= 0 && childNodeId < model.nodes.size()) {
-      loadNode(result, model, model.nodes[childNodeId], nodeTransform, options);
+      loadNode(meshInstances, model, model.nodes[childNodeId], nodeTransform);
+    }
+  }
+}
+
+/**
+ * @brief Loads each mesh that is referenced by a node.
+ *
+ * A mesh that is referenced by several nodes, such as a tree or a piece of
+ * street furniture placed many times in the same tile, is loaded only once,
+ * and each of its primitives is drawn once for every node as an instance.
+ */
+static void loadMeshInstances(
+    std::vector<LoadModelResult>& result,
+    const CesiumGltf::Model& model,
+    const MeshInstances& meshInstances,
+    const CreateModelOptions& options) {
+  CESIUM_TRACE("loadMeshInstances");
+
+  for (const auto& instances : meshInstances.getMeshes()) {
+    const CesiumGltf::Mesh& mesh = model.meshes[instances.first];
+    const std::vector<glm::dmat4x4>& transforms = instances.second;
+
+    if (transforms.size() == 1) {
+      loadMesh(result, model, mesh, transforms[0], options);
+      continue;
+    }
+
+    // An instanced static mesh draws all of its instances with the winding
+    // order of the component, so instances that mirror the mesh would be
+    // drawn inside out. The nodes that mirror the mesh are loaded as separate
+    // primitives instead, whose components flip the winding order.
+    std::vector<glm::dmat4x4> instanceTransforms;
+    instanceTransforms.reserve(transforms.size());
+    for (const glm::dmat4x4& transform : transforms) {
+      if (glm::determinant(glm::dmat3(transform)) < 0.0) {
+        loadMesh(result, model, mesh, transform, options);
+      } else {
+        instanceTransforms.push_back(transform);
+      }
+    }
+
+    if (instanceTransforms.size() <= 1) {
+      if (!instanceTransforms.empty()) {
+        loadMesh(result, model, mesh, instanceTransforms[0], options);
+      }
+      continue;
+    }
+
+    size_t firstPrimitive = result.size();
+    loadMesh(result, model, mesh, glm::dmat4x4(1.0), options);
+    for (size_t i = firstPrimitive; i < result.size(); ++i) {
+      result[i].instanceTransforms = instanceTransforms;
+    }
+  }
+}
+
+/**
+ * @brief Determines if a primitive may be merged with other primitives of the
+ * same model.
+ *
+ * Instanced primitives, primitives with a water mask, and primitives with
+ * feature metadata are never merged. The metadata refers to the vertices of
+ * the original glTF primitive, so it would not match the merged vertices.
+ */
+static bool isMergeablePrimitive(
+    const LoadModelResult& primitiveResult,
+    int32 maxVertices) {
+  return primitiveResult.instanceTransforms.empty() &&
+         primitiveResult.vertices.Num() <= maxVertices &&
+         primitiveResult.onlyLand && !primitiveResult.onlyWater &&
+         !primitiveResult.waterMaskTexture &&
+         !primitiveResult.pMeshPrimitive->getExtension<
+             CesiumGltf::ExtensionMeshPrimitiveExtFeatureMetadata>();
+}
+
+/**
+ * @brief Determines if two primitives can be drawn with the same material
+ * instance and the same vertex layout.
+ */
+static bool
+canMergePrimitives(const LoadModelResult& lhs, const LoadModelResult& rhs) {
+  return lhs.pModel == rhs.pModel && lhs.pMaterial == rhs.pMaterial &&
+         lhs.hasVertexColors == rhs.hasVertexColors &&
+         lhs.textureCoordinateCount == rhs.textureCoordinateCount &&
+         lhs.textureCoordinateParameters == rhs.textureCoordinateParameters &&
+         lhs.overlayTextureCoordinateIDToUVIndex ==
+             rhs.overlayTextureCoordinateIDToUVIndex;
+}
+
+/**
+ * @brief Appends the vertices and indices of one primitive to another.
+ *
+ * The source primitive's transform, relative to the target primitive's
+ * transform, is baked into the appended vertices.
+ */
+static void
+appendPrimitive(LoadModelResult& target, const LoadModelResult& source) {
+  const glm::dmat4x4 relativeTransform =
+      glm::inverse(target.transform) * source.transform;
+  const uint32 firstVertex = static_cast<uint32>(target.vertices.Num());
+
+  target.vertices.Reserve(target.vertices.Num() + source.vertices.Num());
+  target.indices.Reserve(target.indices.Num() + source.indices.Num());
+
+  if (relativeTransform == glm::dmat4x4(1.0)) {
+    target.vertices.Append(source.vertices);
+    target.boundingBox += source.boundingBox;
+    for (uint32 index : source.indices) {
+      target.indices.Add(firstVertex + index);
+    }
+  } else {
+    const glm::dmat3 tangentMatrix(relativeTransform);
+    const glm::dmat3 normalMatrix =
+        glm::transpose(glm::inverse(tangentMatrix));
+
+    auto transformDirection = [](const glm::dmat3& matrix,
+                                 const FVector& direction) {
+      glm::dvec3 result =
+          matrix * glm::dvec3(direction.X, direction.Y, direction.Z);
+      return FVector(result.x, result.y, result.z).GetSafeNormal();
+    };
+
+    for (const FStaticMeshBuildVertex& sourceVertex : source.vertices) {
+      FStaticMeshBuildVertex& vertex = target.vertices.Add_GetRef(sourceVertex);
+      const FVector& sourcePosition = sourceVertex.Position;
+      glm::dvec3 position = glm::dvec3(
+          relativeTransform * glm::dvec4(
+                                  sourcePosition.X,
+                                  sourcePosition.Y,
+                                  sourcePosition.Z,
+                                  1.0));
+      vertex.Position = FVector(position.x, position.y, position.z);
+      vertex.TangentX = transformDirection(tangentMatrix, vertex.TangentX);
+      vertex.TangentY = transformDirection(tangentMatrix, vertex.TangentY);
+      vertex.TangentZ = transformDirection(normalMatrix, vertex.TangentZ);
+      target.boundingBox += vertex.Position;
+    }
+
+    // A mirroring transform reverses the winding order of the triangles.
+    const bool reverseWindingOrder = glm::determinant(tangentMatrix) < 0.0;
+    for (int32 i = 2; i < source.indices.Num(); i += 3) {
+      if (reverseWindingOrder) {
+        target.indices.Add(firstVertex + source.indices[i]);
+        target.indices.Add(firstVertex + source.indices[i - 1]);
+        target.indices.Add(firstVertex + source.indices[i - 2]);
+      } else {
+        target.indices.Add(firstVertex + source.indices[i - 2]);
+        target.indices.Add(firstVertex + source.indices[i - 1]);
+        target.indices.Add(firstVertex + source.indices[i]);
+      }
     }
   }
+
+  target.duplicateVertices =
+      target.duplicateVertices && source.duplicateVertices;
+}
+
+/**
+ * @brief Merges small primitives that share a material into a single
+ * primitive, so that they are drawn with a single draw call.
+ *
+ * Each merged primitive keeps the transform of the first primitive in its
+ * group, and the transforms of the others are baked into their vertices.
+ */
+static void mergePrimitives(
+    std::vector<LoadModelResult>& result,
+    const CreateModelOptions& options) {
+  CESIUM_TRACE("mergePrimitives");
+
+  std::vector<LoadModelResult> merged;
+  merged.reserve(result.size());
+
+  // The indices in `merged` of the primitives that others can be merged into.
+  std::vector<size_t> mergeTargets;
+
+  for (LoadModelResult& primitiveResult : result) {
+    if (!isMergeablePrimitive(
+            primitiveResult,
+            options.maximumMergedPrimitiveVertices)) {
+      merged.push_back(std::move(primitiveResult));
+      continue;
+    }
+
+    auto targetIt = std::find_if(
+        mergeTargets.begin(),
+        mergeTargets.end(),
+        [&merged, &primitiveResult](size_t targetIndex) {
+          return canMergePrimitives(merged[targetIndex], primitiveResult);
+        });
+    if (targetIt == mergeTargets.end()) {
+      mergeTargets.push_back(merged.size());
+      merged.push_back(std::move(primitiveResult));
+    } else {
+      appendPrimitive(merged[*targetIt], primitiveResult);
+    }
+  }
+
+  result = std::move(merged);
+}
+
+/**
+ * @brief Creates the render data, textures, and collision mesh of a primitive
+ * from the vertices and indices gathered by loadPrimitive.
+ */
+static void loadPrimitiveRenderData(
+    LoadModelResult& primitiveResult,
+    const CreateModelOptions& options) {
+  CESIUM_TRACE("loadPrimitiveRenderData");
+  CesiumMeshBuildTimer::Scope renderDataStage(
+      CesiumMeshBuildTimer::Stage::LoadRenderData);
+
+  const CesiumGltf::Model& model = *primitiveResult.pModel;
+  const CesiumGltf::Material& material = *primitiveResult.pMaterial;
+  const CesiumGltf::MaterialPBRMetallicRoughness& pbrMetallicRoughness =
+      material.pbrMetallicRoughness ? material.pbrMetallicRoughness.value()
+                                    : defaultPbrMetallicRoughness;
+
+  {
+    CESIUM_TRACE("loadTextures");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::LoadTextures);
+    primitiveResult.baseColorTexture =
+        loadTexture(model, pbrMetallicRoughness.baseColorTexture);
+    primitiveResult.metallicRoughnessTexture =
+        loadTexture(model, pbrMetallicRoughness.metallicRoughnessTexture);
+    primitiveResult.normalTexture = loadTexture(model, material.normalTexture);
+    primitiveResult.occlusionTexture =
+        loadTexture(model, material.occlusionTexture);
+    primitiveResult.emissiveTexture =
+        loadTexture(model, material.emissiveTexture);
+  }
+
+  TArray<FStaticMeshBuildVertex>& StaticMeshBuildVertices =
+      primitiveResult.vertices;
+  TArray<uint32>& indices = primitiveResult.indices;
+
+  FStaticMeshRenderData* RenderData = new FStaticMeshRenderData();
+  RenderData->AllocateLODResources(1);
+
+  FStaticMeshLODResources& LODResources = RenderData->LODResources[0];
+
+  {
+    CESIUM_TRACE("compute bounding sphere");
+    primitiveResult.boundingBox.GetCenterAndExtents(
+        RenderData->Bounds.Origin,
+        RenderData->Bounds.BoxExtent);
+    RenderData->Bounds.SphereRadius = 0.0f;
+    for (const FStaticMeshBuildVertex& vertex : StaticMeshBuildVertices) {
+      RenderData->Bounds.SphereRadius = FMath::Max(
+          (vertex.Position - RenderData->Bounds.Origin).Size(),
+          RenderData->Bounds.SphereRadius);
+    }
+  }
+
+  LODResources.bHasColorVertexData = primitiveResult.hasVertexColors;
+
+  {
+    CESIUM_TRACE("init buffers");
+    LODResources.VertexBuffers.PositionVertexBuffer.Init(
+        StaticMeshBuildVertices,
+        false);
+
+    FColorVertexBuffer& ColorVertexBuffer =
+        LODResources.VertexBuffers.ColorVertexBuffer;
+    if (primitiveResult.hasVertexColors) {
+      ColorVertexBuffer.Init(StaticMeshBuildVertices, false);
+    }
+
+    LODResources.VertexBuffers.StaticMeshVertexBuffer.Init(
+        StaticMeshBuildVertices,
+        primitiveResult.textureCoordinateCount == 0
+            ? 1
+            : primitiveResult.textureCoordinateCount,
+        false);
+  }
+
+  FStaticMeshLODResources::FStaticMeshSectionArray& Sections =
+      LODResources.Sections;
+  FStaticMeshSection& section = Sections.AddDefaulted_GetRef();
+  section.bEnableCollision = true;
+
+  section.NumTriangles = indices.Num() / 3;
+  section.FirstIndex = 0;
+  section.MinVertexIndex = 0;
+  section.MaxVertexIndex = StaticMeshBuildVertices.Num() - 1;
+  section.bEnableCollision = true;
+  section.bCastShadow = true;
+
+  {
+    CESIUM_TRACE("SetIndices");
+    LODResources.IndexBuffer.SetIndices(
+        indices,
+        indices.Num() > std::numeric_limits<uint16>::max()
+            ? EIndexBufferStride::Type::Force32Bit
+            : EIndexBufferStride::Type::Force16Bit);
+  }
+
+  LODResources.bHasDepthOnlyIndices = false;
+  LODResources.bHasReversedIndices = false;
+  LODResources.bHasReversedDepthOnlyIndices = false;
+  LODResources.bHasAdjacencyInfo = false;
+
+  primitiveResult.RenderData = RenderData;
+
+  section.MaterialIndex = 0;
+
+  primitiveResult.pCollisionMesh = nullptr;
+
+#if PHYSICS_INTERFACE_PHYSX
+  if (options.pPhysXCooking) {
+    CESIUM_TRACE("PhysX cook");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::CookCollision);
+    // TODO: use PhysX interface directly so we don't need to copy the
+    // vertices (it takes a stride parameter).
+    TArray<FVector> vertices;
+    vertices.SetNum(StaticMeshBuildVertices.Num());
+
+    for (size_t i = 0; i < StaticMeshBuildVertices.Num(); ++i) {
+      vertices[i] = StaticMeshBuildVertices[i].Position;
+    }
+
+    TArray<FTriIndices> physicsIndices;
+    physicsIndices.SetNum(indices.Num() / 3);
+
+    for (size_t i = 0; i < indices.Num() / 3; ++i) {
+      physicsIndices[i].v0 = indices[3 * i];
+      physicsIndices[i].v1 = indices[3 * i + 1];
+      physicsIndices[i].v2 = indices[3 * i + 2];
+    }
+
+    options.pPhysXCooking->CreateTriMesh(
+        "PhysXGeneric",
+        EPhysXMeshCookFlags::Default,
+        vertices,
+        physicsIndices,
+        TArray<uint16>(),
+        true,
+        primitiveResult.pCollisionMesh);
+  }
+#else
+  if (StaticMeshBuildVertices.Num() != 0 && indices.Num() != 0) {
+    CESIUM_TRACE("Chaos cook");
+    CesiumMeshBuildTimer::Scope stage(
+        CesiumMeshBuildTimer::Stage::CookCollision);
+    primitiveResult.pCollisionMesh = BuildChaosTriangleMeshes(
+        primitiveResult.duplicateVertices,
+        StaticMeshBuildVertices,
+        indices);
+  }
+#endif
+
+  if (primitiveResult.pCollisionMesh) {
+    primitiveResult.collisionMeshBytes =
+        StaticMeshBuildVertices.Num() * sizeof(FVector) +
+        indices.Num() * sizeof(uint32);
+  }
+
+  // The vertices and indices are no longer needed now that the render data
+  // and collision mesh have been created.
+  StaticMeshBuildVertices.Empty();
+  indices.Empty();
 }
 
 namespace {
@@ -1397,21 +1714,23 @@ static std::vector<LoadModelResult> loadModelAnyThreadPart(
     applyGltfUpAxisTransform(model, rootTransform);
   }
 
+  MeshInstances meshInstances;
+
   if (model.scene >= 0 && model.scene < model.scenes.size()) {
     // Show the default scene
     const CesiumGltf::Scene& defaultScene = model.scenes[model.scene];
     for (int nodeId : defaultScene.nodes) {
-      loadNode(result, model, model.nodes[nodeId], rootTransform, options);
+      loadNode(meshInstances, model, model.nodes[nodeId], rootTransform);
     }
   } else if (model.scenes.size() > 0) {
     // There's no default, so show the first scene
     const CesiumGltf::Scene& defaultScene = model.scenes[0];
     for (int nodeId : defaultScene.nodes) {
-      loadNode(result, model, model.nodes[nodeId], rootTransform, options);
+      loadNode(meshInstances, model, model.nodes[nodeId], rootTransform);
     }
   } else if (model.nodes.size() > 0) {
     // No scenes at all, use the first node as the root node.
-    loadNode(result, model, model.nodes[0], rootTransform, options);
+    loadNode(meshInstances, model, model.nodes[0], rootTransform);
   } else if (model.meshes.size() > 0) {
     // No nodes either, show all the meshes.
     for (const CesiumGltf::Mesh& mesh : model.meshes) {
@@ -1419,6 +1738,16 @@ static std::vector<LoadModelResult> loadModelAnyThreadPart(
     }
   }
 
+  loadMeshInstances(result, model, meshInstances, options);
+
+  if (options.mergeSmallPrimitives) {
+    mergePrimitives(result, options);
+  }
+
+  for (LoadModelResult& primitiveResult : result) {
+    loadPrimitiveRenderData(primitiveResult, options);
+  }
+
   return result;
 }
 
@@ -1540,18 +1869,34 @@ void SetWaterParameterValues(
           loadResult.waterMaskScale));
 }
 
-static void loadModelGameThreadPart(
+static void setPrimitiveTransform(
+    UCesiumGltfPrimitiveComponent* pMesh,
+    LoadModelResult& loadResult,
+    const glm::dmat4x4& cesiumToAnchorTransform) {
+  pMesh->HighPrecisionNodeTransform = loadResult.transform;
+  pMesh->UpdateTransformFromCesium(cesiumToAnchorTransform);
+}
+
+static void setPrimitiveTransform(
+    UCesiumGltfInstancedComponent* pMesh,
+    LoadModelResult& loadResult,
+    const glm::dmat4x4& cesiumToAnchorTransform) {
+  pMesh->HighPrecisionInstanceTransforms =
+      std::move(loadResult.instanceTransforms);
+  pMesh->UpdateTransformFromCesium(cesiumToAnchorTransform);
+}
+
+template <class TPrimitiveComponent>
+static void loadPrimitiveGameThreadPart(
     UCesiumGltfComponent* pGltf,
     LoadModelResult& loadResult,
-    const glm::dmat4x4& cesiumToUnrealTransform) {
+    const glm::dmat4x4& cesiumToAnchorTransform) {
 
   FName meshName = createSafeName(loadResult.name, "");
-  UCesiumGltfPrimitiveComponent* pMesh =
-      NewObject<UCesiumGltfPrimitiveComponent>(pGltf, meshName);
+  TPrimitiveComponent* pMesh = NewObject<TPrimitiveComponent>(pGltf, meshName);
   pMesh->overlayTextureCoordinateIDToUVIndex =
       loadResult.overlayTextureCoordinateIDToUVIndex;
-  pMesh->HighPrecisionNodeTransform = loadResult.transform;
-  pMesh->UpdateTransformFromCesium(cesiumToUnrealTransform);
+  setPrimitiveTransform(pMesh, loadResult, cesiumToAnchorTransform);
 
   pMesh->bUseDefaultCollision = false;
   pMesh->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
@@ -1582,6 +1927,8 @@ static void loadModelGameThreadPart(
   pStaticMesh->SetRenderData(
       TUniquePtr<FStaticMeshRenderData>(loadResult.RenderData));
 #endif
+  // The static mesh owns the render data now.
+  loadResult.RenderData = nullptr;
 
   const CesiumGltf::Model& model = *loadResult.pModel;
   const CesiumGltf::Material& material =
@@ -1723,12 +2070,104 @@ static void loadModelGameThreadPart(
   pMesh->RegisterComponent();
 }
 
+static void loadModelGameThreadPart(
+    UCesiumGltfComponent* pGltf,
+    LoadModelResult& loadResult,
+    const glm::dmat4x4& cesiumToAnchorTransform) {
+  if (loadResult.instanceTransforms.empty()) {
+    loadPrimitiveGameThreadPart<UCesiumGltfPrimitiveComponent>(
+        pGltf,
+        loadResult,
+        cesiumToAnchorTransform);
+  } else {
+    loadPrimitiveGameThreadPart<UCesiumGltfInstancedComponent>(
+        pGltf,
+        loadResult,
+        cesiumToAnchorTransform);
+  }
+}
+
 namespace {
+void deleteLoadedTexture(
+    CesiumTextureUtility::LoadedTextureResult* pLoadedTexture) {
+  if (!pLoadedTexture) {
+    return;
+  }
+
+  // Once the texture is created, it owns the platform data.
+  if (!pLoadedTexture->pTexture) {
+    delete pLoadedTexture->pTextureData;
+  }
+  delete pLoadedTexture;
+}
+
 class HalfConstructedReal : public UCesiumGltfComponent::HalfConstructed {
 public:
-  virtual ~HalfConstructedReal() {}
+  // Frees what was not handed over to Unreal objects by
+  // CreateDeferredPrimitives, for example because the tile was unloaded before
+  // it was shown.
+  virtual ~HalfConstructedReal() {
+    for (LoadModelResult& result : this->loadModelResult) {
+      delete result.RenderData;
+      deleteLoadedTexture(result.baseColorTexture);
+      deleteLoadedTexture(result.metallicRoughnessTexture);
+      deleteLoadedTexture(result.normalTexture);
+      deleteLoadedTexture(result.emissiveTexture);
+      deleteLoadedTexture(result.occlusionTexture);
+      deleteLoadedTexture(result.waterMaskTexture);
+    }
+  }
+
+  virtual const FCesiumTilesetMemoryUsage& GetMemoryUsage() const override {
+    return this->memoryUsage;
+  }
+
   std::vector<LoadModelResult> loadModelResult;
+  FCesiumTilesetMemoryUsage memoryUsage;
 };
+
+int64 getLoadedTextureBytes(
+    const CesiumTextureUtility::LoadedTextureResult* pLoadedTexture,
+    std::unordered_set<const FTexturePlatformData*>& counted) {
+  if (!pLoadedTexture || !pLoadedTexture->pTextureData ||
+      !counted.insert(pLoadedTexture->pTextureData).second) {
+    return 0;
+  }
+
+  int64 bytes = 0;
+  for (const FTexture2DMipMap& mip : pLoadedTexture->pTextureData->Mips) {
+    bytes += mip.BulkData.GetBulkDataSize();
+  }
+  return bytes;
+}
+
+FCesiumTilesetMemoryUsage
+computeMemoryUsage(const std::vector<LoadModelResult>& loadModelResult) {
+  FCesiumTilesetMemoryUsage usage;
+  std::unordered_set<const FTexturePlatformData*> textures;
+
+  for (const LoadModelResult& result : loadModelResult) {
+    if (result.RenderData) {
+      FResourceSizeEx renderDataSize(EResourceSizeMode::Exclusive);
+      result.RenderData->GetResourceSizeEx(renderDataSize);
+      usage.GeometryBytes += renderDataSize.GetTotalMemoryBytes();
+    }
+
+    usage.GeometryBytes += result.instanceTransforms.size() *
+                           sizeof(FInstancedStaticMeshInstanceData);
+    usage.PhysicsBytes += result.collisionMeshBytes;
+
+    usage.TextureBytes +=
+        getLoadedTextureBytes(result.baseColorTexture, textures) +
+        getLoadedTextureBytes(result.metallicRoughnessTexture, textures) +
+        getLoadedTextureBytes(result.normalTexture, textures) +
+        getLoadedTextureBytes(result.emissiveTexture, textures) +
+        getLoadedTextureBytes(result.occlusionTexture, textures) +
+        getLoadedTextureBytes(result.waterMaskTexture, textures);
+  }
+
+  return usage;
+}
 } // namespace
 
 /*static*/ std::unique_ptr<UCesiumGltfComponent::HalfConstructed>
@@ -1738,43 +2177,96 @@ UCesiumGltfComponent::CreateOffGameThread(
     const CreateModelOptions& Options) {
   auto pResult = std::make_unique<HalfConstructedReal>();
   pResult->loadModelResult = loadModelAnyThreadPart(Model, Transform, Options);
+  pResult->memoryUsage = computeMemoryUsage(pResult->loadModelResult);
   return pResult;
 }
 
 /*static*/ UCesiumGltfComponent* UCesiumGltfComponent::CreateOnGameThread(
     AActor* pParentActor,
     std::unique_ptr<HalfConstructed> pHalfConstructed,
-    const glm::dmat4x4& cesiumToUnrealTransform,
+    const glm::dmat4x4& cesiumToAnchorTransform,
     UMaterialInterface* pBaseMaterial,
     UMaterialInterface* pBaseWaterMaterial,
     FCustomDepthParameters CustomDepthParameters) {
+  UCesiumGltfComponent* Gltf = UCesiumGltfComponent::CreateDeferredOnGameThread(
+      pParentActor,
+      std::move(pHalfConstructed));
+  if (Gltf) {
+    Gltf->CreateDeferredPrimitives(
+        cesiumToAnchorTransform,
+        pBaseMaterial,
+        pBaseWaterMaterial,
+        CustomDepthParameters);
+  }
+  return Gltf;
+}
+
+/*static*/ UCesiumGltfComponent*
+UCesiumGltfComponent::CreateDeferredOnGameThread(
+    AActor* pParentActor,
+    std::unique_ptr<HalfConstructed> pHalfConstructed) {
   HalfConstructedReal* pReal =
       static_cast<HalfConstructedReal*>(pHalfConstructed.get());
-  std::vector<LoadModelResult>& result = pReal->loadModelResult;
-  if (result.size() == 0) {
+  if (pReal->loadModelResult.size() == 0) {
     return nullptr;
   }
 
   UCesiumGltfComponent* Gltf = NewObject<UCesiumGltfComponent>(pParentActor);
-  Gltf->SetUsingAbsoluteLocation(true);
   Gltf->SetFlags(RF_Transient | RF_DuplicateTransient | RF_TextExportTransient);
+  Gltf->SetVisibility(false, false);
+  Gltf->_memoryUsage = pHalfConstructed->GetMemoryUsage();
+  Gltf->_pDeferred = std::move(pHalfConstructed);
+  return Gltf;
+}
+
+void UCesiumGltfComponent::CreateDeferredPrimitives(
+    const glm::dmat4x4& cesiumToAnchorTransform,
+    UMaterialInterface* pBaseMaterial,
+    UMaterialInterface* pBaseWaterMaterial,
+    FCustomDepthParameters CustomDepthParameters) {
+  if (!this->_pDeferred) {
+    return;
+  }
+
+  std::unique_ptr<HalfConstructed> pHalfConstructed =
+      std::move(this->_pDeferred);
+  HalfConstructedReal* pReal =
+      static_cast<HalfConstructedReal*>(pHalfConstructed.get());
 
   if (pBaseMaterial) {
-    Gltf->BaseMaterial = pBaseMaterial;
+    this->BaseMaterial = pBaseMaterial;
   }
 
   if (pBaseWaterMaterial) {
-    Gltf->BaseMaterialWithWater = pBaseWaterMaterial;
+    this->BaseMaterialWithWater = pBaseWaterMaterial;
   }
 
-  Gltf->CustomDepthParameters = CustomDepthParameters;
+  this->CustomDepthParameters = CustomDepthParameters;
 
-  for (LoadModelResult& model : result) {
-    loadModelGameThreadPart(Gltf, model, cesiumToUnrealTransform);
+  for (LoadModelResult& model : pReal->loadModelResult) {
+    loadModelGameThreadPart(this, model, cesiumToAnchorTransform);
+  }
+  this->computeMemoryUsage();
+  this->setPrimitivesVisible(this->IsVisible());
+
+  // The new materials are fully visible, so apply a fade that was set while
+  // the primitives were deferred.
+  float fadePercentage = this->_fadePercentage;
+  this->_fadePercentage = 1.0f;
+  this->SetFadePercentage(fadePercentage);
+
+  std::vector<PendingRasterTile> pendingRasterTiles =
+      std::move(this->_pendingRasterTiles);
+  this->_pendingRasterTiles.clear();
+  for (const PendingRasterTile& pending : pendingRasterTiles) {
+    this->AttachRasterTile(
+        *pending.pTile,
+        *pending.pRasterTile,
+        pending.pTexture,
+        pending.translation,
+        pending.scale,
+        pending.textureCoordinateID);
   }
-  Gltf->SetVisibility(false, true);
-  Gltf->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-  return Gltf;
 }
 
 UCesiumGltfComponent::UCesiumGltfComponent() : USceneComponent() {
@@ -1805,13 +2297,21 @@ UCesiumGltfComponent::~UCesiumGltfComponent() {
   UE_LOG(LogCesium, VeryVerbose, TEXT("~UCesiumGltfComponent"));
 }
 
+void UCesiumGltfComponent::BeginDestroy() {
+  // Free the meshes and textures of deferred primitives now rather than when
+  // the component is garbage collected.
+  this->_pDeferred.reset();
+  this->_pendingRasterTiles.clear();
+
+  Super::BeginDestroy();
+}
+
 void UCesiumGltfComponent::UpdateTransformFromCesium(
-    const glm::dmat4& cesiumToUnrealTransform) {
+    const glm::dmat4& cesiumToAnchorTransform) {
   for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
-    UCesiumGltfPrimitiveComponent* pPrimitive =
-        Cast<UCesiumGltfPrimitiveComponent>(pSceneComponent);
-    if (pPrimitive) {
-      pPrimitive->UpdateTransformFromCesium(cesiumToUnrealTransform);
+    if (ICesiumGltfPrimitive* pPrimitive =
+            Cast<ICesiumGltfPrimitive>(pSceneComponent)) {
+      pPrimitive->UpdateTransformFromCesium(cesiumToAnchorTransform);
     }
   }
 }
@@ -1821,9 +2321,12 @@ namespace {
 template <typename Func>
 void forEachPrimitiveComponent(UCesiumGltfComponent* pGltf, Func&& f) {
   for (USceneComponent* pSceneComponent : pGltf->GetAttachChildren()) {
-    UCesiumGltfPrimitiveComponent* pPrimitive =
-        Cast<UCesiumGltfPrimitiveComponent>(pSceneComponent);
-    if (pPrimitive) {
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
+    ICesiumGltfPrimitive* pGltfPrimitive =
+        Cast<ICesiumGltfPrimitive>(pSceneComponent);
+
+    if (pPrimitive && pGltfPrimitive) {
       UMaterialInstanceDynamic* pMaterial =
           Cast<UMaterialInstanceDynamic>(pPrimitive->GetMaterial(0));
 
@@ -1844,7 +2347,9 @@ void forEachPrimitiveComponent(UCesiumGltfComponent* pGltf, Func&& f) {
                     ->GetAssetUserData<UCesiumMaterialUserData>()
               : nullptr;
 
-      f(pPrimitive, pMaterial, pCesiumData);
+      f(pGltfPrimitive->overlayTextureCoordinateIDToUVIndex,
+        pMaterial,
+        pCesiumData);
     }
   }
 }
@@ -1858,6 +2363,16 @@ void UCesiumGltfComponent::AttachRasterTile(
     const glm::dvec2& translation,
     const glm::dvec2& scale,
     int32 textureCoordinateID) {
+  if (this->_pDeferred) {
+    this->_pendingRasterTiles.push_back(PendingRasterTile{
+        &tile,
+        &rasterTile,
+        pTexture,
+        translation,
+        scale,
+        textureCoordinateID});
+    return;
+  }
 
   FLinearColor translationAndScale(
       translation.x,
@@ -1868,7 +2383,7 @@ void UCesiumGltfComponent::AttachRasterTile(
   forEachPrimitiveComponent(
       this,
       [&rasterTile, pTexture, &translationAndScale, textureCoordinateID](
-          UCesiumGltfPrimitiveComponent* pPrimitive,
+          OverlayTextureCoordinateIDMap& overlayTextureCoordinateIDToUVIndex,
           UMaterialInstanceDynamic* pMaterial,
           UCesiumMaterialUserData* pCesiumData) {
         // If this material uses material layers and has the Cesium user data,
@@ -1900,8 +2415,7 @@ void UCesiumGltfComponent::AttachRasterTile(
                     "TextureCoordinateIndex",
                     EMaterialParameterAssociation::LayerParameter,
                     i),
-                pPrimitive
-                    ->overlayTextureCoordinateIDToUVIndex[textureCoordinateID]);
+                overlayTextureCoordinateIDToUVIndex[textureCoordinateID]);
           }
         } else {
           pMaterial->SetTextureParameterValue(
@@ -1916,8 +2430,7 @@ void UCesiumGltfComponent::AttachRasterTile(
               createSafeName(
                   rasterTile.getOverlay().getName(),
                   "_TextureCoordinateIndex"),
-              pPrimitive
-                  ->overlayTextureCoordinateIDToUVIndex[textureCoordinateID]);
+              overlayTextureCoordinateIDToUVIndex[textureCoordinateID]);
         }
       });
 }
@@ -1926,11 +2439,23 @@ void UCesiumGltfComponent::DetachRasterTile(
     const Cesium3DTilesSelection::Tile& tile,
     const Cesium3DTilesSelection::RasterOverlayTile& rasterTile,
     UTexture2D* pTexture) {
+  if (this->_pDeferred) {
+    this->_pendingRasterTiles.erase(
+        std::remove_if(
+            this->_pendingRasterTiles.begin(),
+            this->_pendingRasterTiles.end(),
+            [&rasterTile, pTexture](const PendingRasterTile& pending) {
+              return pending.pRasterTile == &rasterTile &&
+                     pending.pTexture == pTexture;
+            }),
+        this->_pendingRasterTiles.end());
+    return;
+  }
 
   forEachPrimitiveComponent(
       this,
       [this, &rasterTile, pTexture](
-          UCesiumGltfPrimitiveComponent* pPrimitive,
+          OverlayTextureCoordinateIDMap& /*overlayTextureCoordinateIDToUVIndex*/,
           UMaterialInstanceDynamic* pMaterial,
           UCesiumMaterialUserData* pCesiumData) {
         // If this material uses material layers and has the Cesium user data,
@@ -1962,14 +2487,144 @@ void UCesiumGltfComponent::DetachRasterTile(
 void UCesiumGltfComponent::SetCollisionEnabled(
     ECollisionEnabled::Type NewType) {
   for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
-    UCesiumGltfPrimitiveComponent* pPrimitive =
-        Cast<UCesiumGltfPrimitiveComponent>(pSceneComponent);
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
     if (pPrimitive) {
       pPrimitive->SetCollisionEnabled(NewType);
     }
   }
 }
 
+void UCesiumGltfComponent::SetTileVisible(bool Visible) {
+  if (this->IsVisible() == Visible) {
+    return;
+  }
+
+  this->SetVisibility(Visible, false);
+  this->setPrimitivesVisible(Visible);
+}
+
+void UCesiumGltfComponent::ApplyCollisionSettings(
+    const FBodyInstance& BodyInstance,
+    uint32 SettingsVersion) {
+  // Deferred primitives get the settings once they are created.
+  if (this->_pDeferred ||
+      this->_collisionSettingsVersion == SettingsVersion) {
+    return;
+  }
+  this->_collisionSettingsVersion = SettingsVersion;
+
+  ECollisionChannel objectType = BodyInstance.GetObjectType();
+  const FCollisionResponseContainer& responses =
+      BodyInstance.GetResponseToChannels();
+
+  for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
+    if (pPrimitive) {
+      if (pPrimitive->GetCollisionObjectType() != objectType) {
+        pPrimitive->SetCollisionObjectType(objectType);
+      }
+      pPrimitive->SetCollisionResponseToChannels(responses);
+    }
+  }
+}
+
+void UCesiumGltfComponent::SetFadePercentage(float Percentage) {
+  if (this->_fadePercentage == Percentage) {
+    return;
+  }
+  this->_fadePercentage = Percentage;
+
+  for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
+    if (!pPrimitive) {
+      continue;
+    }
+
+    UMaterialInstanceDynamic* pMaterial =
+        Cast<UMaterialInstanceDynamic>(pPrimitive->GetMaterial(0));
+    if (pMaterial) {
+      pMaterial->SetScalarParameterValue("FadePercentage", Percentage);
+    }
+  }
+}
+
+void UCesiumGltfComponent::setPrimitivesVisible(bool Visible) {
+  ECollisionEnabled::Type collisionEnabled =
+      Visible ? ECollisionEnabled::QueryAndPhysics
+              : ECollisionEnabled::NoCollision;
+
+  for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
+    if (pPrimitive) {
+      pPrimitive->SetVisibility(Visible, false);
+      pPrimitive->SetCollisionEnabled(collisionEnabled);
+    }
+  }
+}
+
+void UCesiumGltfComponent::computeMemoryUsage() {
+  FCesiumTilesetMemoryUsage usage;
+  TSet<UTexture*> textures;
+
+  for (USceneComponent* pSceneComponent : this->GetAttachChildren()) {
+    UStaticMeshComponent* pPrimitive =
+        Cast<UStaticMeshComponent>(pSceneComponent);
+    if (!pPrimitive) {
+      continue;
+    }
+
+    UStaticMesh* pStaticMesh = pPrimitive->GetStaticMesh();
+    if (pStaticMesh) {
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION < 27
+      const FStaticMeshRenderData* pRenderData = pStaticMesh->RenderData.Get();
+#else
+      const FStaticMeshRenderData* pRenderData = pStaticMesh->GetRenderData();
+#endif
+      if (pRenderData) {
+        FResourceSizeEx renderDataSize(EResourceSizeMode::Exclusive);
+        pRenderData->GetResourceSizeEx(renderDataSize);
+        usage.GeometryBytes += renderDataSize.GetTotalMemoryBytes();
+      }
+
+      UBodySetup* pBodySetup = pStaticMesh->BodySetup;
+      if (pBodySetup) {
+        usage.PhysicsBytes +=
+            pBodySetup->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+      }
+    }
+
+    if (UInstancedStaticMeshComponent* pInstanced =
+            Cast<UInstancedStaticMeshComponent>(pPrimitive)) {
+      usage.GeometryBytes += pInstanced->PerInstanceSMData.GetAllocatedSize();
+    }
+
+    // The same texture may be a parameter of several materials, so each one
+    // is only counted once. The shared transparent texture that stands in for
+    // missing raster overlays does not belong to this tile.
+    UMaterialInstanceDynamic* pMaterial =
+        Cast<UMaterialInstanceDynamic>(pPrimitive->GetMaterial(0));
+    if (pMaterial) {
+      for (const FTextureParameterValue& parameter :
+           pMaterial->TextureParameterValues) {
+        UTexture* pTexture = parameter.ParameterValue;
+        if (pTexture && pTexture != this->Transparent1x1) {
+          textures.Add(pTexture);
+        }
+      }
+    }
+  }
+
+  for (UTexture* pTexture : textures) {
+    usage.TextureBytes += pTexture->CalcTextureMemorySizeEnum(TMC_AllMips);
+  }
+
+  this->_memoryUsage = usage;
+}
+
 #if !PHYSICS_INTERFACE_PHYSX
 // This is copied from FChaosDerivedDataCooker::BuildTriangleMeshes in
 // C:\Program Files\Epic
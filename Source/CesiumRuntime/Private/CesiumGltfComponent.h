@@ -2,13 +2,16 @@
 
 #pragma once
 
+#include "CesiumTilesetMemoryUsage.h"
 #include "Components/PrimitiveComponent.h"
 #include "Components/SceneComponent.h"
 #include "CoreMinimal.h"
 #include "CustomDepthParameters.h"
 #include "Interfaces/IHttpRequest.h"
 #include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
 #include <memory>
+#include <vector>
 #include "CesiumGltfComponent.generated.h"
 
 class UMaterialInterface;
@@ -55,6 +58,13 @@ public:
   class HalfConstructed {
   public:
     virtual ~HalfConstructed() = default;
+
+    /**
+     * Gets the memory used by the render data, textures and collision meshes
+     * that were created off the game thread, before they are handed over to
+     * Unreal objects.
+     */
+    virtual const FCesiumTilesetMemoryUsage& GetMemoryUsage() const = 0;
   };
 
   static std::unique_ptr<HalfConstructed> CreateOffGameThread(
@@ -65,14 +75,30 @@ public:
   static UCesiumGltfComponent* CreateOnGameThread(
       AActor* ParentActor,
       std::unique_ptr<HalfConstructed> HalfConstructed,
-      const glm::dmat4x4& CesiumToUnrealTransform,
+      const glm::dmat4x4& CesiumToAnchorTransform,
       UMaterialInterface* BaseMaterial,
       UMaterialInterface* BaseWaterMaterial,
       FCustomDepthParameters CustomDepthParameters);
 
+  /**
+   * Creates the component of a tile without its primitives, which keeps the
+   * result of CreateOffGameThread until CreateDeferredPrimitives is called
+   * when the tile is first shown.
+   *
+   * Tiles that the camera has moved away from by the time they are loaded are
+   * often unloaded without ever being shown. Deferring the primitives means
+   * that no meshes, materials, textures and collision meshes are created for
+   * them in the game thread. Returns nullptr if the tile has no primitives.
+   */
+  static UCesiumGltfComponent* CreateDeferredOnGameThread(
+      AActor* ParentActor,
+      std::unique_ptr<HalfConstructed> HalfConstructed);
+
   UCesiumGltfComponent();
   virtual ~UCesiumGltfComponent();
 
+  virtual void BeginDestroy() override;
+
   UPROPERTY(EditAnywhere, Category = "Cesium")
   UMaterialInterface* BaseMaterial;
 
@@ -82,7 +108,25 @@ public:
   UPROPERTY(EditAnywhere, Category = "Rendering")
   FCustomDepthParameters CustomDepthParameters;
 
-  void UpdateTransformFromCesium(const glm::dmat4& CesiumToUnrealTransform);
+  /**
+   * Whether this tile was created with CreateDeferredOnGameThread and its
+   * primitives have not been created yet.
+   */
+  bool HasDeferredPrimitives() const { return this->_pDeferred != nullptr; }
+
+  /**
+   * Creates the primitives of a tile that was created with
+   * CreateDeferredOnGameThread, attaching the raster overlay tiles that were
+   * attached to it in the meantime. The primitives are hidden, like the
+   * primitives of a tile created with CreateOnGameThread.
+   */
+  void CreateDeferredPrimitives(
+      const glm::dmat4x4& CesiumToAnchorTransform,
+      UMaterialInterface* BaseMaterial,
+      UMaterialInterface* BaseWaterMaterial,
+      FCustomDepthParameters CustomDepthParameters);
+
+  void UpdateTransformFromCesium(const glm::dmat4& CesiumToAnchorTransform);
 
   void AttachRasterTile(
       const Cesium3DTilesSelection::Tile& Tile,
@@ -100,7 +144,76 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Collision")
   virtual void SetCollisionEnabled(ECollisionEnabled::Type NewType);
 
+  /**
+   * Shows or hides this tile, enabling collision for it while it is shown.
+   *
+   * The primitives are updated in a single pass, without propagating the
+   * change through the scene component hierarchy. Nothing is done if the tile
+   * already has the requested visibility.
+   */
+  void SetTileVisible(bool Visible);
+
+  /**
+   * Applies the collision object type and the collision responses of the
+   * given body instance to the primitives of this tile.
+   *
+   * The settings are only applied if they have a different version than the
+   * ones applied last, so that they are not applied every frame.
+   */
+  void ApplyCollisionSettings(
+      const FBodyInstance& BodyInstance,
+      uint32 SettingsVersion);
+
+  /**
+   * Sets the "FadePercentage" parameter of the materials of this tile's
+   * primitives, which a material can use to dither the tile in and out during
+   * level-of-detail transitions. 0.0 is fully faded out and 1.0 is fully
+   * visible.
+   */
+  void SetFadePercentage(float Percentage);
+
+  float GetFadePercentage() const { return this->_fadePercentage; }
+
+  /**
+   * Gets the memory used by the geometry, textures and collision meshes of
+   * this tile's primitives. The textures of attached raster overlay tiles are
+   * not included, because they are owned by the raster overlays. While the
+   * primitives are deferred, this is the memory of the result of
+   * CreateOffGameThread that they will be created from.
+   */
+  const FCesiumTilesetMemoryUsage& GetMemoryUsage() const {
+    return this->_memoryUsage;
+  }
+
 private:
+  // A raster overlay tile that was attached while the primitives were
+  // deferred.
+  struct PendingRasterTile {
+    const Cesium3DTilesSelection::Tile* pTile;
+    const Cesium3DTilesSelection::RasterOverlayTile* pRasterTile;
+    UTexture2D* pTexture;
+    glm::dvec2 translation;
+    glm::dvec2 scale;
+    int32_t textureCoordinateID;
+  };
+
   UPROPERTY()
   UTexture2D* Transparent1x1;
+
+  // The result of CreateOffGameThread while the primitives are deferred.
+  std::unique_ptr<HalfConstructed> _pDeferred;
+  std::vector<PendingRasterTile> _pendingRasterTiles;
+
+  // The version of the collision settings applied last, or 0 if none were.
+  uint32 _collisionSettingsVersion = 0;
+
+  float _fadePercentage = 1.0f;
+
+  // The memory used by this tile, which is taken from the result of
+  // CreateOffGameThread while the primitives are deferred and computed when
+  // they are created.
+  FCesiumTilesetMemoryUsage _memoryUsage;
+
+  void computeMemoryUsage();
+  void setPrimitivesVisible(bool Visible);
 };
@@ -13,30 +13,20 @@ UCesiumGltfPrimitiveComponent::UCesiumGltfPrimitiveComponent() {
   // every frame.  You can turn these features off to improve performance if you
   // don't need them.
   PrimaryComponentTick.bCanEverTick = false;
-  pModel = nullptr;
-  pMeshPrimitive = nullptr;
 }
 
 UCesiumGltfPrimitiveComponent::~UCesiumGltfPrimitiveComponent() {}
 
-void UCesiumGltfPrimitiveComponent::UpdateTransformFromCesium(
-    const glm::dmat4& CesiumToUnrealTransform) {
-  this->SetUsingAbsoluteLocation(true);
-  this->SetUsingAbsoluteRotation(true);
-  this->SetUsingAbsoluteScale(true);
-
-  const glm::dmat4x4& transform =
-      CesiumToUnrealTransform * this->HighPrecisionNodeTransform;
+namespace {
 
-  this->SetRelativeTransform(FTransform(FMatrix(
+FTransform createTransform(const glm::dmat4x4& transform) {
+  return FTransform(FMatrix(
       FVector(transform[0].x, transform[0].y, transform[0].z),
       FVector(transform[1].x, transform[1].y, transform[1].z),
       FVector(transform[2].x, transform[2].y, transform[2].z),
-      FVector(transform[3].x, transform[3].y, transform[3].z))));
+      FVector(transform[3].x, transform[3].y, transform[3].z)));
 }
 
-namespace {
-
 void destroyMaterialTexture(
     UMaterialInstanceDynamic* pMaterial,
     const char* name,
@@ -72,13 +62,16 @@ void destroyWaterParameterValues(
   destroyMaterialTexture(pMaterial, "WaterMask", assocation, index);
 }
 
-} // namespace
-
-void UCesiumGltfPrimitiveComponent::BeginDestroy() {
-  // This should mirror the logic in loadModelGameThreadPart in
-  // CesiumGltfComponent.cpp
+/**
+ * Destroys the material, textures, mesh and body setup that were created for
+ * a glTF primitive.
+ *
+ * This should mirror the logic in loadModelGameThreadPart in
+ * CesiumGltfComponent.cpp
+ */
+void destroyPrimitiveResources(UStaticMeshComponent* pComponent) {
   UMaterialInstanceDynamic* pMaterial =
-      Cast<UMaterialInstanceDynamic>(this->GetMaterial(0));
+      Cast<UMaterialInstanceDynamic>(pComponent->GetMaterial(0));
   if (pMaterial) {
 
     destroyGltfParameterValues(
@@ -116,7 +109,7 @@ void UCesiumGltfPrimitiveComponent::BeginDestroy() {
     CesiumLifetime::destroy(pMaterial);
   }
 
-  UStaticMesh* pMesh = this->GetStaticMesh();
+  UStaticMesh* pMesh = pComponent->GetStaticMesh();
   if (pMesh) {
     if (pMesh->BodySetup) {
       CesiumLifetime::destroy(pMesh->BodySetup);
@@ -124,6 +117,48 @@ void UCesiumGltfPrimitiveComponent::BeginDestroy() {
 
     CesiumLifetime::destroy(pMesh);
   }
+}
+
+} // namespace
 
+void UCesiumGltfPrimitiveComponent::UpdateTransformFromCesium(
+    const glm::dmat4& CesiumToAnchorTransform) {
+  this->SetRelativeTransform(createTransform(
+      CesiumToAnchorTransform * this->HighPrecisionNodeTransform));
+}
+
+void UCesiumGltfPrimitiveComponent::BeginDestroy() {
+  destroyPrimitiveResources(this);
   Super::BeginDestroy();
 }
+
+UCesiumGltfInstancedComponent::UCesiumGltfInstancedComponent() {
+  PrimaryComponentTick.bCanEverTick = false;
+}
+
+UCesiumGltfInstancedComponent::~UCesiumGltfInstancedComponent() {}
+
+void UCesiumGltfInstancedComponent::UpdateTransformFromCesium(
+    const glm::dmat4& CesiumToAnchorTransform) {
+  TArray<FTransform> transforms;
+  transforms.Reserve(this->HighPrecisionInstanceTransforms.size());
+  for (const glm::dmat4x4& instanceTransform :
+       this->HighPrecisionInstanceTransforms) {
+    transforms.Add(createTransform(CesiumToAnchorTransform * instanceTransform));
+  }
+
+  if (this->GetInstanceCount() == transforms.Num()) {
+    this->BatchUpdateInstancesTransforms(0, transforms, false, true, true);
+  } else {
+    this->ClearInstances();
+    for (const FTransform& transform : transforms) {
+      this->AddInstance(transform);
+    }
+  }
+}
+
+void UCesiumGltfInstancedComponent::BeginDestroy() {
+  destroyPrimitiveResources(this);
+  Super::BeginDestroy();
+}
+
@@ -6,13 +6,50 @@
 #include "CesiumGltf/Model.h"
 #include "CesiumMetadataPrimitive.h"
 #include "CesiumRasterOverlays.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "CoreMinimal.h"
+#include "UObject/Interface.h"
 #include <glm/mat4x4.hpp>
+#include <vector>
 #include "CesiumGltfPrimitiveComponent.generated.h"
 
+UINTERFACE(meta = (CannotImplementInterfaceInBlueprint))
+class UCesiumGltfPrimitive : public UInterface {
+  GENERATED_BODY()
+};
+
+/**
+ * The state shared by the components of glTF primitives, whether their mesh
+ * is drawn once or as instances.
+ */
+class ICesiumGltfPrimitive {
+  GENERATED_BODY()
+
+public:
+  FCesiumMetadataPrimitive Metadata;
+
+  const CesiumGltf::Model* pModel = nullptr;
+
+  const CesiumGltf::MeshPrimitive* pMeshPrimitive = nullptr;
+
+  OverlayTextureCoordinateIDMap overlayTextureCoordinateIDToUVIndex;
+
+  /**
+   * Updates the component's transform from a new double-precision
+   * transformation from the Cesium world to the tile anchor of the tileset
+   * that the component belongs to, as well as the component's own
+   * double-precision transformations.
+   *
+   * @param CesiumToAnchorTransform The new transformation.
+   */
+  virtual void
+  UpdateTransformFromCesium(const glm::dmat4& CesiumToAnchorTransform) = 0;
+};
+
 UCLASS()
-class UCesiumGltfPrimitiveComponent : public UStaticMeshComponent {
+class UCesiumGltfPrimitiveComponent : public UStaticMeshComponent,
+                                      public ICesiumGltfPrimitive {
   GENERATED_BODY()
 
 public:
@@ -20,27 +57,41 @@ public:
   UCesiumGltfPrimitiveComponent();
   virtual ~UCesiumGltfPrimitiveComponent();
 
-  FCesiumMetadataPrimitive Metadata;
-
-  const CesiumGltf::Model* pModel;
-
-  const CesiumGltf::MeshPrimitive* pMeshPrimitive;
-
   /**
    * The double-precision transformation matrix for this glTF node.
    */
   glm::dmat4x4 HighPrecisionNodeTransform;
 
-  OverlayTextureCoordinateIDMap overlayTextureCoordinateIDToUVIndex;
+  virtual void
+  UpdateTransformFromCesium(const glm::dmat4& CesiumToAnchorTransform) override;
+
+  virtual void BeginDestroy() override;
+};
+
+/**
+ * A glTF primitive whose mesh is referenced by several nodes of the same
+ * model. The mesh is loaded only once, and drawn once for each node as an
+ * instance.
+ */
+UCLASS()
+class UCesiumGltfInstancedComponent : public UInstancedStaticMeshComponent,
+                                      public ICesiumGltfPrimitive {
+  GENERATED_BODY()
+
+public:
+  UCesiumGltfInstancedComponent();
+  virtual ~UCesiumGltfInstancedComponent();
 
   /**
-   * Updates this component's transform from a new double-precision
-   * transformation from the Cesium world to the Unreal Engine world, as well as
-   * the current HighPrecisionNodeTransform.
-   *
-   * @param CesiumToUnrealTransform The new transformation.
+   * The double-precision transformation matrices of the glTF nodes that
+   * reference this primitive's mesh, one for each instance. None of them
+   * mirror the mesh, because the instances are drawn with the winding order
+   * of the component.
    */
-  void UpdateTransformFromCesium(const glm::dmat4& CesiumToUnrealTransform);
+  std::vector<glm::dmat4x4> HighPrecisionInstanceTransforms;
+
+  virtual void
+  UpdateTransformFromCesium(const glm::dmat4& CesiumToAnchorTransform) override;
 
   virtual void BeginDestroy() override;
 };
@@ -0,0 +1,459 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumMeshBenchmarkCommandlet.h"
+#include "CesiumGltf/Model.h"
+#include "CesiumGltfComponent.h"
+#include "CesiumMeshBuildTimer.h"
+#include "CesiumRuntime.h"
+#include "CesiumTextureUtility.h"
+#include "CreateModelOptions.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/**
+ * The width and height of the textures of the meshes. They are small, so that
+ * loading the textures does not dominate the time to load a mesh.
+ */
+constexpr int32 meshTextureSize = 64;
+
+/**
+ * The vertex attributes and textures of a synthetic mesh.
+ */
+struct MeshVariant {
+  const TCHAR* name;
+  bool normals;
+  bool tangents;
+  bool normalMap;
+  bool vertexColors;
+  int32 textureCoordinateSets;
+};
+
+// Without normals, flat normals are computed. With a normal map but without
+// tangents, the tangent space is computed.
+const MeshVariant meshVariants[] = {
+    {TEXT("positions"), false, false, false, false, 0},
+    {TEXT("normals"), true, false, false, false, 0},
+    {TEXT("vertexColors"), true, false, false, true, 0},
+    {TEXT("textured"), true, false, false, false, 2},
+    {TEXT("normalMap"), true, false, true, false, 1},
+    {TEXT("normalMapWithTangents"), true, true, true, false, 1}};
+
+template <typename T>
+int32_t addAccessor(
+    CesiumGltf::Model& model,
+    const std::vector<T>& values,
+    int32_t componentType,
+    const std::string& type,
+    int64_t count,
+    bool normalized = false) {
+  std::vector<std::byte>& data = model.buffers[0].cesium.data;
+  size_t byteOffset = data.size();
+  size_t byteLength = values.size() * sizeof(T);
+
+  // Keep the start of each buffer view aligned to four bytes.
+  data.resize(byteOffset + ((byteLength + 3) & ~size_t(3)));
+  std::memcpy(data.data() + byteOffset, values.data(), byteLength);
+  model.buffers[0].byteLength = int64_t(data.size());
+
+  CesiumGltf::BufferView& bufferView = model.bufferViews.emplace_back();
+  bufferView.buffer = 0;
+  bufferView.byteOffset = int64_t(byteOffset);
+  bufferView.byteLength = int64_t(byteLength);
+
+  CesiumGltf::Accessor& accessor = model.accessors.emplace_back();
+  accessor.bufferView = int32_t(model.bufferViews.size() - 1);
+  accessor.componentType = componentType;
+  accessor.type = type;
+  accessor.count = count;
+  accessor.normalized = normalized;
+
+  return int32_t(model.accessors.size() - 1);
+}
+
+std::vector<uint32_t> createIndices(int32 gridSize, bool triangleStrip) {
+  std::vector<uint32_t> indices;
+  for (int32 y = 0; y < gridSize - 1; ++y) {
+    uint32_t row = uint32_t(y * gridSize);
+    uint32_t nextRow = row + uint32_t(gridSize);
+    if (triangleStrip) {
+      // Consecutive rows are joined by two degenerate triangles.
+      if (y > 0) {
+        indices.push_back(indices.back());
+        indices.push_back(row);
+      }
+      for (int32 x = 0; x < gridSize; ++x) {
+        indices.push_back(row + uint32_t(x));
+        indices.push_back(nextRow + uint32_t(x));
+      }
+    } else {
+      for (int32 x = 0; x < gridSize - 1; ++x) {
+        uint32_t corner = row + uint32_t(x);
+        indices.insert(
+            indices.end(),
+            {corner,
+             corner + 1,
+             nextRow + uint32_t(x),
+             corner + 1,
+             nextRow + uint32_t(x) + 1,
+             nextRow + uint32_t(x)});
+      }
+    }
+  }
+  return indices;
+}
+
+int32_t addTexture(CesiumGltf::Model& model, int32 size) {
+  CesiumGltf::Image& image = model.images.emplace_back();
+  image.cesium.width = size;
+  image.cesium.height = size;
+  image.cesium.channels = 4;
+  image.cesium.bytesPerChannel = 1;
+  image.cesium.pixelData.resize(size_t(size) * size_t(size) * 4);
+  for (size_t i = 0; i < image.cesium.pixelData.size(); ++i) {
+    image.cesium.pixelData[i] = static_cast<std::byte>(uint8_t(i * 7));
+  }
+
+  if (model.samplers.empty()) {
+    CesiumGltf::Sampler& sampler = model.samplers.emplace_back();
+    sampler.minFilter = CesiumGltf::Sampler::MinFilter::LINEAR_MIPMAP_LINEAR;
+    sampler.magFilter = CesiumGltf::Sampler::MagFilter::LINEAR;
+  }
+
+  CesiumGltf::Texture& texture = model.textures.emplace_back();
+  texture.source = int32_t(model.images.size() - 1);
+  texture.sampler = 0;
+
+  return int32_t(model.textures.size() - 1);
+}
+
+/**
+ * Creates a model with a single primitive that is a grid of gridSize by
+ * gridSize vertices, with a little relief so that its normals vary.
+ */
+CesiumGltf::Model
+createMesh(const MeshVariant& variant, int32 gridSize, bool triangleStrip) {
+  CesiumGltf::Model model;
+  model.buffers.emplace_back();
+
+  CesiumGltf::Mesh& mesh = model.meshes.emplace_back();
+  CesiumGltf::MeshPrimitive& primitive = mesh.primitives.emplace_back();
+  primitive.mode = triangleStrip
+                       ? CesiumGltf::MeshPrimitive::Mode::TRIANGLE_STRIP
+                       : CesiumGltf::MeshPrimitive::Mode::TRIANGLES;
+  primitive.material = 0;
+
+  int64_t vertexCount = int64_t(gridSize) * int64_t(gridSize);
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> tangents;
+  std::vector<uint8_t> colors;
+  std::vector<float> textureCoordinates;
+  for (int32 y = 0; y < gridSize; ++y) {
+    for (int32 x = 0; x < gridSize; ++x) {
+      float height = std::sin(x * 0.1f) * std::cos(y * 0.1f);
+      positions.insert(positions.end(), {float(x), float(y), height});
+      normals.insert(normals.end(), {0.0f, 0.0f, 1.0f});
+      tangents.insert(tangents.end(), {1.0f, 0.0f, 0.0f, 1.0f});
+      colors.insert(
+          colors.end(),
+          {uint8_t(x), uint8_t(y), uint8_t(x + y), uint8_t(255)});
+      textureCoordinates.insert(
+          textureCoordinates.end(),
+          {float(x) / float(gridSize - 1), float(y) / float(gridSize - 1)});
+    }
+  }
+
+  int32_t positionAccessor = addAccessor(
+      model,
+      positions,
+      CesiumGltf::Accessor::ComponentType::FLOAT,
+      CesiumGltf::Accessor::Type::VEC3,
+      vertexCount);
+  model.accessors[positionAccessor].min = {0.0, 0.0, -1.0};
+  model.accessors[positionAccessor].max =
+      {double(gridSize - 1), double(gridSize - 1), 1.0};
+  primitive.attributes["POSITION"] = positionAccessor;
+
+  if (variant.normals) {
+    primitive.attributes["NORMAL"] = addAccessor(
+        model,
+        normals,
+        CesiumGltf::Accessor::ComponentType::FLOAT,
+        CesiumGltf::Accessor::Type::VEC3,
+        vertexCount);
+  }
+
+  if (variant.tangents) {
+    primitive.attributes["TANGENT"] = addAccessor(
+        model,
+        tangents,
+        CesiumGltf::Accessor::ComponentType::FLOAT,
+        CesiumGltf::Accessor::Type::VEC4,
+        vertexCount);
+  }
+
+  if (variant.vertexColors) {
+    primitive.attributes["COLOR_0"] = addAccessor(
+        model,
+        colors,
+        CesiumGltf::Accessor::ComponentType::UNSIGNED_BYTE,
+        CesiumGltf::Accessor::Type::VEC4,
+        vertexCount,
+        true);
+  }
+
+  for (int32 i = 0; i < variant.textureCoordinateSets; ++i) {
+    primitive.attributes["TEXCOORD_" + std::to_string(i)] = addAccessor(
+        model,
+        textureCoordinates,
+        CesiumGltf::Accessor::ComponentType::FLOAT,
+        CesiumGltf::Accessor::Type::VEC2,
+        vertexCount);
+  }
+
+  std::vector<uint32_t> indices = createIndices(gridSize, triangleStrip);
+  if (vertexCount <= std::numeric_limits<uint16_t>::max()) {
+    primitive.indices = addAccessor(
+        model,
+        std::vector<uint16_t>(indices.begin(), indices.end()),
+        CesiumGltf::Accessor::ComponentType::UNSIGNED_SHORT,
+        CesiumGltf::Accessor::Type::SCALAR,
+        int64_t(indices.size()));
+  } else {
+    primitive.indices = addAccessor(
+        model,
+        indices,
+        CesiumGltf::Accessor::ComponentType::UNSIGNED_INT,
+        CesiumGltf::Accessor::Type::SCALAR,
+        int64_t(indices.size()));
+  }
+
+  CesiumGltf::Material& material = model.materials.emplace_back();
+  CesiumGltf::MaterialPBRMetallicRoughness& pbr =
+      material.pbrMetallicRoughness.emplace();
+  if (variant.textureCoordinateSets > 0) {
+    pbr.baseColorTexture.emplace();
+    pbr.baseColorTexture->index = addTexture(model, meshTextureSize);
+    pbr.baseColorTexture->texCoord = 0;
+  }
+  if (variant.textureCoordinateSets > 1) {
+    material.occlusionTexture.emplace();
+    material.occlusionTexture->index = addTexture(model, meshTextureSize);
+    material.occlusionTexture->texCoord = 1;
+  }
+  if (variant.normalMap) {
+    material.normalTexture.emplace();
+    material.normalTexture->index = addTexture(model, meshTextureSize);
+    material.normalTexture->texCoord = 0;
+  }
+
+  return model;
+}
+
+TSharedRef<FJsonObject> benchmarkMesh(
+    const MeshVariant& variant,
+    int32 gridSize,
+    bool triangleStrip,
+    int32 iterations) {
+  CesiumGltf::Model model = createMesh(variant, gridSize, triangleStrip);
+  CreateModelOptions options;
+
+  CesiumMeshBuildTimer timer;
+
+  // Warm up once, so that the allocations of the first load are not measured.
+  UCesiumGltfComponent::CreateOffGameThread(model, glm::dmat4(1.0), options);
+  timer.reset();
+
+  double seconds = 0.0;
+  for (int32 i = 0; i < iterations; ++i) {
+    double startTime = FPlatformTime::Seconds();
+    std::unique_ptr<UCesiumGltfComponent::HalfConstructed> pResult =
+        UCesiumGltfComponent::CreateOffGameThread(
+            model,
+            glm::dmat4(1.0),
+            options);
+    seconds += FPlatformTime::Seconds() - startTime;
+  }
+
+  double vertices = double(gridSize) * double(gridSize);
+  double nanosecondsPerVertex = 1e9 / (vertices * double(iterations));
+
+  TSharedRef<FJsonObject> pStages = MakeShared<FJsonObject>();
+  for (size_t i = 0; i < size_t(CesiumMeshBuildTimer::Stage::Count); ++i) {
+    CesiumMeshBuildTimer::Stage stage = CesiumMeshBuildTimer::Stage(i);
+    double stageSeconds = timer.getSeconds(stage);
+    if (stageSeconds > 0.0) {
+      pStages->SetNumberField(
+          CesiumMeshBuildTimer::getStageName(stage),
+          stageSeconds * nanosecondsPerVertex);
+    }
+  }
+
+  TSharedRef<FJsonObject> pResult = MakeShared<FJsonObject>();
+  pResult->SetStringField(TEXT("variant"), variant.name);
+  pResult->SetStringField(
+      TEXT("topology"),
+      triangleStrip ? TEXT("triangleStrip") : TEXT("triangles"));
+  pResult->SetNumberField(TEXT("vertices"), vertices);
+  pResult->SetNumberField(
+      TEXT("nanosecondsPerVertex"),
+      seconds * nanosecondsPerVertex);
+  pResult->SetObjectField(TEXT("stageNanosecondsPerVertex"), pStages);
+  return pResult;
+}
+
+double benchmarkTextureSeconds(
+    const CesiumGltf::ImageCesium& image,
+    TextureFilter filter,
+    int32 iterations) {
+  double seconds = 0.0;
+  for (int32 i = 0; i < iterations; ++i) {
+    double startTime = FPlatformTime::Seconds();
+    CesiumTextureUtility::LoadedTextureResult* pResult =
+        CesiumTextureUtility::loadTextureAnyThreadPart(
+            image,
+            TextureAddress::TA_Wrap,
+            TextureAddress::TA_Wrap,
+            filter);
+    seconds += FPlatformTime::Seconds() - startTime;
+
+    if (pResult) {
+      delete pResult->pTextureData;
+      delete pResult;
+    }
+  }
+  return seconds;
+}
+
+TSharedRef<FJsonObject> benchmarkTexture(int32 size, int32 iterations) {
+  CesiumGltf::Model model;
+  addTexture(model, size);
+  const CesiumGltf::ImageCesium& image = model.images[0].cesium;
+
+  double copySeconds =
+      benchmarkTextureSeconds(image, TextureFilter::TF_Bilinear, iterations);
+  double mipmapSeconds =
+      benchmarkTextureSeconds(image, TextureFilter::TF_Trilinear, iterations);
+
+  double texels = double(size) * double(size);
+  double nanosecondsPerTexel = 1e9 / (texels * double(iterations));
+
+  TSharedRef<FJsonObject> pResult = MakeShared<FJsonObject>();
+  pResult->SetNumberField(TEXT("size"), size);
+  pResult->SetNumberField(
+      TEXT("copyNanosecondsPerTexel"),
+      copySeconds * nanosecondsPerTexel);
+  pResult->SetNumberField(
+      TEXT("copyAndMipmapsNanosecondsPerTexel"),
+      mipmapSeconds * nanosecondsPerTexel);
+  return pResult;
+}
+
+TArray<int32> parseSizes(const FString& Params, const TCHAR* name) {
+  TArray<int32> sizes;
+  FString value;
+  if (FParse::Value(*Params, name, value)) {
+    TArray<FString> parts;
+    value.ParseIntoArray(parts, TEXT(","));
+    for (const FString& part : parts) {
+      int32 size = FCString::Atoi(*part);
+      if (size >= 2) {
+        sizes.Add(size);
+      }
+    }
+  }
+  return sizes;
+}
+
+} // namespace
+
+UCesiumMeshBenchmarkCommandlet::UCesiumMeshBenchmarkCommandlet() {
+  this->IsClient = false;
+  this->IsServer = false;
+  this->IsEditor = false;
+  this->LogToConsole = true;
+  this->HelpDescription = TEXT(
+      "Measures the time per vertex and per texel of building meshes and textures from glTF.");
+  this->HelpUsage = TEXT(
+      "-run=CesiumMeshBenchmark [-Output=result.json] [-GridSizes=32,128,512] [-TextureSizes=256,1024,2048] [-Iterations=10]");
+}
+
+int32 UCesiumMeshBenchmarkCommandlet::Main(const FString& Params) {
+  FString outputPath = FPaths::Combine(
+      FPaths::ProjectSavedDir(),
+      TEXT("CesiumMeshBenchmark.json"));
+  FParse::Value(*Params, TEXT("Output="), outputPath);
+
+  TArray<int32> gridSizes = parseSizes(Params, TEXT("GridSizes="));
+  if (gridSizes.Num() == 0) {
+    gridSizes = {32, 128, 512};
+  }
+
+  TArray<int32> textureSizes = parseSizes(Params, TEXT("TextureSizes="));
+  if (textureSizes.Num() == 0) {
+    textureSizes = {256, 1024, 2048};
+  }
+
+  int32 iterations = 10;
+  FParse::Value(*Params, TEXT("Iterations="), iterations);
+  iterations = FMath::Max(iterations, 1);
+
+  TArray<TSharedPtr<FJsonValue>> meshes;
+  for (int32 gridSize : gridSizes) {
+    for (const MeshVariant& variant : meshVariants) {
+      for (bool triangleStrip : {false, true}) {
+        UE_LOG(
+            LogCesium,
+            Display,
+            TEXT("Benchmarking mesh %s (%s) with %dx%d vertices"),
+            variant.name,
+            triangleStrip ? TEXT("triangle strip") : TEXT("triangles"),
+            gridSize,
+            gridSize);
+        meshes.Add(MakeShared<FJsonValueObject>(
+            benchmarkMesh(variant, gridSize, triangleStrip, iterations)));
+      }
+    }
+  }
+
+  TArray<TSharedPtr<FJsonValue>> textures;
+  for (int32 textureSize : textureSizes) {
+    UE_LOG(
+        LogCesium,
+        Display,
+        TEXT("Benchmarking texture with %dx%d texels"),
+        textureSize,
+        textureSize);
+    textures.Add(MakeShared<FJsonValueObject>(
+        benchmarkTexture(textureSize, iterations)));
+  }
+
+  TSharedRef<FJsonObject> pResult = MakeShared<FJsonObject>();
+  pResult->SetNumberField(TEXT("iterations"), iterations);
+  pResult->SetArrayField(TEXT("meshes"), meshes);
+  pResult->SetArrayField(TEXT("textures"), textures);
+
+  FString json;
+  TSharedRef<TJsonWriter<>> pWriter = TJsonWriterFactory<>::Create(&json);
+  FJsonSerializer::Serialize(pResult, pWriter);
+
+  UE_LOG(LogCesium, Display, TEXT("%s"), *json);
+
+  if (!FFileHelper::SaveStringToFile(json, *outputPath)) {
+    UE_LOG(LogCesium, Error, TEXT("Could not write %s"), *outputPath);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,40 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+#include "CesiumMeshBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the stages of building meshes and textures from glTF, and writes
+ * the time per vertex and per texel of each to a JSON file.
+ *
+ * The meshes are synthetic grids built for each combination of topology
+ * (indexed triangles or an indexed triangle strip) and vertex attributes
+ * (positions only, normals, vertex colors, two texture coordinate sets with
+ * textures, a normal map with and without tangents). Each is loaded with
+ * CreateOffGameThread, timing the stages with a CesiumMeshBuildTimer. The
+ * textures are loaded with CesiumTextureUtility::loadTextureAnyThreadPart,
+ * with and without mipmaps. No GPU is needed:
+ *
+ *   UE4Editor-Cmd Project.uproject -run=CesiumMeshBenchmark -nullrhi
+ *     -Output=/path/to/result.json
+ *
+ * Optional parameters:
+ *   -GridSizes=<n,...>     The number of vertices along each side of the
+ *                          grids (32,128,512).
+ *   -TextureSizes=<n,...>  The width and height of the textures
+ *                          (256,1024,2048).
+ *   -Iterations=<n>        The number of times each mesh and texture is
+ *                          loaded (10).
+ */
+UCLASS()
+class UCesiumMeshBenchmarkCommandlet : public UCommandlet {
+  GENERATED_BODY()
+
+public:
+  UCesiumMeshBenchmarkCommandlet();
+
+  virtual int32 Main(const FString& Params) override;
+};
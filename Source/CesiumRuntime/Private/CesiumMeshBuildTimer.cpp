@@ -0,0 +1,63 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumMeshBuildTimer.h"
+#include "HAL/PlatformTime.h"
+
+thread_local CesiumMeshBuildTimer* CesiumMeshBuildTimer::_pActive = nullptr;
+
+/*static*/ const TCHAR*
+CesiumMeshBuildTimer::getStageName(Stage stage) noexcept {
+  switch (stage) {
+  case Stage::LoadPrimitive:
+    return TEXT("loadPrimitive");
+  case Stage::CopyIndices:
+    return TEXT("copyIndices");
+  case Stage::CopyPositions:
+    return TEXT("copyPositions");
+  case Stage::CopyColors:
+    return TEXT("copyColors");
+  case Stage::UpdateTextureCoordinates:
+    return TEXT("updateTextureCoordinates");
+  case Stage::CopyNormals:
+    return TEXT("copyNormals");
+  case Stage::ComputeFlatNormals:
+    return TEXT("computeFlatNormals");
+  case Stage::CopyTangents:
+    return TEXT("copyTangents");
+  case Stage::ComputeTangentSpace:
+    return TEXT("computeTangentSpace");
+  case Stage::ReverseWindingOrder:
+    return TEXT("reverseWindingOrder");
+  case Stage::LoadRenderData:
+    return TEXT("loadRenderData");
+  case Stage::LoadTextures:
+    return TEXT("loadTextures");
+  case Stage::CookCollision:
+    return TEXT("cookCollision");
+  default:
+    return TEXT("unknown");
+  }
+}
+
+CesiumMeshBuildTimer::Scope::Scope(Stage stage) noexcept
+    : _pTimer(CesiumMeshBuildTimer::_pActive),
+      _stage(stage),
+      _startTime(this->_pTimer ? FPlatformTime::Seconds() : 0.0) {}
+
+CesiumMeshBuildTimer::Scope::~Scope() noexcept {
+  if (this->_pTimer) {
+    this->_pTimer->_seconds[size_t(this->_stage)] +=
+        FPlatformTime::Seconds() - this->_startTime;
+  }
+}
+
+CesiumMeshBuildTimer::CesiumMeshBuildTimer() noexcept
+    : _pPrevious(CesiumMeshBuildTimer::_pActive), _seconds() {
+  CesiumMeshBuildTimer::_pActive = this;
+}
+
+CesiumMeshBuildTimer::~CesiumMeshBuildTimer() noexcept {
+  CesiumMeshBuildTimer::_pActive = this->_pPrevious;
+}
+
+void CesiumMeshBuildTimer::reset() noexcept { this->_seconds.fill(0.0); }
@@ -0,0 +1,100 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <array>
+
+/**
+ * @brief Measures the time spent in the stages of building meshes from glTF
+ * primitives on the thread that created it, while it is alive.
+ *
+ * The stages are timed by a {@link Scope} placed around them. A scope only
+ * reads the clock if a timer is active on the current thread, so the stages
+ * cost nothing extra while tiles are loaded normally. Stages may be nested, in
+ * which case the time of the inner stage is included in the outer one.
+ */
+class CesiumMeshBuildTimer {
+public:
+  /**
+   * @brief A stage of building meshes.
+   */
+  enum class Stage : uint8 {
+    /**
+     * @brief Gathering the vertices and indices of a primitive, including all
+     * of the stages up to and including ReverseWindingOrder.
+     */
+    LoadPrimitive,
+    CopyIndices,
+    CopyPositions,
+    CopyColors,
+    UpdateTextureCoordinates,
+    CopyNormals,
+    ComputeFlatNormals,
+    CopyTangents,
+    ComputeTangentSpace,
+    ReverseWindingOrder,
+
+    /**
+     * @brief Creating the render data of a primitive, including the stages
+     * LoadTextures and CookCollision.
+     */
+    LoadRenderData,
+    LoadTextures,
+    CookCollision,
+
+    Count
+  };
+
+  /**
+   * @brief Gets the name of a stage.
+   */
+  static const TCHAR* getStageName(Stage stage) noexcept;
+
+  /**
+   * @brief Measures the time until the end of the scope in the active timer
+   * of the current thread, if any.
+   */
+  class Scope {
+  public:
+    Scope(Stage stage) noexcept;
+    ~Scope() noexcept;
+
+  private:
+    CesiumMeshBuildTimer* _pTimer;
+    Stage _stage;
+    double _startTime;
+  };
+
+  /**
+   * @brief Starts timing the stages of the meshes built on the current thread.
+   */
+  CesiumMeshBuildTimer() noexcept;
+
+  /**
+   * @brief Stops timing, restoring the timer that was active before this one.
+   */
+  ~CesiumMeshBuildTimer() noexcept;
+
+  CesiumMeshBuildTimer(const CesiumMeshBuildTimer&) = delete;
+  CesiumMeshBuildTimer& operator=(const CesiumMeshBuildTimer&) = delete;
+
+  /**
+   * @brief Gets the time spent in a stage since this timer was created or
+   * reset, in seconds.
+   */
+  double getSeconds(Stage stage) const noexcept {
+    return this->_seconds[size_t(stage)];
+  }
+
+  /**
+   * @brief Resets the time of all stages to zero.
+   */
+  void reset() noexcept;
+
+private:
+  static thread_local CesiumMeshBuildTimer* _pActive;
+
+  CesiumMeshBuildTimer* _pPrevious;
+  std::array<double, size_t(Stage::Count)> _seconds;
+};
@@ -1,29 +1,39 @@
 #include "CesiumMetadataUtilityBlueprintLibrary.h"
 #include "CesiumGltfPrimitiveComponent.h"
 
+namespace {
+const FCesiumMetadataPrimitive*
+getMetadataPrimitive(const UPrimitiveComponent* component) {
+  if (!IsValid(component)) {
+    return nullptr;
+  }
+  const ICesiumGltfPrimitive* pGltfPrimitive =
+      Cast<ICesiumGltfPrimitive>(component);
+  return pGltfPrimitive ? &pGltfPrimitive->Metadata : nullptr;
+}
+} // namespace
+
 FCesiumMetadataPrimitive
 UCesiumMetadataUtilityBlueprintLibrary::GetPrimitiveMetadata(
     const UPrimitiveComponent* component) {
-  const UCesiumGltfPrimitiveComponent* pGltfComponent =
-      Cast<UCesiumGltfPrimitiveComponent>(component);
-  if (!IsValid(pGltfComponent)) {
+  const FCesiumMetadataPrimitive* pMetadata = getMetadataPrimitive(component);
+  if (!pMetadata) {
     return FCesiumMetadataPrimitive();
   }
 
-  return pGltfComponent->Metadata;
+  return *pMetadata;
 }
 
 TMap<FString, FCesiumMetadataGenericValue>
 UCesiumMetadataUtilityBlueprintLibrary::GetMetadataValuesForFace(
     const UPrimitiveComponent* component,
     int64 faceID) {
-  const UCesiumGltfPrimitiveComponent* pGltfComponent =
-      Cast<UCesiumGltfPrimitiveComponent>(component);
-  if (!IsValid(pGltfComponent)) {
+  const FCesiumMetadataPrimitive* pMetadata = getMetadataPrimitive(component);
+  if (!pMetadata) {
     return TMap<FString, FCesiumMetadataGenericValue>();
   }
 
-  const FCesiumMetadataPrimitive& metadata = pGltfComponent->Metadata;
+  const FCesiumMetadataPrimitive& metadata = *pMetadata;
   const TArray<FCesiumMetadataFeatureTable>& featureTables =
       UCesiumMetadataPrimitiveBlueprintLibrary::GetFeatureTables(metadata);
   if (featureTables.Num() == 0) {
@@ -44,13 +54,12 @@ TMap<FString, FString>
 UCesiumMetadataUtilityBlueprintLibrary::GetMetadataValuesAsStringForFace(
     const UPrimitiveComponent* component,
     int64 faceID) {
-  const UCesiumGltfPrimitiveComponent* pGltfComponent =
-      Cast<UCesiumGltfPrimitiveComponent>(component);
-  if (!IsValid(pGltfComponent)) {
+  const FCesiumMetadataPrimitive* pMetadata = getMetadataPrimitive(component);
+  if (!pMetadata) {
     return TMap<FString, FString>();
   }
 
-  const FCesiumMetadataPrimitive& metadata = pGltfComponent->Metadata;
+  const FCesiumMetadataPrimitive& metadata = *pMetadata;
   const TArray<FCesiumMetadataFeatureTable>& featureTables =
       UCesiumMetadataPrimitiveBlueprintLibrary::GetFeatureTables(metadata);
   if (featureTables.Num() == 0) {
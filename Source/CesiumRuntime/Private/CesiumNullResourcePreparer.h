@@ -0,0 +1,61 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/IPrepareRendererResources.h"
+
+/**
+ * @brief A renderer resource preparer that prepares nothing, for tilesets whose
+ * tiles are only loaded to bring their content into the request cache or a
+ * bundle, and are never rendered.
+ */
+class CesiumNullResourcePreparer
+    : public Cesium3DTilesSelection::IPrepareRendererResources {
+public:
+  virtual void* prepareInLoadThread(
+      const CesiumGltf::Model& /*model*/,
+      const glm::dmat4& /*transform*/) override {
+    return nullptr;
+  }
+
+  virtual void* prepareInMainThread(
+      Cesium3DTilesSelection::Tile& /*tile*/,
+      void* /*pLoadThreadResult*/) override {
+    return nullptr;
+  }
+
+  virtual void free(
+      Cesium3DTilesSelection::Tile& /*tile*/,
+      void* /*pLoadThreadResult*/,
+      void* /*pMainThreadResult*/) noexcept override {}
+
+  virtual void* prepareRasterInLoadThread(
+      const CesiumGltf::ImageCesium& /*image*/) override {
+    return nullptr;
+  }
+
+  virtual void* prepareRasterInMainThread(
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pLoadThreadResult*/) override {
+    return nullptr;
+  }
+
+  virtual void freeRaster(
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pLoadThreadResult*/,
+      void* /*pMainThreadResult*/) noexcept override {}
+
+  virtual void attachRasterInMainThread(
+      const Cesium3DTilesSelection::Tile& /*tile*/,
+      int32_t /*overlayTextureCoordinateID*/,
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pMainThreadRendererResources*/,
+      const glm::dvec2& /*translation*/,
+      const glm::dvec2& /*scale*/) override {}
+
+  virtual void detachRasterInMainThread(
+      const Cesium3DTilesSelection::Tile& /*tile*/,
+      int32_t /*overlayTextureCoordinateID*/,
+      const Cesium3DTilesSelection::RasterOverlayTile& /*rasterTile*/,
+      void* /*pMainThreadRendererResources*/) noexcept override {}
+};
@@ -0,0 +1,183 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumOcclusionTileExcluder.h"
+#include "Cesium3DTilesSelection/Tile.h"
+#include "CesiumBoundingVolumeComponent.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include <algorithm>
+
+CesiumOcclusionTileExcluder::CesiumOcclusionTileExcluder(
+    USceneComponent* pTileAnchor)
+    : _pTileAnchor(pTileAnchor),
+      _enabled(false),
+      _boundingVolumes(),
+      _unusedComponents() {}
+
+CesiumOcclusionTileExcluder::~CesiumOcclusionTileExcluder() { this->clear(); }
+
+void CesiumOcclusionTileExcluder::setEnabled(bool enabled) {
+  if (this->_enabled == enabled) {
+    return;
+  }
+
+  this->_enabled = enabled;
+  if (!enabled) {
+    this->clear();
+  }
+}
+
+bool CesiumOcclusionTileExcluder::updateOcclusion(
+    const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+    size_t renderedFrustumCount) {
+  USceneComponent* pTileAnchor = this->_pTileAnchor.Get();
+  UWorld* pWorld = pTileAnchor ? pTileAnchor->GetWorld() : nullptr;
+  if (!this->_enabled || !pWorld) {
+    return false;
+  }
+
+  const double time = pWorld->GetTimeSeconds();
+  renderedFrustumCount = std::min(renderedFrustumCount, frustums.size());
+
+  bool changed = false;
+  for (auto& entry : this->_boundingVolumes) {
+    BoundingVolume& boundingVolume = entry.second;
+
+    auto isInside = [&boundingVolume](
+                        const Cesium3DTilesSelection::ViewState& frustum) {
+      return frustum.isBoundingVolumeVisible(boundingVolume.tileBoundingVolume);
+    };
+    bool inRenderedView = std::any_of(
+        frustums.begin(),
+        frustums.begin() + renderedFrustumCount,
+        isInside);
+    bool inOtherView = std::any_of(
+        frustums.begin() + renderedFrustumCount,
+        frustums.end(),
+        isInside);
+
+    if (inRenderedView && !inOtherView) {
+      if (boundingVolume.inRenderedViewSince < 0.0) {
+        boundingVolume.inRenderedViewSince = time;
+      }
+    } else {
+      boundingVolume.inRenderedViewSince = -1.0;
+    }
+
+    UCesiumBoundingVolumeComponent* pComponent =
+        boundingVolume.pComponent.Get();
+    bool occluded = pComponent && boundingVolume.inRenderedViewSince >= 0.0 &&
+                    pComponent->IsOccluded(boundingVolume.inRenderedViewSince);
+    if (occluded != boundingVolume.occluded) {
+      boundingVolume.occluded = occluded;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void CesiumOcclusionTileExcluder::updateBoundingVolumes(
+    const std::vector<Cesium3DTilesSelection::Tile*>& tilesToRender,
+    const glm::dmat4& tilesetToTileAnchor) {
+  USceneComponent* pTileAnchor = this->_pTileAnchor.Get();
+  if (!this->_enabled || !pTileAnchor) {
+    this->clear();
+    return;
+  }
+
+  std::unordered_map<const Cesium3DTilesSelection::Tile*, BoundingVolume>
+      boundingVolumes;
+  boundingVolumes.reserve(tilesToRender.size());
+
+  for (Cesium3DTilesSelection::Tile* pTile : tilesToRender) {
+    auto it = this->_boundingVolumes.find(pTile);
+    if (it != this->_boundingVolumes.end() && it->second.pComponent.IsValid()) {
+      boundingVolumes.emplace(pTile, std::move(it->second));
+      this->_boundingVolumes.erase(it);
+      continue;
+    }
+
+    UCesiumBoundingVolumeComponent* pComponent =
+        this->acquireComponent(pTileAnchor);
+    pComponent->SetBoundingVolume(pTile->getBoundingVolume());
+    pComponent->UpdateTransformFromCesium(tilesetToTileAnchor);
+
+    boundingVolumes.emplace(
+        pTile,
+        BoundingVolume{pComponent, pTile->getBoundingVolume()});
+  }
+
+  // Occluded tiles are excluded, so they are not rendered, but keep their
+  // bounding volumes to find out when they become visible again. The bounding
+  // volumes of all other tiles that are no longer rendered are released.
+  for (auto& entry : this->_boundingVolumes) {
+    if (entry.second.occluded && entry.second.pComponent.IsValid()) {
+      boundingVolumes.emplace(entry.first, std::move(entry.second));
+    } else {
+      this->releaseComponent(entry.second.pComponent.Get());
+    }
+  }
+
+  this->_boundingVolumes = std::move(boundingVolumes);
+}
+
+void CesiumOcclusionTileExcluder::clear() {
+  for (auto& entry : this->_boundingVolumes) {
+    UCesiumBoundingVolumeComponent* pComponent = entry.second.pComponent.Get();
+    if (pComponent) {
+      pComponent->DestroyComponent();
+    }
+  }
+  this->_boundingVolumes.clear();
+
+  for (const TWeakObjectPtr<UCesiumBoundingVolumeComponent>& pUnused :
+       this->_unusedComponents) {
+    UCesiumBoundingVolumeComponent* pComponent = pUnused.Get();
+    if (pComponent) {
+      pComponent->DestroyComponent();
+    }
+  }
+  this->_unusedComponents.clear();
+}
+
+bool CesiumOcclusionTileExcluder::shouldExclude(
+    const Cesium3DTilesSelection::Tile& tile) const noexcept {
+  if (!this->_enabled) {
+    return false;
+  }
+
+  auto it = this->_boundingVolumes.find(&tile);
+  return it != this->_boundingVolumes.end() && it->second.occluded;
+}
+
+UCesiumBoundingVolumeComponent*
+CesiumOcclusionTileExcluder::acquireComponent(USceneComponent* pTileAnchor) {
+  while (!this->_unusedComponents.empty()) {
+    UCesiumBoundingVolumeComponent* pComponent =
+        this->_unusedComponents.back().Get();
+    this->_unusedComponents.pop_back();
+    if (pComponent) {
+      pComponent->SetVisibility(true);
+      return pComponent;
+    }
+  }
+
+  UCesiumBoundingVolumeComponent* pComponent =
+      NewObject<UCesiumBoundingVolumeComponent>(pTileAnchor->GetOwner());
+  pComponent->SetFlags(
+      RF_Transient | RF_DuplicateTransient | RF_TextExportTransient);
+  pComponent->SetupAttachment(pTileAnchor);
+  pComponent->RegisterComponent();
+  return pComponent;
+}
+
+void CesiumOcclusionTileExcluder::releaseComponent(
+    UCesiumBoundingVolumeComponent* pComponent) {
+  if (!pComponent) {
+    return;
+  }
+
+  // A hidden component is not tested for occlusion, but stays registered.
+  pComponent->SetVisibility(false);
+  this->_unusedComponents.emplace_back(pComponent);
+}
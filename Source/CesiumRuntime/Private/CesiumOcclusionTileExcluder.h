@@ -0,0 +1,125 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/BoundingVolume.h"
+#include "Cesium3DTilesSelection/ITileExcluder.h"
+#include "Cesium3DTilesSelection/ViewState.h"
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+#include <glm/mat4x4.hpp>
+#include <unordered_map>
+#include <vector>
+
+class UCesiumBoundingVolumeComponent;
+class USceneComponent;
+
+namespace Cesium3DTilesSelection {
+class Tile;
+}
+
+/**
+ * @brief A tile excluder that excludes tiles that were occluded in the
+ * previous frames.
+ *
+ * Each rendered tile gets a {@link UCesiumBoundingVolumeComponent}, whose
+ * bounds are tested by the renderer's occlusion culling, which uses the
+ * hierarchical Z-buffer of the previous frame or hardware occlusion queries.
+ * Once a tile is found to be occluded, it is excluded during tile selection,
+ * so that neither it nor its descendants are rendered or loaded. Its bounding
+ * volume remains in place, so that the tile is selected again as soon as it
+ * becomes visible.
+ *
+ * The renderer only tests the views that it draws, so a tile is only found to
+ * be occluded while its bounds are inside the frustum of a rendered view, and
+ * of no view that is not rendered, such as a camera registered with the
+ * UCesiumCameraSubsystem. Tiles outside the rendered frustums, which are only
+ * selected when frustum culling is disabled, are never excluded.
+ *
+ * The components are reused for other tiles rather than destroyed, so that
+ * tiles that come and go do not create and register components every frame.
+ */
+class CesiumOcclusionTileExcluder
+    : public Cesium3DTilesSelection::ITileExcluder {
+public:
+  /**
+   * @brief Creates a new instance.
+   *
+   * @param pTileAnchor The component that the bounding volumes are attached
+   * to.
+   */
+  CesiumOcclusionTileExcluder(USceneComponent* pTileAnchor);
+  ~CesiumOcclusionTileExcluder();
+
+  /**
+   * @brief Enables or disables occlusion culling. When it is disabled, no tile
+   * is excluded, and all bounding volumes are destroyed.
+   */
+  void setEnabled(bool enabled);
+
+  /**
+   * @brief Returns true if occlusion culling is enabled.
+   */
+  bool isEnabled() const noexcept { return this->_enabled; }
+
+  /**
+   * @brief Updates which tiles are occluded from the latest results of the
+   * renderer. This should be called before each tile selection.
+   *
+   * @param frustums The views of the tile selection, in the "Cesium Tileset"
+   * reference frame.
+   * @param renderedFrustumCount The number of views at the start of the
+   * frustums that are rendered, and thus tested for occlusion by the renderer.
+   * @return Whether any tile became occluded or visible.
+   */
+  bool updateOcclusion(
+      const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+      size_t renderedFrustumCount);
+
+  /**
+   * @brief Updates the bounding volumes after a tile selection.
+   *
+   * The given tiles that do not have a bounding volume yet get one. The
+   * bounding volumes of tiles that are neither rendered nor occluded are
+   * released for other tiles.
+   *
+   * @param tilesToRender The tiles that are rendered this frame.
+   * @param tilesetToTileAnchor The transform from the "Cesium Tileset"
+   * reference frame to the frame of the tile anchor.
+   */
+  void updateBoundingVolumes(
+      const std::vector<Cesium3DTilesSelection::Tile*>& tilesToRender,
+      const glm::dmat4& tilesetToTileAnchor);
+
+  /**
+   * @brief Destroys all bounding volumes, including the unused ones.
+   */
+  void clear();
+
+  virtual bool
+  shouldExclude(const Cesium3DTilesSelection::Tile& tile) const noexcept
+      override;
+
+private:
+  struct BoundingVolume {
+    TWeakObjectPtr<UCesiumBoundingVolumeComponent> pComponent;
+    // A copy of the tile's bounding volume, so that the tiles that are no
+    // longer rendered are never accessed.
+    Cesium3DTilesSelection::BoundingVolume tileBoundingVolume;
+    // The world time since which the bounds have been inside a rendered
+    // frustum and no other frustum, or a negative number if they are not.
+    double inRenderedViewSince = -1.0;
+    bool occluded = false;
+  };
+
+  UCesiumBoundingVolumeComponent*
+  acquireComponent(USceneComponent* pTileAnchor);
+  void releaseComponent(UCesiumBoundingVolumeComponent* pComponent);
+
+  TWeakObjectPtr<USceneComponent> _pTileAnchor;
+  bool _enabled;
+  std::unordered_map<const Cesium3DTilesSelection::Tile*, BoundingVolume>
+      _boundingVolumes;
+  std::vector<TWeakObjectPtr<UCesiumBoundingVolumeComponent>>
+      _unusedComponents;
+};
@@ -0,0 +1,645 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumPackageCommandlet.h"
+#include "Cesium3DTilesSelection/CreditSystem.h"
+#include "Cesium3DTilesSelection/RasterMappedTo3DTile.h"
+#include "Cesium3DTilesSelection/RasterOverlayCollection.h"
+#include "Cesium3DTilesSelection/RasterOverlayTile.h"
+#include "Cesium3DTilesSelection/Tile.h"
+#include "Cesium3DTilesSelection/Tileset.h"
+#include "Cesium3DTilesSelection/TilesetExternals.h"
+#include "Cesium3DTilesSelection/TilesetOptions.h"
+#include "Cesium3DTilesSelection/ViewState.h"
+#include "Cesium3DTilesSelection/ViewUpdateResult.h"
+#include "Cesium3DTileset.h"
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumAsync/CachingAssetAccessor.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CesiumAsync/IAssetResponse.h"
+#include "CesiumBundle.h"
+#include "CesiumCacheDatabase.h"
+#include "CesiumCartographicPolygon.h"
+#include "CesiumCommandletUtility.h"
+#include "CesiumGeospatial/Cartographic.h"
+#include "CesiumGeospatial/Ellipsoid.h"
+#include "CesiumNullResourcePreparer.h"
+#include "CesiumRasterOverlay.h"
+#include "CesiumRuntime.h"
+#include "CesiumStatisticsAssetAccessor.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "CesiumUtility/Math.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "UnrealAssetAccessor.h"
+#include "UnrealTaskProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+using namespace CesiumCommandletUtility;
+
+namespace {
+
+struct PackageView {
+  glm::dvec3 position;
+  glm::dvec3 direction;
+  glm::dvec3 up;
+};
+
+/**
+ * An asset accessor that adds the successful responses of another asset
+ * accessor to a bundle, with the URL they were requested from, and counts the
+ * requests that failed.
+ */
+class RecordingAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+  RecordingAssetAccessor(
+      const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+      const std::shared_ptr<CesiumBundleWriter>& pWriter)
+      : _pAssetAccessor(pAssetAccessor),
+        _pWriter(pWriter),
+        _pFailedRequests(std::make_shared<std::atomic<int32>>(0)) {}
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+  requestAsset(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+      override {
+    return this->_pAssetAccessor->requestAsset(asyncSystem, url, headers)
+        .thenImmediately(
+            [url,
+             pWriter = this->_pWriter,
+             pFailedRequests = this->_pFailedRequests](
+                std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+              const CesiumAsync::IAssetResponse* pResponse =
+                  pRequest->response();
+              if (pResponse && pResponse->statusCode() >= 200 &&
+                  pResponse->statusCode() < 300) {
+                pWriter->add(
+                    url,
+                    pResponse->statusCode(),
+                    pResponse->headers(),
+                    pResponse->data());
+              } else {
+                ++*pFailedRequests;
+              }
+              return std::move(pRequest);
+            });
+  }
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> post(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+      const gsl::span<const std::byte>& contentPayload) override {
+    return this->_pAssetAccessor
+        ->post(asyncSystem, url, headers, contentPayload);
+  }
+
+  virtual void tick() noexcept override { this->_pAssetAccessor->tick(); }
+
+  int32 getFailedRequests() const { return *this->_pFailedRequests; }
+
+private:
+  std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+  std::shared_ptr<CesiumBundleWriter> _pWriter;
+
+  // Requests may complete after the accessor was destroyed.
+  std::shared_ptr<std::atomic<int32>> _pFailedRequests;
+};
+
+/**
+ * Finds the actor of a class with the given name, or with the given label in
+ * the editor.
+ */
+template <typename T> T* findActor(UWorld* pWorld, const FString& name) {
+  for (TActorIterator<T> it(pWorld); it; ++it) {
+    if (it->GetName() == name) {
+      return *it;
+    }
+#if WITH_EDITOR
+    if (it->GetActorLabel() == name) {
+      return *it;
+    }
+#endif
+  }
+  return nullptr;
+}
+
+/**
+ * Returns true if a point is inside a polygon by the even-odd rule, both
+ * given as longitude and latitude.
+ */
+bool isInsidePolygon(
+    const std::vector<glm::dvec2>& polygon,
+    const glm::dvec2& point) {
+  bool inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const glm::dvec2& a = polygon[i];
+    const glm::dvec2& b = polygon[j];
+    if ((a.y > point.y) != (b.y > point.y) &&
+        point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+/**
+ * Unwraps the longitudes of a region in radians, so that no edge is longer
+ * than half the globe, and a region that crosses the antimeridian has
+ * longitudes beyond it instead of wrapping around. Returns false if the region
+ * encircles a pole, which cannot be unwrapped.
+ */
+bool unwrapLongitudes(std::vector<glm::dvec2>& region) {
+  auto unwrap = [](double longitude, double previous) {
+    return previous +
+           std::remainder(longitude - previous, CesiumUtility::Math::TWO_PI);
+  };
+
+  for (size_t i = 1; i < region.size(); ++i) {
+    region[i].x = unwrap(region[i].x, region[i - 1].x);
+  }
+
+  // The edge that closes the region must end where the region starts.
+  double closed = unwrap(region.front().x, region.back().x);
+  return std::abs(closed - region.front().x) < CesiumUtility::Math::ONE_PI;
+}
+
+/**
+ * Creates a view that looks straight down from a height above a longitude
+ * and latitude in radians, with north up.
+ */
+PackageView createView(const glm::dvec2& longitudeLatitude, double height) {
+  const CesiumGeospatial::Ellipsoid& ellipsoid =
+      CesiumGeospatial::Ellipsoid::WGS84;
+  glm::dvec3 position =
+      ellipsoid.cartographicToCartesian(CesiumGeospatial::Cartographic(
+          longitudeLatitude.x,
+          longitudeLatitude.y,
+          height));
+  glm::dvec3 normal = ellipsoid.geodeticSurfaceNormal(position);
+  glm::dvec3 reference = glm::abs(normal.z) < 0.9 ? glm::dvec3(0.0, 0.0, 1.0)
+                                                  : glm::dvec3(1.0, 0.0, 0.0);
+  glm::dvec3 up =
+      glm::normalize(reference - glm::dot(reference, normal) * normal);
+  return PackageView{position, -normal, up};
+}
+
+/**
+ * Adds the views that look straight down at a region from a height above the
+ * ground. The views are placed on a grid inside the region and along its
+ * edges, spaced so that the footprints of neighboring views overlap.
+ *
+ * @param region The region as longitude and latitude in radians, with
+ * unwrapped longitudes, see unwrapLongitudes.
+ * @param groundHeight The height of the ground above the ellipsoid.
+ * @param heightAboveGround The height of the views above the ground.
+ * @param fieldOfView The narrower field of view of the views in radians.
+ * @param views The views to add to.
+ */
+void addViews(
+    const std::vector<glm::dvec2>& region,
+    double groundHeight,
+    double heightAboveGround,
+    double fieldOfView,
+    std::vector<PackageView>& views) {
+  double spacing = 2.0 * heightAboveGround * std::tan(fieldOfView * 0.5);
+  double angularSpacing =
+      spacing / CesiumGeospatial::Ellipsoid::WGS84.getMaximumRadius();
+  double height = groundHeight + heightAboveGround;
+
+  // The spacing in longitude grows towards the poles.
+  auto getLongitudeSpacing = [angularSpacing](double latitude) {
+    return angularSpacing / std::max(std::cos(latitude), 0.01);
+  };
+
+  glm::dvec2 minimum = region[0];
+  glm::dvec2 maximum = region[0];
+  for (const glm::dvec2& point : region) {
+    minimum = glm::min(minimum, point);
+    maximum = glm::max(maximum, point);
+  }
+
+  for (double latitude = minimum.y; latitude <= maximum.y;
+       latitude += angularSpacing) {
+    double longitudeSpacing = getLongitudeSpacing(latitude);
+    for (double longitude = minimum.x; longitude <= maximum.x;
+         longitude += longitudeSpacing) {
+      glm::dvec2 point(longitude, latitude);
+      if (isInsidePolygon(region, point)) {
+        views.push_back(createView(point, height));
+      }
+    }
+  }
+
+  // The grid may miss the parts of the region near its edges.
+  for (size_t i = 0; i < region.size(); ++i) {
+    const glm::dvec2& a = region[i];
+    const glm::dvec2& b = region[(i + 1) % region.size()];
+    glm::dvec2 difference = b - a;
+    double length = std::max(
+        std::abs(difference.y) / angularSpacing,
+        std::abs(difference.x) / getLongitudeSpacing(a.y));
+    int32 steps = std::max(static_cast<int32>(std::ceil(length)), 1);
+    for (int32 step = 0; step < steps; ++step) {
+      glm::dvec2 point = a + difference * (double(step) / double(steps));
+      views.push_back(createView(point, height));
+    }
+  }
+}
+
+/**
+ * Returns true if a raster overlay tile of any tile to render is still being
+ * loaded, including the placeholders of overlays whose source is not known
+ * yet.
+ */
+bool isRasterLoading(
+    const Cesium3DTilesSelection::ViewUpdateResult& result) {
+  for (const Cesium3DTilesSelection::Tile* pTile :
+       result.tilesToRenderThisFrame) {
+    for (const Cesium3DTilesSelection::RasterMappedTo3DTile& mapped :
+         pTile->getMappedRasterTiles()) {
+      const Cesium3DTilesSelection::RasterOverlayTile* pLoadingTile =
+          mapped.getLoadingTile();
+      if (pLoadingTile &&
+          pLoadingTile->getState() !=
+              Cesium3DTilesSelection::RasterOverlayTile::LoadState::Failed) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+UCesiumPackageCommandlet::UCesiumPackageCommandlet() {
+  this->IsClient = false;
+  this->IsServer = false;
+  this->IsEditor = true;
+  this->LogToConsole = true;
+  this->HelpDescription = TEXT(
+      "Downloads the assets of a tileset in a region into a bundle, to load it without a network connection.");
+  this->HelpUsage = TEXT(
+      "-run=CesiumPackage -Map=/Game/Maps/Map -Tileset=Cesium3DTileset -Polygon=CesiumCartographicPolygon [-Output=path.cesiumbundle] [-Heights=100,1000]");
+}
+
+int32 UCesiumPackageCommandlet::Main(const FString& Params) {
+  FString mapName;
+  FString tilesetName;
+  FString polygonName;
+  if (!FParse::Value(*Params, TEXT("Map="), mapName) ||
+      !FParse::Value(*Params, TEXT("Tileset="), tilesetName) ||
+      !FParse::Value(*Params, TEXT("Polygon="), polygonName)) {
+    UE_LOG(LogCesium, Error, TEXT("Usage: %s"), *this->HelpUsage);
+    return 1;
+  }
+
+  FString outputPath = FPaths::Combine(
+      FPaths::ProjectContentDir(),
+      TEXT("Cesium"),
+      tilesetName + TEXT(".cesiumbundle"));
+  FParse::Value(*Params, TEXT("Output="), outputPath);
+  outputPath = FPaths::ConvertRelativePathToFull(outputPath);
+
+  FString heights = TEXT("100");
+  int32 viewportWidth = 1920;
+  int32 viewportHeight = 1080;
+  float fieldOfViewDegrees = 90.0f;
+  float timeoutSeconds = 3600.0f;
+  FParse::Value(*Params, TEXT("Heights="), heights);
+  FParse::Value(*Params, TEXT("ViewportWidth="), viewportWidth);
+  FParse::Value(*Params, TEXT("ViewportHeight="), viewportHeight);
+  FParse::Value(*Params, TEXT("FieldOfView="), fieldOfViewDegrees);
+  FParse::Value(*Params, TEXT("Timeout="), timeoutSeconds);
+
+  UPackage* pPackage = LoadPackage(nullptr, *mapName, LOAD_None);
+  UWorld* pWorld = pPackage ? UWorld::FindWorldInPackage(pPackage) : nullptr;
+  if (!pWorld) {
+    UE_LOG(LogCesium, Error, TEXT("Could not load map %s"), *mapName);
+    return 1;
+  }
+
+  // The world is initialized without being ticked, so that the components of
+  // its actors are registered and have their transforms.
+  pWorld->AddToRoot();
+  bool initializeWorld = !pWorld->bIsWorldInitialized;
+  if (initializeWorld) {
+    pWorld->WorldType = EWorldType::Editor;
+    pWorld->InitWorld(UWorld::InitializationValues()
+                          .AllowAudioPlayback(false)
+                          .CreatePhysicsScene(false)
+                          .RequiresHitProxies(false)
+                          .CreateNavigation(false)
+                          .CreateAISystem(false)
+                          .ShouldSimulatePhysics(false)
+                          .SetTransactional(false));
+  }
+  pWorld->UpdateWorldComponents(true, false);
+
+  ON_SCOPE_EXIT {
+    if (initializeWorld) {
+      pWorld->CleanupWorld();
+    }
+    pWorld->RemoveFromRoot();
+  };
+
+  ACesium3DTileset* pTilesetActor =
+      findActor<ACesium3DTileset>(pWorld, tilesetName);
+  if (!pTilesetActor) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Map %s has no Cesium3DTileset named %s"),
+        *mapName,
+        *tilesetName);
+    return 1;
+  }
+
+  ACesiumCartographicPolygon* pPolygon =
+      findActor<ACesiumCartographicPolygon>(pWorld, polygonName);
+  if (!pPolygon) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Map %s has no CesiumCartographicPolygon named %s"),
+        *mapName,
+        *polygonName);
+    return 1;
+  }
+
+  ACesiumGeoreference* pGeoreference =
+      pPolygon->GlobeAnchor->ResolveGeoreference();
+  int32 pointCount = pPolygon->Polygon->GetNumberOfSplinePoints();
+  if (!pGeoreference || pointCount < 3) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Polygon %s needs a georeference and at least three points"),
+        *polygonName);
+    return 1;
+  }
+
+  std::vector<glm::dvec2> region;
+  double groundHeight = 0.0;
+  for (int32 i = 0; i < pointCount; ++i) {
+    FVector location = pPolygon->Polygon->GetLocationAtSplinePoint(
+        i,
+        ESplineCoordinateSpace::World);
+    glm::dvec3 cartographic =
+        pGeoreference->TransformUnrealToLongitudeLatitudeHeight(
+            glm::dvec3(location.X, location.Y, location.Z));
+    region.emplace_back(
+        glm::radians(cartographic.x),
+        glm::radians(cartographic.y));
+    groundHeight += cartographic.z / pointCount;
+  }
+
+  if (!unwrapLongitudes(region)) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Polygon %s encircles a pole, which is not supported"),
+        *polygonName);
+    return 1;
+  }
+
+  double horizontalFieldOfView = FMath::DegreesToRadians(fieldOfViewDegrees);
+  double aspectRatio = double(viewportWidth) / double(viewportHeight);
+  double verticalFieldOfView =
+      atan(tan(horizontalFieldOfView * 0.5) / aspectRatio) * 2.0;
+
+  std::vector<PackageView> views;
+  TArray<FString> heightValues;
+  heights.ParseIntoArray(heightValues, TEXT(","));
+  for (const FString& heightValue : heightValues) {
+    double heightAboveGround = FCString::Atod(*heightValue);
+    if (heightAboveGround <= 0.0) {
+      UE_LOG(LogCesium, Error, TEXT("Invalid height %s"), *heightValue);
+      return 1;
+    }
+    addViews(
+        region,
+        groundHeight,
+        heightAboveGround,
+        std::min(horizontalFieldOfView, verticalFieldOfView),
+        views);
+  }
+
+  std::shared_ptr<CesiumBundleWriter> pWriter =
+      std::make_shared<CesiumBundleWriter>(outputPath);
+  if (!pWriter->isValid()) {
+    return 1;
+  }
+
+  // Assets that are in the request cache already are not downloaded again.
+  CesiumAsync::AsyncSystem asyncSystem(std::make_shared<UnrealTaskProcessor>());
+  std::shared_ptr<CesiumTilesetStatisticsCollector> pCollector =
+      std::make_shared<CesiumTilesetStatisticsCollector>();
+  std::shared_ptr<RecordingAssetAccessor> pRecordingAccessor =
+      std::make_shared<RecordingAssetAccessor>(
+          std::make_shared<CesiumAsync::CachingAssetAccessor>(
+              spdlog::default_logger(),
+              std::make_shared<CesiumStatisticsAssetAccessor>(
+                  std::make_shared<UnrealAssetAccessor>(),
+                  pCollector,
+                  CesiumStatisticsAssetAccessor::Record::Downloads),
+              CesiumCacheDatabase::getInstance()),
+          pWriter);
+
+  Cesium3DTilesSelection::TilesetExternals externals{
+      std::make_shared<CesiumStatisticsAssetAccessor>(
+          pRecordingAccessor,
+          pCollector,
+          CesiumStatisticsAssetAccessor::Record::Requests),
+      std::make_shared<CesiumNullResourcePreparer>(),
+      asyncSystem,
+      std::make_shared<Cesium3DTilesSelection::CreditSystem>(),
+      spdlog::default_logger()};
+
+  float maximumScreenSpaceError = pTilesetActor->MaximumScreenSpaceError;
+  FParse::Value(
+      *Params,
+      TEXT("MaximumScreenSpaceError="),
+      maximumScreenSpaceError);
+
+  Cesium3DTilesSelection::TilesetOptions options;
+  options.maximumScreenSpaceError =
+      static_cast<double>(maximumScreenSpaceError);
+  options.maximumSimultaneousTileLoads =
+      static_cast<uint32_t>(pTilesetActor->MaximumSimultaneousTileLoads);
+  options.maximumCachedBytes = pTilesetActor->MaximumCachedBytes;
+  options.contentOptions.enableWaterMask = pTilesetActor->GetEnableWaterMask();
+
+  UE_LOG(
+      LogCesium,
+      Display,
+      TEXT("Packaging %s with %d views into %s"),
+      *tilesetName,
+      int32(views.size()),
+      *outputPath);
+
+  double startTime = FPlatformTime::Seconds();
+  double deadline = startTime + timeoutSeconds;
+  bool completed = true;
+
+  {
+    std::unique_ptr<Cesium3DTilesSelection::Tileset> pTileset;
+    switch (pTilesetActor->GetTilesetSource()) {
+    case ETilesetSource::FromUrl:
+      pTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+          externals,
+          TCHAR_TO_UTF8(*pTilesetActor->GetUrl()),
+          options);
+      break;
+    case ETilesetSource::FromCesiumIon:
+      pTileset = std::make_unique<Cesium3DTilesSelection::Tileset>(
+          externals,
+          static_cast<uint32_t>(pTilesetActor->GetIonAssetID()),
+          TCHAR_TO_UTF8(*pTilesetActor->GetIonAccessToken()),
+          options);
+      break;
+    }
+
+    TArray<UCesiumRasterOverlay*> rasterOverlays;
+    pTilesetActor->GetComponents<UCesiumRasterOverlay>(rasterOverlays);
+    for (UCesiumRasterOverlay* pOverlay : rasterOverlays) {
+      pTileset->getOverlays().add(pOverlay->CreateNativeOverlay());
+    }
+
+    // Nothing ticks the HTTP requests in a commandlet but the asset accessor.
+    while (!pTileset->getRootTile()) {
+      if (FPlatformTime::Seconds() > deadline) {
+        UE_LOG(LogCesium, Error, TEXT("Timed out loading %s"), *tilesetName);
+        completed = false;
+        break;
+      }
+      pRecordingAccessor->tick();
+      asyncSystem.dispatchMainThreadTasks();
+      FPlatformProcess::Sleep(loadingFrameSeconds);
+    }
+
+    for (size_t i = 0; completed && i < views.size(); ++i) {
+      const PackageView& view = views[i];
+      std::vector<Cesium3DTilesSelection::ViewState> frustums{
+          Cesium3DTilesSelection::ViewState::create(
+              view.position,
+              view.direction,
+              view.up,
+              glm::dvec2(viewportWidth, viewportHeight),
+              horizontalFieldOfView,
+              verticalFieldOfView)};
+
+      int32 idleFrames = 0;
+      while (idleFrames < idleFramesPerView) {
+        if (FPlatformTime::Seconds() > deadline) {
+          UE_LOG(
+              LogCesium,
+              Error,
+              TEXT("Timed out loading view %d of %d"),
+              int32(i + 1),
+              int32(views.size()));
+          completed = false;
+          break;
+        }
+
+        pRecordingAccessor->tick();
+        const Cesium3DTilesSelection::ViewUpdateResult& result =
+            pTileset->updateView(frustums);
+        pCollector->endFrame(&result);
+
+        const FCesiumTilesetStatistics& statistics =
+            pCollector->getStatistics();
+        bool idle = statistics.TilesWaitingToLoad == 0 &&
+                    statistics.RequestsInFlight == 0 &&
+                    !isContentLoading(*pTileset->getRootTile()) &&
+                    !isRasterLoading(result);
+        idleFrames = idle ? idleFrames + 1 : 0;
+
+        if (!idle) {
+          FPlatformProcess::Sleep(loadingFrameSeconds);
+        }
+      }
+
+      if ((i + 1) % 100 == 0) {
+        UE_LOG(
+            LogCesium,
+            Display,
+            TEXT("Loaded %d of %d views, %.1f MB so far"),
+            int32(i + 1),
+            int32(views.size()),
+            pWriter->getSize() / (1024.0 * 1024.0));
+      }
+    }
+  }
+
+  // The writer deletes the incomplete bundle, so that it does not replace a
+  // complete one at the same path.
+  if (!completed) {
+    UE_LOG(
+        LogCesium,
+        Error,
+        TEXT("Not all views were loaded, so %s was not written"),
+        *outputPath);
+    return 1;
+  }
+
+  if (!pWriter->finish()) {
+    return 1;
+  }
+
+  if (pRecordingAccessor->getFailedRequests() > 0) {
+    UE_LOG(
+        LogCesium,
+        Warning,
+        TEXT("%d requests failed, the bundle is missing their assets"),
+        pRecordingAccessor->getFailedRequests());
+  }
+
+  FString relativePath = outputPath;
+  FPaths::MakePathRelativeTo(relativePath, *FPaths::ProjectDir());
+  UE_LOG(
+      LogCesium,
+      Display,
+      TEXT(
+          "Wrote %llu assets (%.1f MB) in %.0f seconds. Set the Offline Bundle of %s to %s to load them without a network connection."),
+      pWriter->getResponseCount(),
+      pWriter->getSize() / (1024.0 * 1024.0),
+      FPlatformTime::Seconds() - startTime,
+      *tilesetName,
+      *relativePath);
+
+  // Only assets are packaged by default, and a bundle in a pak file could not
+  // be memory mapped, so it must be copied as a loose file.
+  FString contentDirectory =
+      FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+  FString outputDirectory = FPaths::GetPath(outputPath);
+  if (FPaths::IsUnderDirectory(outputDirectory, contentDirectory)) {
+    FPaths::MakePathRelativeTo(outputDirectory, *contentDirectory);
+    UE_LOG(
+        LogCesium,
+        Display,
+        TEXT(
+            "To package the bundle, add %s to Additional Non-Asset Directories To Copy in the Packaging project settings."),
+        *outputDirectory);
+  } else {
+    UE_LOG(
+        LogCesium,
+        Warning,
+        TEXT(
+            "The bundle is outside of the Content directory, and must be copied into packaged builds separately."));
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+#include "CesiumPackageCommandlet.generated.h"
+
+/**
+ * Downloads everything that a tileset and its raster overlays need to be shown
+ * in a region into a bundle file, from which the tileset can be loaded
+ * without a network connection by setting its Offline Bundle.
+ *
+ * The tileset and the region are actors in a map. The region is a Cesium
+ * Cartographic Polygon, and is loaded as if it was looked at from above:
+ *
+ *   UE4Editor-Cmd Project.uproject -run=CesiumPackage -Map=/Game/Maps/City
+ *     -Tileset=Cesium3DTileset -Polygon=CesiumCartographicPolygon
+ *
+ * Optional parameters:
+ *   -Output=<file>  The bundle to write, by default a file in Content/Cesium
+ *                   named after the tileset. Bundles are not assets, so the
+ *                   directory must be added to Additional Non-Asset
+ *                   Directories To Copy in the Packaging project settings
+ *                   to be included in packaged builds.
+ *   -Heights=<m,m>  The lowest height above the region that the tileset will
+ *                   be seen from, in meters (100). Several heights may be
+ *                   given to load the detail of each of them.
+ *   -MaximumScreenSpaceError=<n>  The screen-space error that the tileset is
+ *                   loaded for, by default the one of the tileset.
+ *   -ViewportWidth=<n>, -ViewportHeight=<n>  The viewport size (1920x1080).
+ *   -FieldOfView=<deg>  The horizontal field of view in degrees (90).
+ *   -Timeout=<seconds>  The time after which the commandlet gives up (3600).
+ *
+ * For each height, the region is covered with views that look straight down,
+ * spaced so that their footprints on the ground overlap. A view at some
+ * height needs the most detailed tiles that any view at the same height or
+ * higher needs, and the tiles that it is refined from are loaded along with
+ * them. The responses are recorded with the URL they were requested from,
+ * including the responses of Cesium ion, so that ion assets can be loaded
+ * from a bundle too.
+ *
+ * The region may cross the antimeridian, but may not encircle a pole.
+ *
+ * The commandlet returns 0 if all views were loaded before the timeout and
+ * the bundle was written, and 1 otherwise. A bundle is only written if all
+ * views were loaded, so that an existing bundle is not replaced with an
+ * incomplete one.
+ */
+UCLASS()
+class UCesiumPackageCommandlet : public UCommandlet {
+  GENERATED_BODY()
+
+public:
+  UCesiumPackageCommandlet();
+
+  virtual int32 Main(const FString& Params) override;
+};
@@ -36,14 +36,8 @@ void UCesiumRasterOverlay::AddToTileset() {
     return;
   }
 
-  Cesium3DTilesSelection::RasterOverlayOptions options{};
-  options.maximumScreenSpaceError = this->MaximumScreenSpaceError;
-  options.maximumSimultaneousTileLoads = this->MaximumSimultaneousTileLoads;
-  options.maximumTextureSize = this->MaximumTextureSize;
-  options.subTileCacheBytes = this->SubTileCacheBytes;
-
   std::unique_ptr<Cesium3DTilesSelection::RasterOverlay> pOverlay =
-      this->CreateOverlay(options);
+      this->CreateNativeOverlay();
   this->_pOverlay = pOverlay.get();
 
   pTileset->getOverlays().add(std::move(pOverlay));
@@ -71,6 +65,17 @@ void UCesiumRasterOverlay::Refresh() {
   this->AddToTileset();
 }
 
+std::unique_ptr<Cesium3DTilesSelection::RasterOverlay>
+UCesiumRasterOverlay::CreateNativeOverlay() {
+  Cesium3DTilesSelection::RasterOverlayOptions options{};
+  options.maximumScreenSpaceError = this->MaximumScreenSpaceError;
+  options.maximumSimultaneousTileLoads = this->MaximumSimultaneousTileLoads;
+  options.maximumTextureSize = this->MaximumTextureSize;
+  options.subTileCacheBytes = this->SubTileCacheBytes;
+
+  return this->CreateOverlay(options);
+}
+
 float UCesiumRasterOverlay::GetMaximumScreenSpaceError() const {
   return this->MaximumScreenSpaceError;
 }
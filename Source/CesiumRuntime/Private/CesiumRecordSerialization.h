@@ -0,0 +1,98 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/HttpHeaders.h"
+#include "CoreMinimal.h"
+#include <cstring>
+#include <string>
+
+/**
+ * Helpers for the binary records of responses written by the flat-file cache
+ * and by bundles. Values are written in native byte order, strings with a
+ * 32-bit size before them.
+ */
+namespace CesiumRecordSerialization {
+
+inline void appendBytes(TArray<uint8>& buffer, const void* pData, int64 size) {
+  buffer.Append(static_cast<const uint8*>(pData), static_cast<int32>(size));
+}
+
+inline void appendString(TArray<uint8>& buffer, const std::string& value) {
+  uint32 size = static_cast<uint32>(value.size());
+  appendBytes(buffer, &size, sizeof(size));
+  appendBytes(buffer, value.data(), value.size());
+}
+
+inline void
+appendHeaders(TArray<uint8>& buffer, const CesiumAsync::HttpHeaders& headers) {
+  uint32 count = static_cast<uint32>(headers.size());
+  appendBytes(buffer, &count, sizeof(count));
+  for (const auto& pair : headers) {
+    appendString(buffer, pair.first);
+    appendString(buffer, pair.second);
+  }
+}
+
+/**
+ * Reads values one after another from bytes that may not be aligned, and
+ * fails instead of reading past the end.
+ */
+class Reader {
+public:
+  Reader(const uint8* pData, int64 size) : _pData(pData), _size(size) {}
+
+  const uint8* take(int64 size) {
+    if (size < 0 || size > this->_size) {
+      return nullptr;
+    }
+    const uint8* pResult = this->_pData;
+    this->_pData += size;
+    this->_size -= size;
+    return pResult;
+  }
+
+  bool read(void* pValue, int64 size) {
+    const uint8* pData = this->take(size);
+    if (!pData) {
+      return false;
+    }
+    std::memcpy(pValue, pData, size);
+    return true;
+  }
+
+  bool readString(std::string& value) {
+    uint32 size;
+    if (!this->read(&size, sizeof(size))) {
+      return false;
+    }
+    const uint8* pData = this->take(size);
+    if (!pData) {
+      return false;
+    }
+    value.assign(reinterpret_cast<const char*>(pData), size);
+    return true;
+  }
+
+  bool readHeaders(CesiumAsync::HttpHeaders& headers) {
+    uint32 count;
+    if (!this->read(&count, sizeof(count))) {
+      return false;
+    }
+    for (uint32 i = 0; i < count; ++i) {
+      std::string name;
+      std::string value;
+      if (!this->readString(name) || !this->readString(value)) {
+        return false;
+      }
+      headers.emplace(std::move(name), std::move(value));
+    }
+    return true;
+  }
+
+private:
+  const uint8* _pData;
+  int64 _size;
+};
+
+} // namespace CesiumRecordSerialization
@@ -0,0 +1,416 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumRequestScheduler.h"
+#include "CesiumRuntimeSettings.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "HAL/PlatformTime.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/DateTime.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests Queued"),
+    STAT_CesiumRequestsQueued,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests Coalesced"),
+    STAT_CesiumRequestsCoalesced,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests Retried"),
+    STAT_CesiumRequestsRetried,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests Cancelled"),
+    STAT_CesiumRequestsCancelled,
+    STATGROUP_Cesium);
+
+namespace {
+// How often a request answered with 429 or 503 is sent in total.
+constexpr int32 maximumAttempts = 4;
+
+// The delay before retrying the first time without a Retry-After header,
+// which doubles with each consecutive back-off.
+constexpr double initialBackOffSeconds = 1.0;
+constexpr double maximumBackOffSeconds = 60.0;
+
+/**
+ * Gets the delay given by the Retry-After header of a response, which is
+ * either a number of seconds or an HTTP date, or a negative number if there is
+ * none.
+ */
+double getRetryAfterSeconds(const FHttpResponsePtr& pResponse) {
+  FString retryAfter = pResponse->GetHeader(TEXT("Retry-After"));
+  if (retryAfter.IsEmpty()) {
+    return -1.0;
+  }
+
+  if (retryAfter.IsNumeric()) {
+    return FCString::Atod(*retryAfter);
+  }
+
+  FDateTime date;
+  if (FDateTime::ParseHttpDate(retryAfter, date)) {
+    return (date - FDateTime::UtcNow()).GetTotalSeconds();
+  }
+
+  return -1.0;
+}
+} // namespace
+
+/*static*/ std::string
+CesiumRequestScheduler::getHostName(const std::string& url) {
+  size_t start = url.find("://");
+  start = start == std::string::npos ? 0 : start + 3;
+  size_t end = url.find_first_of("/?#", start);
+  std::string host =
+      url.substr(start, end == std::string::npos ? end : end - start);
+
+  size_t userInfoEnd = host.rfind('@');
+  if (userInfoEnd != std::string::npos) {
+    host.erase(0, userInfoEnd + 1);
+  }
+
+  std::transform(host.begin(), host.end(), host.begin(), [](char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  });
+  return host;
+}
+
+/*static*/ CesiumRequestScheduler& CesiumRequestScheduler::getInstance() {
+  static CesiumRequestScheduler instance;
+  return instance;
+}
+
+CesiumRequestScheduler::CesiumRequestScheduler()
+    : _mutex(),
+      _entries(),
+      _hosts(),
+      _queuedRequests(0),
+      _adaptLimits(GetDefault<UCesiumRuntimeSettings>()->AdaptRequestsPerHost) {
+}
+
+bool CesiumRequestScheduler::request(
+    const std::string& url,
+    std::string&& key,
+    const void* pOwner,
+    Priority priority,
+    const Promise& promise,
+    CreateRequest&& createRequest,
+    CompleteRequest&& completeRequest) {
+  std::vector<std::shared_ptr<Entry>> startable;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    auto it = this->_entries.find(key);
+    if (it != this->_entries.end()) {
+      const std::shared_ptr<Entry>& pEntry = it->second;
+      pEntry->callers.push_back(Caller{promise, pOwner});
+
+      // The entry stays in the queue of its old priority too, where it is
+      // skipped.
+      if (!pEntry->started && priority < pEntry->priority) {
+        pEntry->priority = priority;
+        this->_hosts[pEntry->host]
+            .queues[static_cast<size_t>(priority)]
+            .push_back(pEntry);
+      }
+
+      INC_DWORD_STAT(STAT_CesiumRequestsCoalesced);
+      CSV_CUSTOM_STAT(
+          Cesium,
+          RequestsCoalesced,
+          1,
+          ECsvCustomStatOp::Accumulate);
+      return false;
+    }
+
+    std::shared_ptr<Entry> pEntry = std::make_shared<Entry>();
+    pEntry->key = std::move(key);
+    pEntry->host = getHostName(url);
+    pEntry->priority = priority;
+    pEntry->callers.push_back(Caller{promise, pOwner});
+    pEntry->createRequest = std::move(createRequest);
+    pEntry->completeRequest = std::move(completeRequest);
+    this->_entries.emplace(pEntry->key, pEntry);
+
+    Host& host = this->getHost(pEntry->host);
+    host.queues[static_cast<size_t>(priority)].push_back(pEntry);
+    ++this->_queuedRequests;
+
+    this->takeStartable(host, FPlatformTime::Seconds(), startable);
+  }
+
+  this->start(startable);
+  return true;
+}
+
+void CesiumRequestScheduler::cancel(const void* pOwner) {
+  std::vector<Promise> promises;
+  std::vector<FHttpRequestPtr> requests;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    for (auto it = this->_entries.begin(); it != this->_entries.end();) {
+      Entry& entry = *it->second;
+      auto callersEnd = std::remove_if(
+          entry.callers.begin(),
+          entry.callers.end(),
+          [pOwner, &promises](Caller& caller) {
+            if (caller.pOwner != pOwner) {
+              return false;
+            }
+            promises.push_back(std::move(caller.promise));
+            return true;
+          });
+      entry.callers.erase(callersEnd, entry.callers.end());
+
+      if (!entry.callers.empty()) {
+        ++it;
+        continue;
+      }
+
+      // The entry is removed, so that a later request for the same asset is
+      // not coalesced with it. A queued entry stays in its queue, where it is
+      // skipped, and an entry in flight completes once it is cancelled.
+      entry.cancelled = true;
+      if (!entry.started) {
+        --this->_queuedRequests;
+      } else if (entry.pRequest) {
+        requests.push_back(entry.pRequest);
+      }
+      it = this->_entries.erase(it);
+
+      INC_DWORD_STAT(STAT_CesiumRequestsCancelled);
+      CSV_CUSTOM_STAT(
+          Cesium,
+          RequestsCancelled,
+          1,
+          ECsvCustomStatOp::Accumulate);
+    }
+  }
+
+  for (const FHttpRequestPtr& pRequest : requests) {
+    pRequest->CancelRequest();
+  }
+
+  for (const Promise& promise : promises) {
+    promise.reject(std::runtime_error("Request cancelled."));
+  }
+}
+
+void CesiumRequestScheduler::tick() {
+  std::vector<std::shared_ptr<Entry>> startable;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    double now = FPlatformTime::Seconds();
+    for (auto& pair : this->_hosts) {
+      Host& host = pair.second;
+      if (host.backOffUntil > 0.0 && now >= host.backOffUntil) {
+        host.backOffUntil = 0.0;
+        this->takeStartable(host, now, startable);
+      }
+    }
+  }
+
+  this->start(startable);
+
+  SET_DWORD_STAT(STAT_CesiumRequestsQueued, this->_queuedRequests);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      RequestsQueued,
+      static_cast<int32>(this->_queuedRequests),
+      ECsvCustomStatOp::Set);
+}
+
+CesiumRequestScheduler::Host&
+CesiumRequestScheduler::getHost(const std::string& name) {
+  auto it = this->_hosts.find(name);
+  if (it != this->_hosts.end()) {
+    return it->second;
+  }
+
+  const UCesiumRuntimeSettings* pSettings =
+      GetDefault<UCesiumRuntimeSettings>();
+  const int32* pOverride = pSettings->MaximumRequestsPerHostOverrides.Find(
+      UTF8_TO_TCHAR(name.c_str()));
+
+  Host& host = this->_hosts[name];
+  host.maximumLimit =
+      FMath::Max(pOverride ? *pOverride : pSettings->MaximumRequestsPerHost, 1);
+  host.limit = host.maximumLimit;
+  return host;
+}
+
+void CesiumRequestScheduler::takeStartable(
+    Host& host,
+    double now,
+    std::vector<std::shared_ptr<Entry>>& startable) {
+  if (now < host.backOffUntil) {
+    return;
+  }
+
+  int32 limit = FMath::Max(static_cast<int32>(host.limit), 1);
+  for (size_t i = 0; i < host.queues.size() && host.inFlight < limit; ++i) {
+    std::deque<std::shared_ptr<Entry>>& queue = host.queues[i];
+    while (!queue.empty() && host.inFlight < limit) {
+      std::shared_ptr<Entry> pEntry = std::move(queue.front());
+      queue.pop_front();
+
+      // Skip entries that were cancelled or promoted to a higher priority.
+      if (pEntry->cancelled || pEntry->started ||
+          static_cast<size_t>(pEntry->priority) != i) {
+        continue;
+      }
+
+      pEntry->started = true;
+      pEntry->pRequest = nullptr;
+      ++pEntry->attempts;
+      pEntry->startTime = now;
+      ++host.inFlight;
+      --this->_queuedRequests;
+      startable.push_back(std::move(pEntry));
+    }
+  }
+}
+
+void CesiumRequestScheduler::start(
+    const std::vector<std::shared_ptr<Entry>>& entries) {
+  // Requests are started without the mutex locked, because a request that
+  // fails right away completes within ProcessRequest.
+  for (const std::shared_ptr<Entry>& pEntry : entries) {
+    TSharedRef<IHttpRequest, ESPMode::ThreadSafe> pRequest =
+        pEntry->createRequest();
+    pRequest->OnProcessRequestComplete().BindLambda(
+        [this, pEntry](
+            FHttpRequestPtr pRequest,
+            FHttpResponsePtr pResponse,
+            bool connectedSuccessfully) {
+          this->complete(pEntry, pRequest, pResponse, connectedSuccessfully);
+        });
+    pRequest->ProcessRequest();
+
+    // The entry may have been cancelled after it was taken off its queue,
+    // before the request could be cancelled.
+    bool cancelled;
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      pEntry->pRequest = pRequest;
+      cancelled = pEntry->cancelled;
+    }
+    if (cancelled) {
+      pRequest->CancelRequest();
+    }
+  }
+}
+
+void CesiumRequestScheduler::complete(
+    const std::shared_ptr<Entry>& pEntry,
+    FHttpRequestPtr pRequest,
+    FHttpResponsePtr pResponse,
+    bool connectedSuccessfully) {
+  std::vector<std::shared_ptr<Entry>> startable;
+  std::vector<Promise> promises;
+  bool retry = false;
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    double now = FPlatformTime::Seconds();
+    Host& host = this->_hosts[pEntry->host];
+    --host.inFlight;
+
+    int32 statusCode =
+        connectedSuccessfully && pResponse ? pResponse->GetResponseCode() : 0;
+    if (pEntry->cancelled) {
+      // A cancelled request says nothing about the load of the host, and its
+      // callers were already rejected.
+    } else if (statusCode == 429 || statusCode == 503) {
+      this->decreaseLimit(host, *pEntry, now);
+
+      double delay = getRetryAfterSeconds(pResponse);
+      if (delay < 0.0) {
+        delay = initialBackOffSeconds *
+                std::pow(2.0, static_cast<double>(host.consecutiveBackOffs));
+      }
+      delay = FMath::Clamp(delay, 0.0, maximumBackOffSeconds);
+      ++host.consecutiveBackOffs;
+      host.backOffUntil = FMath::Max(host.backOffUntil, now + delay);
+
+      if (pEntry->attempts < maximumAttempts) {
+        retry = true;
+        pEntry->started = false;
+        host.queues[static_cast<size_t>(pEntry->priority)].push_front(pEntry);
+        ++this->_queuedRequests;
+      }
+    } else if (!connectedSuccessfully) {
+      this->decreaseLimit(host, *pEntry, now);
+    } else {
+      // The latency is not a sign of overload, because it grows with the
+      // size of the response as much as with the load of the host.
+      host.consecutiveBackOffs = 0;
+      this->increaseLimit(host);
+    }
+
+    if (!retry) {
+      for (Caller& caller : pEntry->callers) {
+        promises.push_back(std::move(caller.promise));
+      }
+      pEntry->callers.clear();
+
+      // A cancelled entry was already removed, and another entry for the same
+      // asset may have been added since.
+      auto it = this->_entries.find(pEntry->key);
+      if (it != this->_entries.end() && it->second == pEntry) {
+        this->_entries.erase(it);
+      }
+    }
+
+    this->takeStartable(host, now, startable);
+  }
+
+  if (retry) {
+    INC_DWORD_STAT(STAT_CesiumRequestsRetried);
+  } else {
+    pEntry->completeRequest(
+        promises,
+        pRequest,
+        pResponse,
+        connectedSuccessfully);
+  }
+
+  this->start(startable);
+}
+
+void CesiumRequestScheduler::increaseLimit(Host& host) const {
+  if (!this->_adaptLimits) {
+    return;
+  }
+
+  // Adds one request for each limit's worth of successful requests.
+  host.limit = FMath::Min(
+      host.limit + 1.0 / host.limit,
+      static_cast<double>(host.maximumLimit));
+}
+
+void CesiumRequestScheduler::decreaseLimit(
+    Host& host,
+    const Entry& entry,
+    double now) const {
+  if (!this->_adaptLimits) {
+    return;
+  }
+
+  // The requests that were already in flight when the limit was decreased
+  // report the same overload, so only the requests started afterwards
+  // decrease it again.
+  if (entry.startTime < host.lastDecreaseTime) {
+    return;
+  }
+
+  host.limit = FMath::Max(host.limit * 0.5, 1.0);
+  host.lastDecreaseTime = now;
+}
@@ -0,0 +1,186 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+#include "UnrealTaskProcessor.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Schedules the GET requests of all tilesets and raster overlays, with
+ * a limit on the number of requests in flight to each host.
+ *
+ * Requests that wait for their host are queued by priority, and requests for
+ * the current views are started before prefetching requests. A request for an
+ * asset that is already queued or in flight with the same headers is not sent
+ * again, but resolved with the response of the first one.
+ *
+ * The limit of each host starts at its maximum and adapts to how the host
+ * responds, halving it when the host is overloaded, that is when it answers
+ * with 429 Too Many Requests or 503 Service Unavailable or when a connection
+ * fails, and increasing it again by about one for each limit's worth of
+ * successful requests. Requests answered with 429 or 503 are retried after
+ * the time given by the Retry-After header, or after an exponentially growing
+ * delay if there is none, during which no other requests are started for the
+ * host.
+ *
+ * The maximum limits are set in the Cesium project settings, per host or for
+ * all hosts.
+ *
+ * The requests of an owner, such as the asset accessor of a tileset that is
+ * destroyed, can be cancelled. A queued request that no other owner waits for
+ * is then never sent, and such a request in flight is cancelled.
+ */
+class CesiumRequestScheduler {
+public:
+  using Priority = UnrealTaskProcessor::Priority;
+  using Promise =
+      CesiumAsync::Promise<std::shared_ptr<CesiumAsync::IAssetRequest>>;
+
+  /**
+   * @brief Creates an Unreal request that is ready to be processed. It may be
+   * called more than once for the same asset, when a request is retried.
+   */
+  using CreateRequest =
+      std::function<TSharedRef<IHttpRequest, ESPMode::ThreadSafe>()>;
+
+  /**
+   * @brief Resolves or rejects the promises of all callers that requested an
+   * asset with the completed Unreal request.
+   */
+  using CompleteRequest = std::function<void(
+      const std::vector<Promise>& promises,
+      FHttpRequestPtr pRequest,
+      FHttpResponsePtr pResponse,
+      bool connectedSuccessfully)>;
+
+  /**
+   * @brief Gets the host and port of a URL, in lower case, which identify the
+   * host that requests are limited by.
+   */
+  static std::string getHostName(const std::string& url);
+
+  /**
+   * @brief Gets the scheduler shared by all asset accessors.
+   */
+  static CesiumRequestScheduler& getInstance();
+
+  /**
+   * @brief Schedules a GET request.
+   *
+   * @param url The URL of the request, whose host the request is limited by.
+   * @param key Identifies the request, so that requests with the same key are
+   * coalesced.
+   * @param pOwner The owner of the request, whose requests are cancelled
+   * together.
+   * @param priority The priority of the request. A queued request is promoted
+   * if a caller with a higher priority requests the same asset.
+   * @param promise The promise to resolve with the response.
+   * @param createRequest Creates the Unreal request.
+   * @param completeRequest Resolves the promises once the request completed.
+   * @return Whether a new request was scheduled, or false if the request was
+   * coalesced with one that is already queued or in flight.
+   */
+  bool request(
+      const std::string& url,
+      std::string&& key,
+      const void* pOwner,
+      Priority priority,
+      const Promise& promise,
+      CreateRequest&& createRequest,
+      CompleteRequest&& completeRequest);
+
+  /**
+   * @brief Cancels the requests of an owner, rejecting their promises.
+   *
+   * Requests that are coalesced with the requests of other owners are still
+   * sent for the other owners. The others are removed from their queues, or
+   * cancelled with IHttpRequest::CancelRequest if they are in flight.
+   *
+   * @param pOwner The owner that was given to request.
+   */
+  void cancel(const void* pOwner);
+
+  /**
+   * @brief Starts the requests of hosts whose back-off has elapsed. Called
+   * once per frame.
+   */
+  void tick();
+
+private:
+  struct Caller {
+    Promise promise;
+    const void* pOwner;
+  };
+
+  struct Entry {
+    std::string key;
+    std::string host;
+    Priority priority;
+    std::vector<Caller> callers;
+    CreateRequest createRequest;
+    CompleteRequest completeRequest;
+    int32 attempts = 0;
+    bool started = false;
+    double startTime = 0.0;
+
+    // The Unreal request of an entry in flight, once it has been started.
+    FHttpRequestPtr pRequest;
+
+    // Whether all callers cancelled the request. A cancelled entry that is
+    // still in a queue is skipped.
+    bool cancelled = false;
+  };
+
+  struct Host {
+    double limit = 1.0;
+    int32 maximumLimit = 1;
+    int32 inFlight = 0;
+    std::array<std::deque<std::shared_ptr<Entry>>, 2> queues;
+
+    // When the limit was last decreased.
+    double lastDecreaseTime = 0.0;
+
+    // No requests are started before this time while the host backs off.
+    double backOffUntil = 0.0;
+    int32 consecutiveBackOffs = 0;
+  };
+
+  CesiumRequestScheduler();
+
+  Host& getHost(const std::string& host);
+
+  // Takes the requests that may be started for a host off its queues. Must be
+  // called with the mutex locked.
+  void takeStartable(
+      Host& host,
+      double now,
+      std::vector<std::shared_ptr<Entry>>& startable);
+
+  void start(const std::vector<std::shared_ptr<Entry>>& entries);
+  void complete(
+      const std::shared_ptr<Entry>& pEntry,
+      FHttpRequestPtr pRequest,
+      FHttpResponsePtr pResponse,
+      bool connectedSuccessfully);
+
+  void increaseLimit(Host& host) const;
+  void decreaseLimit(Host& host, const Entry& entry, double now) const;
+
+  std::mutex _mutex;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> _entries;
+  std::unordered_map<std::string, Host> _hosts;
+  std::atomic<int32> _queuedRequests;
+  bool _adaptLimits;
+};
@@ -2,7 +2,10 @@
 
 #include "CesiumRuntime.h"
 #include "Cesium3DTilesSelection/registerAllTileContentTypes.h"
+#include "CesiumCacheDatabase.h"
 #include "CesiumUtility/Tracing.h"
+#include "CesiumWorkerPool.h"
+#include "Misc/CoreDelegates.h"
 #include "SpdlogUnrealLoggerSink.h"
 #include <Modules/ModuleManager.h>
 #include <spdlog/spdlog.h>
@@ -23,6 +26,9 @@ void FCesiumRuntimeModule::StartupModule() {
 
   FModuleManager::Get().LoadModuleChecked(TEXT("HTTP"));
 
+  this->_endFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(
+      &CesiumWorkerPool::publishStatistics);
+
   CESIUM_TRACE_INIT(
       "cesium-trace-" +
       std::to_string(std::chrono::time_point_cast<std::chrono::microseconds>(
@@ -32,7 +38,12 @@ void FCesiumRuntimeModule::StartupModule() {
       ".json");
 }
 
-void FCesiumRuntimeModule::ShutdownModule() { CESIUM_TRACE_SHUTDOWN(); }
+void FCesiumRuntimeModule::ShutdownModule() {
+  FCoreDelegates::OnEndFrame.Remove(this->_endFrameHandle);
+  CesiumWorkerPool::shutdown();
+  CesiumCacheDatabase::shutdown();
+  CESIUM_TRACE_SHUTDOWN();
+}
 
 #undef LOCTEXT_NAMESPACE
 
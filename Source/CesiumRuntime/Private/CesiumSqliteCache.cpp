@@ -0,0 +1,445 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumSqliteCache.h"
+#include "CesiumAsync/CacheItem.h"
+#include "CesiumRuntime.h"
+#include <algorithm>
+#include <sqlite3.h>
+#include <vector>
+
+namespace {
+// The version of the schema below. The tables of a database with another
+// version, such as one written by cesium-native's SqliteCache, are dropped.
+constexpr int schemaVersion = 2;
+
+// How long a connection waits for the other one to release the database.
+constexpr int busyTimeoutMilliseconds = 5000;
+
+constexpr const char* createSchemaSql =
+    "CREATE TABLE IF NOT EXISTS CacheItems("
+    "key TEXT PRIMARY KEY NOT NULL, "
+    "expiryTime INTEGER NOT NULL, "
+    "lastAccessTime INTEGER NOT NULL, "
+    "url TEXT NOT NULL, "
+    "requestMethod TEXT NOT NULL, "
+    "requestHeaders BLOB NOT NULL, "
+    "statusCode INTEGER NOT NULL, "
+    "responseHeaders BLOB NOT NULL, "
+    "data BLOB NOT NULL);"
+    "CREATE INDEX IF NOT EXISTS CacheItemsByLastAccessTime "
+    "ON CacheItems(lastAccessTime);";
+
+constexpr const char* getEntrySql =
+    "SELECT expiryTime, url, requestMethod, requestHeaders, statusCode, "
+    "responseHeaders, data FROM CacheItems WHERE key = ?";
+
+constexpr const char* storeEntrySql =
+    "INSERT OR REPLACE INTO CacheItems(key, expiryTime, lastAccessTime, url, "
+    "requestMethod, requestHeaders, statusCode, responseHeaders, data) "
+    "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+constexpr const char* updateAccessTimeSql =
+    "UPDATE CacheItems SET lastAccessTime = ? WHERE key = ?";
+
+/**
+ * Stores headers as their names and values, each followed by a newline, which
+ * HTTP does not allow in either.
+ */
+std::string serializeHeaders(const CesiumAsync::HttpHeaders& headers) {
+  std::string result;
+  for (const auto& pair : headers) {
+    result += pair.first;
+    result += '\n';
+    result += pair.second;
+    result += '\n';
+  }
+  return result;
+}
+
+CesiumAsync::HttpHeaders
+deserializeHeaders(sqlite3_stmt* pStatement, int column) {
+  const char* pData =
+      static_cast<const char*>(sqlite3_column_blob(pStatement, column));
+  const char* pEnd = pData + sqlite3_column_bytes(pStatement, column);
+
+  CesiumAsync::HttpHeaders headers;
+  while (pData && pData < pEnd) {
+    const char* pNameEnd = std::find(pData, pEnd, '\n');
+    const char* pValueEnd =
+        pNameEnd == pEnd ? pEnd : std::find(pNameEnd + 1, pEnd, '\n');
+    if (pValueEnd == pEnd) {
+      break;
+    }
+    headers.emplace(
+        std::string(pData, pNameEnd),
+        std::string(pNameEnd + 1, pValueEnd));
+    pData = pValueEnd + 1;
+  }
+  return headers;
+}
+
+std::string getText(sqlite3_stmt* pStatement, int column) {
+  const char* pText = reinterpret_cast<const char*>(
+      sqlite3_column_text(pStatement, column));
+  return pText ? std::string(pText, sqlite3_column_bytes(pStatement, column))
+               : std::string();
+}
+
+void bindText(sqlite3_stmt* pStatement, int index, const std::string& text) {
+  sqlite3_bind_text(
+      pStatement,
+      index,
+      text.data(),
+      static_cast<int>(text.size()),
+      SQLITE_STATIC);
+}
+
+// A blob without data would be bound as NULL.
+void bindBlob(
+    sqlite3_stmt* pStatement,
+    int index,
+    const void* pData,
+    size_t size) {
+  if (size == 0) {
+    sqlite3_bind_zeroblob(pStatement, index, 0);
+  } else {
+    sqlite3_bind_blob64(pStatement, index, pData, size, SQLITE_STATIC);
+  }
+}
+} // namespace
+
+CesiumSqliteCache::CesiumSqliteCache(
+    const std::string& databaseName,
+    uint64 maximumItems,
+    int64 maximumBytes)
+    : _databaseName(databaseName),
+      _maximumItems(maximumItems),
+      _maximumBytes(maximumBytes),
+      _readMutex(),
+      _pReadConnection(nullptr),
+      _pGetEntry(nullptr),
+      _writeMutex(),
+      _pWriteConnection(nullptr),
+      _pStoreEntry(nullptr),
+      _pUpdateAccessTime(nullptr),
+      _accessedMutex(),
+      _accessedKeys() {
+  // Both connections are only used with their mutex locked.
+  if (!this->check(
+          sqlite3_open_v2(
+              databaseName.c_str(),
+              &this->_pWriteConnection,
+              SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+              nullptr),
+          "open")) {
+    sqlite3_close(this->_pWriteConnection);
+    this->_pWriteConnection = nullptr;
+    return;
+  }
+  sqlite3_busy_timeout(this->_pWriteConnection, busyTimeoutMilliseconds);
+
+  int version = 0;
+  sqlite3_stmt* pVersion = nullptr;
+  if (this->check(
+          sqlite3_prepare_v2(
+              this->_pWriteConnection,
+              "PRAGMA user_version",
+              -1,
+              &pVersion,
+              nullptr),
+          "read the version of") &&
+      sqlite3_step(pVersion) == SQLITE_ROW) {
+    version = sqlite3_column_int(pVersion, 0);
+  }
+  sqlite3_finalize(pVersion);
+
+  // Incremental vacuuming lets pruning return the pages of removed responses
+  // to the file system. It can only be enabled before the tables are
+  // created, or with a vacuum.
+  if (version != schemaVersion) {
+    this->execute("DROP TABLE IF EXISTS CacheItemTable");
+    this->execute("DROP TABLE IF EXISTS CacheItems");
+    this->execute("PRAGMA auto_vacuum=INCREMENTAL");
+    this->execute("VACUUM");
+    this->execute(createSchemaSql);
+    this->execute(
+        ("PRAGMA user_version=" + std::to_string(schemaVersion)).c_str());
+  }
+
+  // With write-ahead logging, the read connection reads the last committed
+  // responses while a batch is written, and commits are only synced to disk
+  // when the log is checkpointed into the database.
+  this->execute("PRAGMA journal_mode=WAL");
+  this->execute("PRAGMA synchronous=NORMAL");
+
+  this->check(
+      sqlite3_prepare_v2(
+          this->_pWriteConnection,
+          storeEntrySql,
+          -1,
+          &this->_pStoreEntry,
+          nullptr),
+      "prepare writing to");
+  this->check(
+      sqlite3_prepare_v2(
+          this->_pWriteConnection,
+          updateAccessTimeSql,
+          -1,
+          &this->_pUpdateAccessTime,
+          nullptr),
+      "prepare writing to");
+
+  if (!this->check(
+          sqlite3_open_v2(
+              databaseName.c_str(),
+              &this->_pReadConnection,
+              SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+              nullptr),
+          "open")) {
+    sqlite3_close(this->_pReadConnection);
+    this->_pReadConnection = nullptr;
+    return;
+  }
+  sqlite3_busy_timeout(this->_pReadConnection, busyTimeoutMilliseconds);
+
+  this->check(
+      sqlite3_prepare_v2(
+          this->_pReadConnection,
+          getEntrySql,
+          -1,
+          &this->_pGetEntry,
+          nullptr),
+      "prepare reading from");
+}
+
+CesiumSqliteCache::~CesiumSqliteCache() {
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->_writeMutex);
+    this->writeAccessTimes();
+  }
+
+  sqlite3_finalize(this->_pGetEntry);
+  sqlite3_finalize(this->_pStoreEntry);
+  sqlite3_finalize(this->_pUpdateAccessTime);
+  sqlite3_close(this->_pReadConnection);
+  sqlite3_close(this->_pWriteConnection);
+}
+
+std::optional<CesiumAsync::CacheItem>
+CesiumSqliteCache::getEntry(const std::string& key) const {
+  std::optional<CesiumAsync::CacheItem> item;
+  {
+    std::lock_guard<std::mutex> lock(this->_readMutex);
+    if (!this->_pGetEntry) {
+      return std::nullopt;
+    }
+
+    bindText(this->_pGetEntry, 1, key);
+    int result = sqlite3_step(this->_pGetEntry);
+    if (result == SQLITE_ROW) {
+      const std::byte* pData = static_cast<const std::byte*>(
+          sqlite3_column_blob(this->_pGetEntry, 6));
+      int dataSize = sqlite3_column_bytes(this->_pGetEntry, 6);
+      item.emplace(
+          static_cast<std::time_t>(sqlite3_column_int64(this->_pGetEntry, 0)),
+          CesiumAsync::CacheRequest(
+              deserializeHeaders(this->_pGetEntry, 3),
+              getText(this->_pGetEntry, 2),
+              getText(this->_pGetEntry, 1)),
+          CesiumAsync::CacheResponse(
+              static_cast<uint16_t>(sqlite3_column_int(this->_pGetEntry, 4)),
+              deserializeHeaders(this->_pGetEntry, 5),
+              pData ? std::vector<std::byte>(pData, pData + dataSize)
+                    : std::vector<std::byte>()));
+    } else {
+      this->check(result, "read a response from");
+    }
+
+    sqlite3_reset(this->_pGetEntry);
+    sqlite3_clear_bindings(this->_pGetEntry);
+  }
+
+  if (item) {
+    std::lock_guard<std::mutex> lock(this->_accessedMutex);
+    this->_accessedKeys.insert(key);
+  }
+  return item;
+}
+
+bool CesiumSqliteCache::storeEntry(
+    const std::string& key,
+    std::time_t expiryTime,
+    const std::string& url,
+    const std::string& requestMethod,
+    const CesiumAsync::HttpHeaders& requestHeaders,
+    uint16_t statusCode,
+    const CesiumAsync::HttpHeaders& responseHeaders,
+    const gsl::span<const std::byte>& responseData) {
+  std::string serializedRequestHeaders = serializeHeaders(requestHeaders);
+  std::string serializedResponseHeaders = serializeHeaders(responseHeaders);
+
+  std::lock_guard<std::recursive_mutex> lock(this->_writeMutex);
+  if (!this->_pStoreEntry) {
+    return false;
+  }
+
+  bindText(this->_pStoreEntry, 1, key);
+  sqlite3_bind_int64(this->_pStoreEntry, 2, expiryTime);
+  sqlite3_bind_int64(this->_pStoreEntry, 3, std::time(nullptr));
+  bindText(this->_pStoreEntry, 4, url);
+  bindText(this->_pStoreEntry, 5, requestMethod);
+  bindBlob(
+      this->_pStoreEntry,
+      6,
+      serializedRequestHeaders.data(),
+      serializedRequestHeaders.size());
+  sqlite3_bind_int(this->_pStoreEntry, 7, statusCode);
+  bindBlob(
+      this->_pStoreEntry,
+      8,
+      serializedResponseHeaders.data(),
+      serializedResponseHeaders.size());
+  bindBlob(this->_pStoreEntry, 9, responseData.data(), responseData.size());
+
+  int result = sqlite3_step(this->_pStoreEntry);
+  sqlite3_reset(this->_pStoreEntry);
+  sqlite3_clear_bindings(this->_pStoreEntry);
+  return this->check(result, "write a response to");
+}
+
+bool CesiumSqliteCache::prune() {
+  std::lock_guard<std::recursive_mutex> lock(this->_writeMutex);
+  if (!this->_pWriteConnection) {
+    return false;
+  }
+
+  // The access times are written first, so that the least recently used
+  // responses are removed.
+  std::string deleteExpired = "DELETE FROM CacheItems WHERE expiryTime < " +
+                              std::to_string(std::time(nullptr));
+  std::string deleteLeastRecentlyUsed =
+      "DELETE FROM CacheItems WHERE key IN (SELECT key FROM CacheItems "
+      "ORDER BY lastAccessTime ASC "
+      "LIMIT max(0, (SELECT COUNT(*) FROM CacheItems) - " +
+      std::to_string(this->_maximumItems) + "))";
+
+  // Keeps the most recently used responses whose bodies fit in the maximum
+  // size.
+  std::string deleteLargerThanMaximum =
+      "DELETE FROM CacheItems WHERE key IN (SELECT key FROM ("
+      "SELECT key, SUM(length(data)) OVER "
+      "(ORDER BY lastAccessTime DESC, key) AS bytes FROM CacheItems) "
+      "WHERE bytes > " +
+      std::to_string(this->_maximumBytes) + ")";
+
+  this->execute("BEGIN");
+  this->writeAccessTimes();
+  bool result = this->execute(deleteExpired.c_str());
+  result = this->execute(deleteLeastRecentlyUsed.c_str()) && result;
+  if (this->_maximumBytes > 0) {
+    result = this->execute(deleteLargerThanMaximum.c_str()) && result;
+  }
+  result = this->execute("COMMIT") && result;
+
+  // Returns the pages of the removed responses to the file system, and moves
+  // the log into the database, so that neither file keeps growing.
+  this->execute("PRAGMA incremental_vacuum");
+  this->execute("PRAGMA wal_checkpoint(TRUNCATE)");
+  return result;
+}
+
+int64 CesiumSqliteCache::getSize() const {
+  std::lock_guard<std::mutex> lock(this->_readMutex);
+  if (!this->_pReadConnection) {
+    return 0;
+  }
+
+  // Only the pages in use are counted, so that the size does not depend on
+  // when the log was last checkpointed or the free pages vacuumed.
+  int64 size = 0;
+  sqlite3_stmt* pSize = nullptr;
+  if (this->check(
+          sqlite3_prepare_v2(
+              this->_pReadConnection,
+              "SELECT (page_count - freelist_count) * page_size FROM "
+              "pragma_page_count(), pragma_freelist_count(), "
+              "pragma_page_size()",
+              -1,
+              &pSize,
+              nullptr),
+          "read the size of") &&
+      sqlite3_step(pSize) == SQLITE_ROW) {
+    size = sqlite3_column_int64(pSize, 0);
+  }
+  sqlite3_finalize(pSize);
+  return size;
+}
+
+bool CesiumSqliteCache::clearAll() {
+  {
+    std::lock_guard<std::mutex> lock(this->_accessedMutex);
+    this->_accessedKeys.clear();
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->_writeMutex);
+  return this->execute("DELETE FROM CacheItems");
+}
+
+void CesiumSqliteCache::beginBatch() {
+  this->_writeMutex.lock();
+  this->execute("BEGIN");
+}
+
+void CesiumSqliteCache::endBatch() {
+  this->writeAccessTimes();
+  this->execute("COMMIT");
+  this->_writeMutex.unlock();
+}
+
+bool CesiumSqliteCache::execute(const char* sql) {
+  if (!this->_pWriteConnection) {
+    return false;
+  }
+
+  return this->check(
+      sqlite3_exec(this->_pWriteConnection, sql, nullptr, nullptr, nullptr),
+      "write to");
+}
+
+bool CesiumSqliteCache::check(int result, const char* operation) const {
+  if (result == SQLITE_OK || result == SQLITE_ROW || result == SQLITE_DONE) {
+    return true;
+  }
+
+  UE_LOG(
+      LogCesium,
+      Warning,
+      TEXT("Could not %s the request cache %s: %s"),
+      UTF8_TO_TCHAR(operation),
+      UTF8_TO_TCHAR(this->_databaseName.c_str()),
+      UTF8_TO_TCHAR(sqlite3_errstr(result)));
+  return false;
+}
+
+void CesiumSqliteCache::writeAccessTimes() {
+  std::unordered_set<std::string> keys;
+  {
+    std::lock_guard<std::mutex> lock(this->_accessedMutex);
+    keys.swap(this->_accessedKeys);
+  }
+
+  if (!this->_pUpdateAccessTime) {
+    return;
+  }
+
+  std::time_t now = std::time(nullptr);
+  for (const std::string& key : keys) {
+    sqlite3_bind_int64(this->_pUpdateAccessTime, 1, now);
+    bindText(this->_pUpdateAccessTime, 2, key);
+    this->check(
+        sqlite3_step(this->_pUpdateAccessTime),
+        "write an access time to");
+    sqlite3_reset(this->_pUpdateAccessTime);
+    sqlite3_clear_bindings(this->_pUpdateAccessTime);
+  }
+}
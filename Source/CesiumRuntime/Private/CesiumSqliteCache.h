@@ -0,0 +1,98 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumCacheShard.h"
+#include "CoreMinimal.h"
+#include <ctime>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/**
+ * @brief A request cache in an SQLite database, whose connections are owned by
+ * this plugin rather than by cesium-native's SqliteCache, so that the database
+ * can be configured for the background writer of the request cache.
+ *
+ * The database uses write-ahead logging, so that responses are read with a
+ * separate connection while a batch is written, and all responses of a batch
+ * are written in one transaction. Reading a response does not write to the
+ * database. Its access time is kept in memory and written along with the next
+ * batch, or when the cache is pruned.
+ *
+ * Pruning removes the expired responses first, and then the least recently
+ * used ones until the cache is within its number of responses and the size of
+ * their bodies. The pages of the removed responses are then returned to the
+ * file system with an incremental vacuum.
+ */
+class CesiumSqliteCache : public CesiumCacheShard {
+public:
+  /**
+   * @brief Opens the database, creating it if needed.
+   *
+   * @param databaseName The path of the database file.
+   * @param maximumItems The maximum number of responses kept when the cache is
+   * pruned.
+   * @param maximumBytes The maximum size of the bodies of the responses kept
+   * when the cache is pruned, or zero for no limit.
+   */
+  CesiumSqliteCache(
+      const std::string& databaseName,
+      uint64 maximumItems,
+      int64 maximumBytes);
+
+  virtual ~CesiumSqliteCache();
+
+  virtual std::optional<CesiumAsync::CacheItem>
+  getEntry(const std::string& key) const override;
+
+  virtual bool storeEntry(
+      const std::string& key,
+      std::time_t expiryTime,
+      const std::string& url,
+      const std::string& requestMethod,
+      const CesiumAsync::HttpHeaders& requestHeaders,
+      uint16_t statusCode,
+      const CesiumAsync::HttpHeaders& responseHeaders,
+      const gsl::span<const std::byte>& responseData) override;
+
+  virtual bool prune() override;
+
+  virtual bool clearAll() override;
+
+  virtual int64 getSize() const override;
+
+  virtual void beginBatch() override;
+
+  virtual void endBatch() override;
+
+private:
+  bool execute(const char* sql);
+  bool check(int result, const char* operation) const;
+  void writeAccessTimes();
+
+  std::string _databaseName;
+  uint64 _maximumItems;
+  int64 _maximumBytes;
+
+  // Guards the connection that responses are read with.
+  mutable std::mutex _readMutex;
+  sqlite3* _pReadConnection;
+  sqlite3_stmt* _pGetEntry;
+
+  // Guards the connection that responses are written with. It is held from
+  // beginBatch to endBatch, so that nothing else is written in between.
+  std::recursive_mutex _writeMutex;
+  sqlite3* _pWriteConnection;
+  sqlite3_stmt* _pStoreEntry;
+  sqlite3_stmt* _pUpdateAccessTime;
+
+  // The keys of the responses that were read since the access times were
+  // last written.
+  mutable std::mutex _accessedMutex;
+  mutable std::unordered_set<std::string> _accessedKeys;
+};
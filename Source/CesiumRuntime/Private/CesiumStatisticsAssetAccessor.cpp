@@ -0,0 +1,83 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumStatisticsAssetAccessor.h"
+#include "CesiumAsync/IAssetRequest.h"
+#include "CesiumAsync/IAssetResponse.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "HAL/PlatformTime.h"
+#include <stdexcept>
+
+CesiumStatisticsAssetAccessor::CesiumStatisticsAssetAccessor(
+    const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+    const std::shared_ptr<CesiumTilesetStatisticsCollector>& pCollector,
+    Record record)
+    : _pAssetAccessor(pAssetAccessor),
+      _pCollector(pCollector),
+      _record(record) {}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumStatisticsAssetAccessor::requestAsset(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& url,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) {
+  double startTime = this->beginRecording();
+  return this->endRecording(
+      this->_pAssetAccessor->requestAsset(asyncSystem, url, headers),
+      startTime);
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumStatisticsAssetAccessor::post(
+    const CesiumAsync::AsyncSystem& asyncSystem,
+    const std::string& url,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+    const gsl::span<const std::byte>& contentPayload) {
+  double startTime = this->beginRecording();
+  return this->endRecording(
+      this->_pAssetAccessor->post(asyncSystem, url, headers, contentPayload),
+      startTime);
+}
+
+void CesiumStatisticsAssetAccessor::tick() noexcept {
+  this->_pAssetAccessor->tick();
+}
+
+double CesiumStatisticsAssetAccessor::beginRecording() const {
+  if (this->_record == Record::Requests) {
+    this->_pCollector->beginRequest();
+  }
+  return FPlatformTime::Seconds();
+}
+
+CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+CesiumStatisticsAssetAccessor::endRecording(
+    CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>&& future,
+    double startTime) const {
+  std::shared_ptr<CesiumTilesetStatisticsCollector> pCollector =
+      this->_pCollector;
+
+  if (this->_record == Record::Downloads) {
+    return std::move(future).thenImmediately(
+        [pCollector](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+          const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
+          pCollector->recordDownload(
+              pResponse ? static_cast<int64>(pResponse->data().size()) : 0);
+          return std::move(pRequest);
+        });
+  }
+
+  return std::move(future)
+      .thenImmediately(
+          [pCollector,
+           startTime](std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
+            pCollector->endRequest(FPlatformTime::Seconds() - startTime);
+            return std::move(pRequest);
+          })
+      .catchImmediately(
+          [pCollector, startTime](std::exception&& e)
+              -> std::shared_ptr<CesiumAsync::IAssetRequest> {
+            // A failed request is no longer in flight either.
+            pCollector->endRequest(FPlatformTime::Seconds() - startTime);
+            throw std::runtime_error(e.what());
+          });
+}
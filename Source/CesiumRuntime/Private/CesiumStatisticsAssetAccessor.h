@@ -0,0 +1,70 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumAsync/AsyncSystem.h"
+#include "CesiumAsync/IAssetAccessor.h"
+#include <memory>
+
+class CesiumTilesetStatisticsCollector;
+
+/**
+ * @brief An asset accessor that records the requests made through another
+ * asset accessor in the statistics of a tileset.
+ *
+ * A tileset wraps both the accessor it requests assets from, which records
+ * the requests and their latency, and the accessor that downloads the assets
+ * that are not in the request cache, which records the downloads. The
+ * difference between the two is the number of cache hits.
+ */
+class CesiumStatisticsAssetAccessor : public CesiumAsync::IAssetAccessor {
+public:
+  /**
+   * @brief What is recorded for each request.
+   */
+  enum class Record {
+    /**
+     * @brief The request, its latency and whether it is still in flight.
+     */
+    Requests,
+
+    /**
+     * @brief A download of the size of the response.
+     */
+    Downloads
+  };
+
+  CesiumStatisticsAssetAccessor(
+      const std::shared_ptr<CesiumAsync::IAssetAccessor>& pAssetAccessor,
+      const std::shared_ptr<CesiumTilesetStatisticsCollector>& pCollector,
+      Record record);
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
+  requestAsset(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers)
+      override;
+
+  virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> post(
+      const CesiumAsync::AsyncSystem& asyncSystem,
+      const std::string& url,
+      const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers,
+      const gsl::span<const std::byte>& contentPayload) override;
+
+  virtual void tick() noexcept override;
+
+private:
+  // Records the start of a request and returns its start time.
+  double beginRecording() const;
+
+  // Records the completion of the request with the given future.
+  CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>> endRecording(
+      CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>&&
+          future,
+      double startTime) const;
+
+  std::shared_ptr<CesiumAsync::IAssetAccessor> _pAssetAccessor;
+  std::shared_ptr<CesiumTilesetStatisticsCollector> _pCollector;
+  Record _record;
+};
@@ -0,0 +1,324 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumTilesetManager.h"
+#include "Cesium3DTileset.h"
+#include "Cesium3DTilesSelection/Tileset.h"
+#include "Cesium3DTilesSelection/TilesetOptions.h"
+#include "Cesium3DTilesSelection/ViewUpdateResult.h"
+#include "CesiumCameraSubsystem.h"
+#include "CesiumRuntimeSettings.h"
+#include "Engine/World.h"
+#include <algorithm>
+#include <glm/gtc/matrix_inverse.hpp>
+
+/*static*/ UCesiumTilesetManager*
+UCesiumTilesetManager::Get(const UObject* WorldContextObject) {
+  if (!WorldContextObject) {
+    return nullptr;
+  }
+  UWorld* pWorld = WorldContextObject->GetWorld();
+  if (!IsValid(pWorld)) {
+    return nullptr;
+  }
+  return pWorld->GetSubsystem<UCesiumTilesetManager>();
+}
+
+/*static*/ Cesium3DTilesSelection::ViewState
+UCesiumTilesetManager::CreateViewState(
+    const FCesiumCamera& camera,
+    const glm::dmat4& unrealWorldToTileset) {
+
+  double horizontalFieldOfView =
+      FMath::DegreesToRadians(camera.FieldOfViewDegrees);
+  double aspectRatio = camera.ViewportSize.X / camera.ViewportSize.Y;
+  double verticalFieldOfView =
+      atan(tan(horizontalFieldOfView * 0.5) / aspectRatio) * 2.0;
+
+  FVector direction = camera.Rotation.RotateVector(FVector(1.0f, 0.0f, 0.0f));
+  FVector up = camera.Rotation.RotateVector(FVector(0.0f, 0.0f, 1.0f));
+
+  glm::dvec3 tilesetCameraLocation = glm::dvec3(
+      unrealWorldToTileset *
+      glm::dvec4(camera.Location.X, camera.Location.Y, camera.Location.Z, 1.0));
+  glm::dvec3 tilesetCameraFront = glm::normalize(glm::dvec3(
+      unrealWorldToTileset *
+      glm::dvec4(direction.X, direction.Y, direction.Z, 0.0)));
+  glm::dvec3 tilesetCameraUp = glm::normalize(
+      glm::dvec3(unrealWorldToTileset * glm::dvec4(up.X, up.Y, up.Z, 0.0)));
+
+  return Cesium3DTilesSelection::ViewState::create(
+      tilesetCameraLocation,
+      tilesetCameraFront,
+      tilesetCameraUp,
+      glm::dvec2(camera.ViewportSize.X, camera.ViewportSize.Y),
+      horizontalFieldOfView,
+      verticalFieldOfView);
+}
+
+void UCesiumTilesetManager::RequestUpdate(ACesium3DTileset* pTileset) {
+  this->_tilesetsToUpdate.AddUnique(pTileset);
+}
+
+void UCesiumTilesetManager::Tick(float DeltaTime) {
+  if (this->_tilesetsToUpdate.Num() == 0) {
+    return;
+  }
+
+  std::vector<TilesetEntry> entries;
+  entries.reserve(this->_tilesetsToUpdate.Num());
+
+  for (const TWeakObjectPtr<ACesium3DTileset>& pWeakTileset :
+       this->_tilesetsToUpdate) {
+    ACesium3DTileset* pTileset = pWeakTileset.Get();
+    if (!IsValid(pTileset) || !pTileset->GetTileset()) {
+      continue;
+    }
+
+    const TilesetState* pState = this->_states.Find(pWeakTileset);
+    entries.push_back(TilesetEntry{
+        pTileset,
+        pState ? pState->demand : TilesetDemand(),
+        pTileset->MaximumSimultaneousTileLoads,
+        pTileset->MaximumCachedBytes});
+  }
+
+  this->_tilesetsToUpdate.Reset();
+
+  // Forget the state of tilesets that no longer exist.
+  for (auto it = this->_states.CreateIterator(); it; ++it) {
+    if (!it.Key().IsValid()) {
+      it.RemoveCurrent();
+    }
+  }
+
+  UCesiumCameraSubsystem* pCameraSubsystem = UCesiumCameraSubsystem::Get(this);
+  if (entries.empty() || !pCameraSubsystem) {
+    return;
+  }
+
+  const std::vector<FCesiumCamera>& cameras = pCameraSubsystem->GetCameras();
+  if (cameras.empty()) {
+    return;
+  }
+  size_t renderedCameraCount = pCameraSubsystem->GetRenderedCameraCount();
+
+  bool camerasUnchanged = cameras == this->_lastCameras;
+  this->_lastCameras = cameras;
+
+  const UCesiumRuntimeSettings* pSettings =
+      GetDefault<UCesiumRuntimeSettings>();
+  if (pSettings->LimitTotalSimultaneousTileLoads) {
+    this->distributeTileLoads(
+        entries,
+        pSettings->TotalMaximumSimultaneousTileLoads);
+  }
+  if (pSettings->LimitTotalCachedBytes) {
+    this->distributeCachedBytes(entries, pSettings->TotalMaximumCachedBytes);
+  }
+
+  const std::vector<FCesiumCamera>& prefetchCameras =
+      pCameraSubsystem->GetPrefetchCameras();
+
+  // Tilesets usually share a georeference and are often not transformed
+  // relative to it, so many of them use the very same view states.
+  struct TransformViewStates {
+    glm::dmat4 unrealWorldToTileset;
+    std::vector<Cesium3DTilesSelection::ViewState> frustums;
+    std::vector<Cesium3DTilesSelection::ViewState> prefetchFrustums;
+  };
+  std::vector<TransformViewStates> viewStatesByTransform;
+
+  for (TilesetEntry& entry : entries) {
+    Cesium3DTilesSelection::TilesetOptions& options =
+        entry.pTileset->GetTileset()->getOptions();
+    options.maximumSimultaneousTileLoads =
+        static_cast<uint32_t>(entry.maximumSimultaneousTileLoads);
+    // The budget covers the renderer resources too, but cesium-native only
+    // counts the tile content against it, so the renderer resources are taken
+    // out of the budget it is given.
+    int64 rendererBytes = entry.pTileset->GetMemoryUsage().GetRendererBytes();
+    options.maximumCachedBytes =
+        std::max(int64(0), entry.maximumCachedBytes - rendererBytes) +
+        entry.pTileset->GetLodTransitionCachedBytes();
+
+    glm::dmat4 unrealWorldToTileset = glm::affineInverse(
+        entry.pTileset->GetCesiumTilesetToUnrealRelativeWorldTransform());
+
+    auto viewStatesIt = std::find_if(
+        viewStatesByTransform.begin(),
+        viewStatesByTransform.end(),
+        [&unrealWorldToTileset](const TransformViewStates& viewStates) {
+          return viewStates.unrealWorldToTileset == unrealWorldToTileset;
+        });
+    if (viewStatesIt == viewStatesByTransform.end()) {
+      TransformViewStates viewStates{unrealWorldToTileset};
+      viewStates.frustums.reserve(cameras.size());
+      for (const FCesiumCamera& camera : cameras) {
+        viewStates.frustums.push_back(
+            CreateViewState(camera, unrealWorldToTileset));
+      }
+      viewStates.prefetchFrustums.reserve(prefetchCameras.size());
+      for (const FCesiumCamera& camera : prefetchCameras) {
+        viewStates.prefetchFrustums.push_back(
+            CreateViewState(camera, unrealWorldToTileset));
+      }
+      viewStatesByTransform.push_back(std::move(viewStates));
+      viewStatesIt = viewStatesByTransform.end() - 1;
+    }
+
+    TilesetState& state = this->_states.FindOrAdd(entry.pTileset);
+    bool viewsUnchanged = camerasUnchanged &&
+                          state.unrealWorldToTileset == unrealWorldToTileset;
+    state.unrealWorldToTileset = unrealWorldToTileset;
+
+    const Cesium3DTilesSelection::ViewUpdateResult* pResult =
+        entry.pTileset->UpdateView(
+            viewStatesIt->frustums,
+            renderedCameraCount,
+            viewsUnchanged);
+    if (pResult) {
+      TilesetDemand& demand = state.demand;
+      demand.tilesLoadingHighPriority = pResult->tilesLoadingHighPriority;
+      demand.tilesLoadingMediumPriority = pResult->tilesLoadingMediumPriority;
+      demand.tilesLoadingLowPriority = pResult->tilesLoadingLowPriority;
+      demand.tilesRendered = pResult->tilesToRenderThisFrame.size();
+    }
+
+    // Prefetching comes after the real views, so that the tiles needed right
+    // now are requested first.
+    entry.pTileset->UpdatePrefetch(viewStatesIt->prefetchFrustums);
+
+    entry.pTileset->UpdateStatistics(pResult);
+  }
+}
+
+void UCesiumTilesetManager::distributeTileLoads(
+    std::vector<TilesetEntry>& entries,
+    int32 totalTileLoads) const {
+  // Every tileset may load at least one tile at a time, so that none of them
+  // is starved. This may exceed the total if there are more tilesets than
+  // allowed loads.
+  std::vector<int32> limits(entries.size());
+  std::vector<int32> allocated(entries.size(), 0);
+  int32 remaining = totalTileLoads;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    limits[i] = entries[i].maximumSimultaneousTileLoads;
+    if (limits[i] > 0) {
+      allocated[i] = 1;
+      --remaining;
+    }
+  }
+
+  // Hand out the remaining loads one at a time, round-robin, first to satisfy
+  // the high priority demand of each tileset, then the medium and then the low
+  // priority demand. High priority tiles are the ones needed to meet the
+  // tileset's screen-space error in the current view.
+  auto distribute = [&](auto getWanted) {
+    bool progress = true;
+    while (remaining > 0 && progress) {
+      progress = false;
+      for (size_t i = 0; i < entries.size() && remaining > 0; ++i) {
+        int32 wanted = std::min(limits[i], getWanted(entries[i].demand));
+        if (allocated[i] < wanted) {
+          ++allocated[i];
+          --remaining;
+          progress = true;
+        }
+      }
+    }
+  };
+
+  distribute([](const TilesetDemand& demand) {
+    return static_cast<int32>(demand.tilesLoadingHighPriority);
+  });
+  distribute([](const TilesetDemand& demand) {
+    return static_cast<int32>(
+        demand.tilesLoadingHighPriority + demand.tilesLoadingMediumPriority);
+  });
+  distribute([](const TilesetDemand& demand) {
+    return static_cast<int32>(
+        demand.tilesLoadingHighPriority + demand.tilesLoadingMediumPriority +
+        demand.tilesLoadingLowPriority);
+  });
+
+  // Any loads left over are handed out too, so that demand that arises in this
+  // frame can be served immediately.
+  distribute([](const TilesetDemand&) { return MAX_int32; });
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    entries[i].maximumSimultaneousTileLoads = allocated[i];
+  }
+}
+
+void UCesiumTilesetManager::distributeCachedBytes(
+    std::vector<TilesetEntry>& entries,
+    int64 totalCachedBytes) const {
+  // Share the bytes in proportion to the number of rendered tiles, plus one so
+  // that tilesets that render nothing yet still get a share. Bytes that a
+  // tileset can't use because of its own limit are shared among the others.
+  std::vector<bool> capped(entries.size(), false);
+  int64 remaining = totalCachedBytes;
+
+  while (true) {
+    double totalWeight = 0.0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (!capped[i]) {
+        totalWeight += double(entries[i].demand.tilesRendered + 1);
+      }
+    }
+
+    if (totalWeight <= 0.0) {
+      break;
+    }
+
+    bool anyCapped = false;
+    int64 cappedBytes = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (capped[i]) {
+        continue;
+      }
+
+      double weight = double(entries[i].demand.tilesRendered + 1);
+      int64 share = static_cast<int64>(double(remaining) * weight / totalWeight);
+      if (share >= entries[i].maximumCachedBytes) {
+        capped[i] = true;
+        anyCapped = true;
+        cappedBytes += entries[i].maximumCachedBytes;
+      }
+    }
+
+    if (!anyCapped) {
+      for (size_t i = 0; i < entries.size(); ++i) {
+        if (!capped[i]) {
+          double weight = double(entries[i].demand.tilesRendered + 1);
+          entries[i].maximumCachedBytes =
+              static_cast<int64>(double(remaining) * weight / totalWeight);
+        }
+      }
+      break;
+    }
+
+    remaining -= cappedBytes;
+  }
+}
+
+ETickableTickType UCesiumTilesetManager::GetTickableTickType() const {
+  return this->HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never
+                                                  : ETickableTickType::Always;
+}
+
+UWorld* UCesiumTilesetManager::GetTickableGameObjectWorld() const {
+  return this->GetWorld();
+}
+
+TStatId UCesiumTilesetManager::GetStatId() const {
+  RETURN_QUICK_DECLARE_CYCLE_STAT(UCesiumTilesetManager, STATGROUP_Tickables);
+}
+
+void UCesiumTilesetManager::Deinitialize() {
+  this->_tilesetsToUpdate.Empty();
+  this->_states.Empty();
+  this->_lastCameras.clear();
+
+  Super::Deinitialize();
+}
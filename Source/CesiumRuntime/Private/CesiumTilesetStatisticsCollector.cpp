@@ -0,0 +1,361 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumTilesetStatisticsCollector.h"
+#include "Cesium3DTilesSelection/ViewUpdateResult.h"
+#include "HAL/PlatformTime.h"
+#include <algorithm>
+#include <cmath>
+
+DEFINE_STAT(STAT_CesiumTilesetTick);
+DEFINE_STAT(STAT_CesiumUpdateView);
+DEFINE_STAT(STAT_CesiumUpdatePrefetch);
+DEFINE_STAT(STAT_CesiumLoadThreadPrepare);
+DEFINE_STAT(STAT_CesiumMainThreadPrepare);
+
+CSV_DEFINE_CATEGORY(Cesium, true);
+
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Rendered"),
+    STAT_CesiumTilesRendered,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Waiting To Load"),
+    STAT_CesiumTilesWaitingToLoad,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests In Flight"),
+    STAT_CesiumRequestsInFlight,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Load Thread Prepares In Flight"),
+    STAT_CesiumLoadThreadPreparesInFlight,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Main Thread Prepares Pending"),
+    STAT_CesiumMainThreadPreparesPending,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Waiting To Be Shown"),
+    STAT_CesiumTilesWaitingToBeShown,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Requests Completed"),
+    STAT_CesiumRequestsCompleted,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Cache Hits"),
+    STAT_CesiumCacheHits,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Bytes Downloaded"),
+    STAT_CesiumBytesDownloaded,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Created"),
+    STAT_CesiumTilesCreated,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Destroyed"),
+    STAT_CesiumTilesDestroyed,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Tiles Discarded Without Being Shown"),
+    STAT_CesiumTilesDiscarded,
+    STATGROUP_Cesium);
+
+CesiumTilesetStatisticsCollector::ScopedGameThreadTimer::ScopedGameThreadTimer(
+    CesiumTilesetStatisticsCollector& collector)
+    : _collector(collector), _startTime(FPlatformTime::Seconds()) {}
+
+CesiumTilesetStatisticsCollector::ScopedGameThreadTimer::
+    ~ScopedGameThreadTimer() {
+  this->_collector._gameThreadSeconds +=
+      FPlatformTime::Seconds() - this->_startTime;
+}
+
+CesiumTilesetStatisticsCollector::CesiumTilesetStatisticsCollector()
+    : _requestsInFlight(0),
+      _loadThreadPreparesInFlight(0),
+      _mainThreadPreparesPending(0),
+      _tilesWaitingToBeShown(0),
+      _requests(0),
+      _downloads(0),
+      _bytesDownloaded(0),
+      _tilesShown(0),
+      _tilesDiscarded(0),
+      _tilesCreated(0),
+      _tilesDestroyed(0),
+      _gameThreadSeconds(0.0),
+      _lastRequests(0),
+      _lastDownloads(0),
+      _lastBytesDownloaded(0),
+      _lastTilesDiscarded(0),
+      _latencyMutex(),
+      _requestLatency(),
+      _loadThreadLatency(),
+      _mainThreadLatency(),
+      _statistics() {}
+
+void CesiumTilesetStatisticsCollector::beginRequest() noexcept {
+  ++this->_requestsInFlight;
+}
+
+void CesiumTilesetStatisticsCollector::endRequest(double seconds) noexcept {
+  --this->_requestsInFlight;
+  ++this->_requests;
+
+  std::lock_guard<std::mutex> lock(this->_latencyMutex);
+  this->_requestLatency.add(seconds);
+}
+
+void CesiumTilesetStatisticsCollector::recordDownload(int64 bytes) noexcept {
+  ++this->_downloads;
+  this->_bytesDownloaded += bytes;
+}
+
+void CesiumTilesetStatisticsCollector::beginLoadThreadPrepare() noexcept {
+  ++this->_loadThreadPreparesInFlight;
+}
+
+void CesiumTilesetStatisticsCollector::endLoadThreadPrepare(
+    double seconds,
+    bool hasResult) noexcept {
+  if (hasResult) {
+    ++this->_mainThreadPreparesPending;
+  }
+  --this->_loadThreadPreparesInFlight;
+
+  std::lock_guard<std::mutex> lock(this->_latencyMutex);
+  this->_loadThreadLatency.add(seconds);
+}
+
+void CesiumTilesetStatisticsCollector::recordMainThreadPrepare(
+    bool created) noexcept {
+  --this->_mainThreadPreparesPending;
+  if (created) {
+    ++this->_tilesWaitingToBeShown;
+  }
+}
+
+void CesiumTilesetStatisticsCollector::recordTileShown(
+    double seconds) noexcept {
+  --this->_tilesWaitingToBeShown;
+  ++this->_tilesShown;
+  ++this->_tilesCreated;
+
+  std::lock_guard<std::mutex> lock(this->_latencyMutex);
+  this->_mainThreadLatency.add(seconds);
+}
+
+void CesiumTilesetStatisticsCollector::discardLoadThreadResult() noexcept {
+  --this->_mainThreadPreparesPending;
+  ++this->_tilesDiscarded;
+}
+
+void CesiumTilesetStatisticsCollector::recordTileDestroyed(
+    bool shown) noexcept {
+  if (shown) {
+    ++this->_tilesDestroyed;
+  } else {
+    --this->_tilesWaitingToBeShown;
+    ++this->_tilesDiscarded;
+  }
+}
+
+void CesiumTilesetStatisticsCollector::endFrame(
+    const Cesium3DTilesSelection::ViewUpdateResult* pResult) {
+  FCesiumTilesetStatistics& statistics = this->_statistics;
+
+  if (pResult) {
+    statistics.TilesRendered =
+        static_cast<int32>(pResult->tilesToRenderThisFrame.size());
+    statistics.TilesWaitingToLoad = static_cast<int32>(
+        pResult->tilesLoadingLowPriority + pResult->tilesLoadingMediumPriority +
+        pResult->tilesLoadingHighPriority);
+  }
+
+  statistics.RequestsInFlight = this->_requestsInFlight;
+  statistics.LoadThreadPreparesInFlight = this->_loadThreadPreparesInFlight;
+  statistics.MainThreadPreparesPending = this->_mainThreadPreparesPending;
+  statistics.TilesWaitingToBeShown = this->_tilesWaitingToBeShown;
+
+  // Downloads are recorded before their request completes, so there may
+  // briefly be more downloads than completed requests.
+  int64 requests = this->_requests;
+  int64 downloads = std::min(int64(this->_downloads), requests);
+  int64 bytesDownloaded = this->_bytesDownloaded;
+  statistics.Requests = requests;
+  statistics.CacheHits = requests - downloads;
+  statistics.CacheHitRate =
+      requests > 0 ? float(double(requests - downloads) / double(requests))
+                   : 0.0f;
+  statistics.BytesDownloaded = bytesDownloaded;
+
+  int64 tilesShown = this->_tilesShown;
+  int64 tilesDiscarded = this->_tilesDiscarded;
+  statistics.TilesShown = tilesShown;
+  statistics.TilesDiscarded = tilesDiscarded;
+  statistics.DiscardedTileRate =
+      tilesShown + tilesDiscarded > 0
+          ? float(double(tilesDiscarded) / double(tilesShown + tilesDiscarded))
+          : 0.0f;
+
+  statistics.TilesCreatedLastFrame = this->_tilesCreated.exchange(0);
+  statistics.TilesDestroyedLastFrame = this->_tilesDestroyed.exchange(0);
+  statistics.GameThreadMilliseconds = float(this->_gameThreadSeconds * 1000.0);
+  this->_gameThreadSeconds = 0.0;
+
+  {
+    std::lock_guard<std::mutex> lock(this->_latencyMutex);
+    statistics.RequestLatency = this->_requestLatency.toStatistics();
+    statistics.LoadThreadLatency = this->_loadThreadLatency.toStatistics();
+    statistics.MainThreadLatency = this->_mainThreadLatency.toStatistics();
+  }
+
+  int32 requestsCompleted = static_cast<int32>(requests - this->_lastRequests);
+  int32 cacheHits = static_cast<int32>(
+      requestsCompleted - (downloads - this->_lastDownloads));
+  int32 frameBytesDownloaded =
+      static_cast<int32>(bytesDownloaded - this->_lastBytesDownloaded);
+  this->_lastRequests = requests;
+  this->_lastDownloads = downloads;
+  this->_lastBytesDownloaded = bytesDownloaded;
+
+  int32 frameTilesDiscarded =
+      static_cast<int32>(tilesDiscarded - this->_lastTilesDiscarded);
+  this->_lastTilesDiscarded = tilesDiscarded;
+
+  INC_DWORD_STAT_BY(STAT_CesiumTilesRendered, statistics.TilesRendered);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumTilesWaitingToLoad,
+      statistics.TilesWaitingToLoad);
+  INC_DWORD_STAT_BY(STAT_CesiumRequestsInFlight, statistics.RequestsInFlight);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumLoadThreadPreparesInFlight,
+      statistics.LoadThreadPreparesInFlight);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumMainThreadPreparesPending,
+      statistics.MainThreadPreparesPending);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumTilesWaitingToBeShown,
+      statistics.TilesWaitingToBeShown);
+  INC_DWORD_STAT_BY(STAT_CesiumRequestsCompleted, requestsCompleted);
+  INC_DWORD_STAT_BY(STAT_CesiumCacheHits, cacheHits);
+  INC_DWORD_STAT_BY(STAT_CesiumBytesDownloaded, frameBytesDownloaded);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumTilesCreated,
+      statistics.TilesCreatedLastFrame);
+  INC_DWORD_STAT_BY(
+      STAT_CesiumTilesDestroyed,
+      statistics.TilesDestroyedLastFrame);
+  INC_DWORD_STAT_BY(STAT_CesiumTilesDiscarded, frameTilesDiscarded);
+
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesRendered,
+      statistics.TilesRendered,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesWaitingToLoad,
+      statistics.TilesWaitingToLoad,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      RequestsInFlight,
+      statistics.RequestsInFlight,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      LoadThreadPreparesInFlight,
+      statistics.LoadThreadPreparesInFlight,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      MainThreadPreparesPending,
+      statistics.MainThreadPreparesPending,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesWaitingToBeShown,
+      statistics.TilesWaitingToBeShown,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      RequestsCompleted,
+      requestsCompleted,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(Cesium, CacheHits, cacheHits, ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      BytesDownloaded,
+      frameBytesDownloaded,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesCreated,
+      statistics.TilesCreatedLastFrame,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesDestroyed,
+      statistics.TilesDestroyedLastFrame,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      TilesDiscarded,
+      frameTilesDiscarded,
+      ECsvCustomStatOp::Accumulate);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      GameThreadMs,
+      statistics.GameThreadMilliseconds,
+      ECsvCustomStatOp::Accumulate);
+}
+
+void CesiumTilesetStatisticsCollector::reset() {
+  this->_requests = 0;
+  this->_downloads = 0;
+  this->_bytesDownloaded = 0;
+  this->_lastRequests = 0;
+  this->_lastDownloads = 0;
+  this->_lastBytesDownloaded = 0;
+  this->_tilesShown = 0;
+  this->_tilesDiscarded = 0;
+  this->_lastTilesDiscarded = 0;
+
+  std::lock_guard<std::mutex> lock(this->_latencyMutex);
+  this->_requestLatency = Latency();
+  this->_loadThreadLatency = Latency();
+  this->_mainThreadLatency = Latency();
+}
+
+void CesiumTilesetStatisticsCollector::Latency::add(double seconds) noexcept {
+  ++this->count;
+  this->totalSeconds += seconds;
+  this->maximumSeconds = std::max(this->maximumSeconds, seconds);
+
+  // The first bucket holds times below 1 ms, each following one holds times
+  // up to twice as long as the previous one.
+  double milliseconds = seconds * 1000.0;
+  size_t bucket = 0;
+  if (milliseconds >= 1.0) {
+    bucket = std::min(
+        static_cast<size_t>(std::log2(milliseconds)) + 1,
+        latencyHistogramSize - 1);
+  }
+  ++this->histogram[bucket];
+}
+
+FCesiumLatencyStatistics
+CesiumTilesetStatisticsCollector::Latency::toStatistics() const {
+  FCesiumLatencyStatistics result;
+  result.Count = this->count;
+  result.AverageMilliseconds =
+      this->count > 0
+          ? float(this->totalSeconds * 1000.0 / double(this->count))
+          : 0.0f;
+  result.MaximumMilliseconds = float(this->maximumSeconds * 1000.0);
+  result.Histogram.Append(this->histogram.data(), this->histogram.size());
+  return result;
+}
@@ -0,0 +1,201 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumTilesetStatistics.h"
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace Cesium3DTilesSelection {
+class ViewUpdateResult;
+}
+
+DECLARE_STATS_GROUP(TEXT("Cesium"), STATGROUP_Cesium, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(
+    TEXT("Tileset Tick"),
+    STAT_CesiumTilesetTick,
+    STATGROUP_Cesium, );
+DECLARE_CYCLE_STAT_EXTERN(
+    TEXT("Update View"),
+    STAT_CesiumUpdateView,
+    STATGROUP_Cesium, );
+DECLARE_CYCLE_STAT_EXTERN(
+    TEXT("Update Prefetch"),
+    STAT_CesiumUpdatePrefetch,
+    STATGROUP_Cesium, );
+DECLARE_CYCLE_STAT_EXTERN(
+    TEXT("Load Thread Prepare"),
+    STAT_CesiumLoadThreadPrepare,
+    STATGROUP_Cesium, );
+DECLARE_CYCLE_STAT_EXTERN(
+    TEXT("Main Thread Prepare"),
+    STAT_CesiumMainThreadPrepare,
+    STATGROUP_Cesium, );
+
+CSV_DECLARE_CATEGORY_EXTERN(Cesium);
+
+/**
+ * @brief Collects the statistics of the tile loading pipeline of a tileset.
+ *
+ * The pipeline reports its progress from the game thread, from worker threads
+ * and from the threads that complete requests, so all recording methods are
+ * thread-safe. Once per frame, {@link endFrame} turns what was recorded into
+ * the statistics exposed to Blueprints, and adds them to the `STAT_` counters
+ * of the "Cesium" stats group and to the "Cesium" CSV profiler category, which
+ * sum up all tilesets.
+ */
+class CesiumTilesetStatisticsCollector {
+public:
+  /**
+   * @brief Measures the time spent in the game thread until the end of the
+   * scope.
+   */
+  class ScopedGameThreadTimer {
+  public:
+    ScopedGameThreadTimer(CesiumTilesetStatisticsCollector& collector);
+    ~ScopedGameThreadTimer();
+
+  private:
+    CesiumTilesetStatisticsCollector& _collector;
+    double _startTime;
+  };
+
+  CesiumTilesetStatisticsCollector();
+
+  /**
+   * @brief Records that a request was started.
+   */
+  void beginRequest() noexcept;
+
+  /**
+   * @brief Records that a request completed, successfully or not.
+   *
+   * @param seconds The time since the request was started.
+   */
+  void endRequest(double seconds) noexcept;
+
+  /**
+   * @brief Records that a request was not answered from the request cache and
+   * its response was downloaded instead.
+   *
+   * @param bytes The size of the response.
+   */
+  void recordDownload(int64 bytes) noexcept;
+
+  /**
+   * @brief Records that a tile started being prepared in a worker thread.
+   */
+  void beginLoadThreadPrepare() noexcept;
+
+  /**
+   * @brief Records that a tile was prepared in a worker thread.
+   *
+   * @param seconds The time the preparation took.
+   * @param hasResult Whether the preparation produced a result that is passed
+   * on to the game thread.
+   */
+  void endLoadThreadPrepare(double seconds, bool hasResult) noexcept;
+
+  /**
+   * @brief Records that a tile that was prepared in a worker thread was
+   * prepared in the game thread.
+   *
+   * @param created Whether an Unreal component was created for the tile. Its
+   * primitives are only created when the tile is first shown.
+   */
+  void recordMainThreadPrepare(bool created) noexcept;
+
+  /**
+   * @brief Records that the primitives of a tile were created, because it was
+   * shown for the first time.
+   *
+   * @param seconds The time creating the primitives took.
+   */
+  void recordTileShown(double seconds) noexcept;
+
+  /**
+   * @brief Records that the result of preparing a tile in a worker thread was
+   * discarded, because the tile was unloaded before it was prepared in the
+   * game thread. The tile counts as discarded without being shown.
+   */
+  void discardLoadThreadResult() noexcept;
+
+  /**
+   * @brief Records that the Unreal component of a tile was destroyed.
+   *
+   * @param shown Whether the tile was ever shown. If not, no primitives were
+   * created for it, and the work of loading and preparing it was wasted.
+   */
+  void recordTileDestroyed(bool shown) noexcept;
+
+  /**
+   * @brief Finishes the statistics of the current frame.
+   *
+   * @param pResult The result of the tile selection in this frame, or nullptr
+   * if it was skipped, in which case the result of the previous one is still
+   * up to date.
+   */
+  void endFrame(const Cesium3DTilesSelection::ViewUpdateResult* pResult);
+
+  /**
+   * @brief Gets the statistics as of the last call to {@link endFrame}.
+   */
+  const FCesiumTilesetStatistics& getStatistics() const noexcept {
+    return this->_statistics;
+  }
+
+  /**
+   * @brief Resets the counts and latencies that are accumulated over time.
+   */
+  void reset();
+
+private:
+  static constexpr size_t latencyHistogramSize = 12;
+
+  struct Latency {
+    int64 count = 0;
+    double totalSeconds = 0.0;
+    double maximumSeconds = 0.0;
+    std::array<int64, latencyHistogramSize> histogram{};
+
+    void add(double seconds) noexcept;
+    FCesiumLatencyStatistics toStatistics() const;
+  };
+
+  // The counts of work that is currently in flight.
+  std::atomic<int32> _requestsInFlight;
+  std::atomic<int32> _loadThreadPreparesInFlight;
+  std::atomic<int32> _mainThreadPreparesPending;
+  std::atomic<int32> _tilesWaitingToBeShown;
+
+  // The counts that are accumulated over time.
+  std::atomic<int64> _requests;
+  std::atomic<int64> _downloads;
+  std::atomic<int64> _bytesDownloaded;
+  std::atomic<int64> _tilesShown;
+  std::atomic<int64> _tilesDiscarded;
+
+  // The counts since the last call to endFrame.
+  std::atomic<int32> _tilesCreated;
+  std::atomic<int32> _tilesDestroyed;
+  double _gameThreadSeconds;
+
+  // The values as of the last call to endFrame, to report the difference in
+  // the per-frame counters.
+  int64 _lastRequests;
+  int64 _lastDownloads;
+  int64 _lastBytesDownloaded;
+  int64 _lastTilesDiscarded;
+
+  std::mutex _latencyMutex;
+  Latency _requestLatency;
+  Latency _loadThreadLatency;
+  Latency _mainThreadLatency;
+
+  FCesiumTilesetStatistics _statistics;
+};
@@ -0,0 +1,348 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#include "CesiumWorkerPool.h"
+#include "Async/Async.h"
+#include "CesiumRuntimeSettings.h"
+#include "CesiumTilesetStatisticsCollector.h"
+#include "HAL/PlatformAffinity.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include <algorithm>
+
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("High Priority Tasks Queued"),
+    STAT_CesiumHighPriorityTasksQueued,
+    STATGROUP_Cesium);
+DECLARE_DWORD_COUNTER_STAT(
+    TEXT("Low Priority Tasks Queued"),
+    STAT_CesiumLowPriorityTasksQueued,
+    STATGROUP_Cesium);
+DECLARE_FLOAT_COUNTER_STAT(
+    TEXT("High Priority Task Wait (ms)"),
+    STAT_CesiumHighPriorityTaskWait,
+    STATGROUP_Cesium);
+DECLARE_FLOAT_COUNTER_STAT(
+    TEXT("Low Priority Task Wait (ms)"),
+    STAT_CesiumLowPriorityTaskWait,
+    STATGROUP_Cesium);
+DECLARE_FLOAT_COUNTER_STAT(
+    TEXT("High Priority Task Maximum Wait (ms)"),
+    STAT_CesiumHighPriorityTaskMaximumWait,
+    STATGROUP_Cesium);
+DECLARE_FLOAT_COUNTER_STAT(
+    TEXT("Low Priority Task Maximum Wait (ms)"),
+    STAT_CesiumLowPriorityTaskMaximumWait,
+    STATGROUP_Cesium);
+
+namespace {
+// The index of the worker that runs on the current thread, if any.
+thread_local int32 currentWorkerIndex = INDEX_NONE;
+} // namespace
+
+class CesiumWorkerPool::Worker : public FRunnable {
+public:
+  Worker(CesiumWorkerPool& pool, int32 index) : _pool(pool), _index(index) {}
+
+  virtual uint32 Run() override {
+    currentWorkerIndex = this->_index;
+    while (!this->_pool._stopping) {
+      if (!this->_pool.runNextTask(this->_index)) {
+        this->_pool.waitForTask();
+      }
+    }
+    currentWorkerIndex = INDEX_NONE;
+    return 0;
+  }
+
+private:
+  CesiumWorkerPool& _pool;
+  int32 _index;
+};
+
+/*static*/ void CesiumWorkerPool::startTask(
+    Priority priority,
+    std::function<void()>&& task) {
+  CesiumWorkerPool* pPool = CesiumWorkerPool::getInstance(true);
+  if (pPool && pPool->queueTask(priority, std::move(task))) {
+    return;
+  }
+
+  AsyncTask(ENamedThreads::Type::AnyThread, [task = std::move(task)]() {
+    task();
+  });
+}
+
+/*static*/ void CesiumWorkerPool::publishStatistics() {
+  CesiumWorkerPool* pPool = CesiumWorkerPool::getInstance(false);
+  if (!pPool) {
+    return;
+  }
+
+  Statistics high = pPool->takeStatistics(Priority::High);
+  Statistics low = pPool->takeStatistics(Priority::Low);
+
+  SET_DWORD_STAT(STAT_CesiumHighPriorityTasksQueued, high.queueLength);
+  SET_DWORD_STAT(STAT_CesiumLowPriorityTasksQueued, low.queueLength);
+  SET_FLOAT_STAT(
+      STAT_CesiumHighPriorityTaskWait,
+      high.averageWaitMilliseconds);
+  SET_FLOAT_STAT(STAT_CesiumLowPriorityTaskWait, low.averageWaitMilliseconds);
+  SET_FLOAT_STAT(
+      STAT_CesiumHighPriorityTaskMaximumWait,
+      high.maximumWaitMilliseconds);
+  SET_FLOAT_STAT(
+      STAT_CesiumLowPriorityTaskMaximumWait,
+      low.maximumWaitMilliseconds);
+
+  CSV_CUSTOM_STAT(
+      Cesium,
+      HighPriorityTasksQueued,
+      high.queueLength,
+      ECsvCustomStatOp::Set);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      LowPriorityTasksQueued,
+      low.queueLength,
+      ECsvCustomStatOp::Set);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      HighPriorityTaskWaitMs,
+      static_cast<float>(high.averageWaitMilliseconds),
+      ECsvCustomStatOp::Set);
+  CSV_CUSTOM_STAT(
+      Cesium,
+      LowPriorityTaskWaitMs,
+      static_cast<float>(low.averageWaitMilliseconds),
+      ECsvCustomStatOp::Set);
+}
+
+/*static*/ void CesiumWorkerPool::shutdown() {
+  CesiumWorkerPool* pPool = CesiumWorkerPool::getInstance(false);
+  if (pPool) {
+    pPool->stop();
+  }
+}
+
+/*static*/ CesiumWorkerPool* CesiumWorkerPool::getInstance(bool create) {
+  static std::atomic<CesiumWorkerPool*> pInstance{nullptr};
+  static std::mutex instanceMutex;
+  static std::unique_ptr<CesiumWorkerPool> pOwner;
+
+  CesiumWorkerPool* pPool = pInstance.load(std::memory_order_acquire);
+  if (pPool || !create) {
+    return pPool;
+  }
+
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  if (!pOwner) {
+    const UCesiumRuntimeSettings* pSettings =
+        GetDefault<UCesiumRuntimeSettings>();
+    int32 threadCount = pSettings->WorkerThreadCount > 0
+                            ? pSettings->WorkerThreadCount
+                            : FPlatformMisc::NumberOfWorkerThreadsToSpawn();
+    uint64 affinityMask =
+        pSettings->WorkerThreadAffinityMask != 0
+            ? static_cast<uint64>(pSettings->WorkerThreadAffinityMask)
+            : FPlatformAffinity::GetNoAffinityMask();
+
+    pOwner.reset(
+        new CesiumWorkerPool(FMath::Max(threadCount, 1), affinityMask));
+    pInstance.store(pOwner.get(), std::memory_order_release);
+  }
+  return pOwner.get();
+}
+
+CesiumWorkerPool::CesiumWorkerPool(int32 threadCount, uint64 affinityMask)
+    : _lanes(),
+      _workers(),
+      _threads(),
+      _wakeMutex(),
+      _wakeCondition(),
+      _queuedTasks(0),
+      _stopping(false) {
+  for (Lane& lane : this->_lanes) {
+    for (int32 i = 0; i < threadCount; ++i) {
+      lane.local.push_back(std::make_unique<Queue>());
+    }
+  }
+
+  for (int32 i = 0; i < threadCount; ++i) {
+    std::unique_ptr<Worker> pWorker = std::make_unique<Worker>(*this, i);
+    FRunnableThread* pThread = FRunnableThread::Create(
+        pWorker.get(),
+        *FString::Printf(TEXT("CesiumWorker %d"), i),
+        0,
+        TPri_Normal,
+        affinityMask);
+    if (pThread) {
+      this->_workers.push_back(std::move(pWorker));
+      this->_threads.push_back(pThread);
+    }
+  }
+
+  // Without threads, for example when multithreading is disabled, the tasks
+  // are left to Unreal's task graph.
+  if (this->_threads.empty()) {
+    this->_stopping = true;
+  }
+}
+
+CesiumWorkerPool::~CesiumWorkerPool() { this->stop(); }
+
+bool CesiumWorkerPool::queueTask(
+    Priority priority,
+    std::function<void()>&& task) {
+  if (this->_stopping) {
+    return false;
+  }
+
+  Lane& lane = this->getLane(priority);
+  Queue& queue = currentWorkerIndex != INDEX_NONE
+                     ? *lane.local[currentWorkerIndex]
+                     : lane.shared;
+  {
+    // Checking again under the lock of the queue ensures that stop either
+    // sees the task when it drains the queue, or that it is not queued.
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (this->_stopping) {
+      return false;
+    }
+    queue.tasks.push_back(Task{std::move(task), FPlatformTime::Seconds()});
+  }
+  ++lane.length;
+  ++this->_queuedTasks;
+
+  // Taking the lock ensures that a worker that found no tasks is either
+  // waiting already or will see this one before it waits.
+  {
+    std::lock_guard<std::mutex> lock(this->_wakeMutex);
+  }
+  this->_wakeCondition.notify_one();
+
+  return true;
+}
+
+bool CesiumWorkerPool::runNextTask(int32 workerIndex) {
+  // The lanes are in order of priority.
+  for (Lane& lane : this->_lanes) {
+    Task task;
+    if (lane.length <= 0 || !this->tryPopTask(lane, workerIndex, task)) {
+      continue;
+    }
+
+    --lane.length;
+    --this->_queuedTasks;
+
+    double waitSeconds = FPlatformTime::Seconds() - task.queueTime;
+    {
+      std::lock_guard<std::mutex> lock(lane.statisticsMutex);
+      ++lane.tasksStarted;
+      lane.totalWaitSeconds += waitSeconds;
+      lane.maximumWaitSeconds =
+          std::max(lane.maximumWaitSeconds, waitSeconds);
+    }
+
+    task.function();
+    return true;
+  }
+
+  return false;
+}
+
+bool CesiumWorkerPool::tryPopTask(Lane& lane, int32 workerIndex, Task& task) {
+  auto tryPopFront = [&task](Queue& queue) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+  };
+
+  if (tryPopFront(*lane.local[workerIndex]) || tryPopFront(lane.shared)) {
+    return true;
+  }
+
+  // Steal from the other workers, starting with the next one so that not all
+  // idle workers go for the same queue.
+  int32 workerCount = static_cast<int32>(lane.local.size());
+  for (int32 i = 1; i < workerCount; ++i) {
+    if (tryPopFront(*lane.local[(workerIndex + i) % workerCount])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void CesiumWorkerPool::waitForTask() {
+  std::unique_lock<std::mutex> lock(this->_wakeMutex);
+  this->_wakeCondition.wait(lock, [this]() {
+    return this->_queuedTasks > 0 || this->_stopping;
+  });
+}
+
+void CesiumWorkerPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->_wakeMutex);
+    this->_stopping = true;
+  }
+  this->_wakeCondition.notify_all();
+
+  for (FRunnableThread* pThread : this->_threads) {
+    pThread->WaitForCompletion();
+    delete pThread;
+  }
+  this->_threads.clear();
+
+  // The tasks that have not started yet are handed to Unreal's task graph,
+  // like the tasks started after the pool stopped, because the futures of
+  // cesium-native wait for them.
+  auto drain = [this](Lane& lane, Queue& queue) {
+    std::deque<Task> tasks;
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      tasks.swap(queue.tasks);
+    }
+    for (Task& task : tasks) {
+      --lane.length;
+      --this->_queuedTasks;
+      AsyncTask(
+          ENamedThreads::Type::AnyThread,
+          [function = std::move(task.function)]() { function(); });
+    }
+  };
+
+  // The lanes are in order of priority.
+  for (Lane& lane : this->_lanes) {
+    drain(lane, lane.shared);
+    for (const std::unique_ptr<Queue>& pQueue : lane.local) {
+      drain(lane, *pQueue);
+    }
+  }
+}
+
+CesiumWorkerPool::Statistics
+CesiumWorkerPool::takeStatistics(Priority priority) {
+  Lane& lane = this->getLane(priority);
+
+  Statistics statistics;
+  statistics.queueLength = lane.length;
+
+  std::lock_guard<std::mutex> lock(lane.statisticsMutex);
+  statistics.tasksStarted = lane.tasksStarted;
+  if (lane.tasksStarted > 0) {
+    statistics.averageWaitMilliseconds =
+        lane.totalWaitSeconds * 1000.0 / static_cast<double>(lane.tasksStarted);
+  }
+  statistics.maximumWaitMilliseconds = lane.maximumWaitSeconds * 1000.0;
+
+  lane.tasksStarted = 0;
+  lane.totalWaitSeconds = 0.0;
+  lane.maximumWaitSeconds = 0.0;
+
+  return statistics;
+}
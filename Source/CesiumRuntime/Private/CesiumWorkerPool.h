@@ -0,0 +1,134 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnrealTaskProcessor.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FRunnableThread;
+
+/**
+ * @brief The pool of worker threads that runs the tasks of cesium-native, such
+ * as parsing tiles and building their meshes.
+ *
+ * Each priority has its own queues, and a worker only runs a low priority task
+ * when no high priority task is waiting. A task started from a worker thread
+ * is queued to that worker, so that continuations tend to run on the thread
+ * that has their data in its cache, and idle workers steal tasks from the
+ * queues of busy ones.
+ *
+ * The pool is created on first use with the number of threads and affinity of
+ * the Cesium project settings, and stopped when the module shuts down.
+ */
+class CesiumWorkerPool {
+public:
+  using Priority = UnrealTaskProcessor::Priority;
+
+  /**
+   * @brief The statistics of the tasks of one priority.
+   */
+  struct Statistics {
+    /**
+     * @brief The number of tasks that are waiting to run.
+     */
+    int32 queueLength = 0;
+
+    /**
+     * @brief The number of tasks that started running since the statistics
+     * were last taken.
+     */
+    int64 tasksStarted = 0;
+
+    /**
+     * @brief The average time the tasks that started running since the
+     * statistics were last taken waited in the queue, in milliseconds.
+     */
+    double averageWaitMilliseconds = 0.0;
+
+    /**
+     * @brief The longest time one of those tasks waited, in milliseconds.
+     */
+    double maximumWaitMilliseconds = 0.0;
+  };
+
+  /**
+   * @brief Queues a task to run in the pool, creating the pool if needed.
+   *
+   * Once the pool is stopped, tasks are run in Unreal's task graph instead.
+   */
+  static void startTask(Priority priority, std::function<void()>&& task);
+
+  /**
+   * @brief Publishes the statistics of the pool to the "Cesium" stats group
+   * and CSV profiler category. Called once per frame.
+   */
+  static void publishStatistics();
+
+  /**
+   * @brief Stops the worker threads. Tasks that have not started yet are
+   * run in Unreal's task graph instead, like the tasks started afterwards.
+   */
+  static void shutdown();
+
+  ~CesiumWorkerPool();
+
+private:
+  struct Task {
+    std::function<void()> function;
+    double queueTime;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  struct Lane {
+    // The queue of tasks started from threads that are not workers.
+    Queue shared;
+    // The queue of tasks started from each worker.
+    std::vector<std::unique_ptr<Queue>> local;
+    std::atomic<int32> length{0};
+
+    std::mutex statisticsMutex;
+    int64 tasksStarted = 0;
+    double totalWaitSeconds = 0.0;
+    double maximumWaitSeconds = 0.0;
+  };
+
+  class Worker;
+
+  // Gets the pool, creating it first if create is true.
+  static CesiumWorkerPool* getInstance(bool create);
+
+  CesiumWorkerPool(int32 threadCount, uint64 affinityMask);
+
+  // Queues a task, or returns false if the pool is stopped.
+  bool queueTask(Priority priority, std::function<void()>&& task);
+  bool runNextTask(int32 workerIndex);
+  bool tryPopTask(Lane& lane, int32 workerIndex, Task& task);
+  void waitForTask();
+  void stop();
+  Statistics takeStatistics(Priority priority);
+
+  Lane& getLane(Priority priority) {
+    return this->_lanes[static_cast<size_t>(priority)];
+  }
+
+  std::array<Lane, 2> _lanes;
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::vector<FRunnableThread*> _threads;
+
+  std::mutex _wakeMutex;
+  std::condition_variable _wakeCondition;
+  std::atomic<int32> _queuedTasks;
+  std::atomic<bool> _stopping;
+};
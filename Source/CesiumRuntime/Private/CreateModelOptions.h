@@ -4,6 +4,8 @@
 
 struct CreateModelOptions {
   bool alwaysIncludeTangents = false;
+  bool mergeSmallPrimitives = false;
+  int32 maximumMergedPrimitiveVertices = 0;
 #if PHYSICS_INTERFACE_PHYSX
   IPhysXCooking* pPhysXCooking = nullptr;
 #endif
@@ -3,6 +3,8 @@
 #include "GlobeAwareDefaultPawn.h"
 #include "Camera/CameraComponent.h"
 #include "CesiumActors.h"
+#include "CesiumCamera.h"
+#include "CesiumCameraSubsystem.h"
 #include "CesiumCustomVersion.h"
 #include "CesiumGeoreference.h"
 #include "CesiumGeospatial/Ellipsoid.h"
@@ -12,6 +14,7 @@
 #include "CesiumTransforms.h"
 #include "CesiumUtility/Math.h"
 #include "DrawDebugHelpers.h"
+#include "Engine/GameViewportClient.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
 #include "VecMath.h"
@@ -183,6 +186,8 @@ void AGlobeAwareDefaultPawn::FlyToLocationECEF(
   // Tell the tick we will be flying from now
   this->_bFlyingToLocation = true;
   this->_bCanInterruptFlight = CanInterruptByMoving;
+
+  this->_addFlightPrefetchCameras();
 }
 
 void AGlobeAwareDefaultPawn::InaccurateFlyToLocationECEF(
@@ -261,6 +266,7 @@ void AGlobeAwareDefaultPawn::_handleFlightStep(float DeltaSeconds) {
   // double check that we don't have an empty list of keypoints
   if (this->_keypoints.size() == 0) {
     this->_bFlyingToLocation = false;
+    this->_removeFlightPrefetchCameras();
     return;
   }
 
@@ -271,6 +277,7 @@ void AGlobeAwareDefaultPawn::_handleFlightStep(float DeltaSeconds) {
     Controller->SetControlRotation(this->_flyToDestinationRotation.Rotator());
     this->_bFlyingToLocation = false;
     this->_currentFlyTime = 0.0;
+    this->_removeFlightPrefetchCameras();
     return;
   }
 
@@ -312,12 +319,92 @@ void AGlobeAwareDefaultPawn::_handleFlightStep(float DeltaSeconds) {
   Controller->SetControlRotation(currentQuat.Rotator());
 }
 
+void AGlobeAwareDefaultPawn::_addFlightPrefetchCameras() {
+  this->_removeFlightPrefetchCameras();
+
+  UCesiumCameraSubsystem* pCameraSubsystem = UCesiumCameraSubsystem::Get(this);
+  ACesiumGeoreference* pGeoreference = this->GetGeoreference();
+  APlayerController* pPlayerController = Cast<APlayerController>(Controller);
+  if (!pCameraSubsystem || !IsValid(pGeoreference) || !pPlayerController ||
+      !pPlayerController->PlayerCameraManager || this->_keypoints.empty()) {
+    return;
+  }
+
+  UGameViewportClient* pViewport = this->GetWorld()->GetGameViewport();
+  if (!pViewport) {
+    return;
+  }
+
+  FVector2D size;
+  pViewport->GetViewportSize(size);
+  if (size.X < 1.0 || size.Y < 1.0) {
+    return;
+  }
+
+  float fov = pPlayerController->PlayerCameraManager->GetFOVAngle();
+
+  // A few views spread evenly along the flight are enough, because the tiles
+  // they need overlap with the ones needed in between. The last view is the
+  // destination, which matters most.
+  const int32 maximumViews = 8;
+  int32 views = FMath::Min(
+      maximumViews,
+      static_cast<int32>(this->_keypoints.size()) - 1);
+  views = FMath::Max(views, 1);
+
+  TArray<FCesiumCamera> cameras;
+  cameras.Reserve(views);
+  for (int32 view = 1; view <= views; ++view) {
+    double percentage = static_cast<double>(view) / views;
+    size_t index = static_cast<size_t>(
+        glm::round(percentage * (this->_keypoints.size() - 1)));
+
+    FVector location = VecMath::createVector(
+        pGeoreference->TransformEcefToUnreal(this->_keypoints[index]));
+
+    // Same as in _handleFlightStep and GetViewRotation: interpolate in the ESU
+    // frame, and transform to the Unreal world frame at the location.
+    FQuat localRotation = FQuat::Slerp(
+        this->_flyToSourceRotation,
+        this->_flyToDestinationRotation,
+        percentage);
+    FMatrix enuAdjustmentMatrix =
+        pGeoreference->InaccurateComputeEastNorthUpToUnreal(location);
+    FRotator rotation(enuAdjustmentMatrix.ToQuat() * localRotation);
+
+    cameras.Emplace(size, location, rotation, fov);
+  }
+
+  this->_flightPrefetchId = pCameraSubsystem->AddPrefetchCameras(cameras);
+}
+
+void AGlobeAwareDefaultPawn::_removeFlightPrefetchCameras() {
+  if (this->_flightPrefetchId < 0) {
+    return;
+  }
+
+  UCesiumCameraSubsystem* pCameraSubsystem = UCesiumCameraSubsystem::Get(this);
+  if (pCameraSubsystem) {
+    pCameraSubsystem->RemovePrefetchCameras(this->_flightPrefetchId);
+  }
+  this->_flightPrefetchId = -1;
+}
+
 void AGlobeAwareDefaultPawn::Tick(float DeltaSeconds) {
   Super::Tick(DeltaSeconds);
 
   _handleFlightStep(DeltaSeconds);
 }
 
+void AGlobeAwareDefaultPawn::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+  // A flight that is still in progress must not leave its views behind, or
+  // tilesets would keep prefetching for them.
+  this->_bFlyingToLocation = false;
+  this->_removeFlightPrefetchCameras();
+
+  Super::EndPlay(EndPlayReason);
+}
+
 void AGlobeAwareDefaultPawn::PostLoad() {
   Super::PostLoad();
 
@@ -379,6 +466,7 @@ void AGlobeAwareDefaultPawn::_interruptFlight() {
   }
 
   this->_bFlyingToLocation = false;
+  this->_removeFlightPrefetchCameras();
 
   // fix camera roll to 0.0
   FRotator currentRotator = Controller->GetControlRotation();
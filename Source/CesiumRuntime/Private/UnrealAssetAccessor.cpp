@@ -4,6 +4,7 @@
 #include "CesiumAsync/AsyncSystem.h"
 #include "CesiumAsync/IAssetRequest.h"
 #include "CesiumAsync/IAssetResponse.h"
+#include "CesiumRequestScheduler.h"
 #include "HttpManager.h"
 #include "HttpModule.h"
 #include "Interfaces/IHttpRequest.h"
@@ -12,31 +13,51 @@
 #include "Misc/App.h"
 #include "Misc/EngineVersion.h"
 #include <cstddef>
+#include <mutex>
 #include <optional>
 #include <set>
 
+/**
+ * Parses Unreal's "Name: Value" header lines. The name and value are converted
+ * to UTF-8 straight from the line, without creating an FString for each.
+ */
 static CesiumAsync::HttpHeaders
 parseHeaders(const TArray<FString>& unrealHeaders) {
   CesiumAsync::HttpHeaders result;
   for (const FString& header : unrealHeaders) {
-    int32_t separator = -1;
-    if (header.FindChar(':', separator)) {
-      FString fstrKey = header.Left(separator);
-      FString fstrValue = header.Right(header.Len() - separator - 2);
-      std::string key = std::string(TCHAR_TO_UTF8(*fstrKey));
-      std::string value = std::string(TCHAR_TO_UTF8(*fstrValue));
-      result.insert({std::move(key), std::move(value)});
+    int32 separator = INDEX_NONE;
+    if (!header.FindChar(':', separator)) {
+      continue;
     }
+
+    int32 valueStart = separator + 1;
+    while (valueStart < header.Len() &&
+           FChar::IsWhitespace(header[valueStart])) {
+      ++valueStart;
+    }
+
+    FTCHARToUTF8 key(*header, separator);
+    FTCHARToUTF8 value(*header + valueStart, header.Len() - valueStart);
+    result.emplace(
+        std::string(key.Get(), key.Length()),
+        std::string(value.Get(), value.Length()));
   }
 
   return result;
 }
 
+/**
+ * The response of an Unreal HTTP request.
+ *
+ * The headers are only parsed when they are first accessed. Responses are
+ * created in the request's completion callback, which Unreal runs in the game
+ * thread, while the headers are read by the request cache in a worker thread,
+ * if at all. The content type is looked up directly.
+ */
 class UnrealAssetResponse : public CesiumAsync::IAssetResponse {
 public:
   UnrealAssetResponse(FHttpResponsePtr pResponse)
-      : _pResponse(pResponse),
-        _headers(parseHeaders(pResponse->GetAllHeaders())) {}
+      : _pResponse(pResponse), _headersParsed(), _headers() {}
 
   virtual uint16_t statusCode() const override {
     return this->_pResponse->GetResponseCode();
@@ -47,6 +68,9 @@ public:
   }
 
   virtual const CesiumAsync::HttpHeaders& headers() const override {
+    std::call_once(this->_headersParsed, [this]() {
+      this->_headers = parseHeaders(this->_pResponse->GetAllHeaders());
+    });
     return this->_headers;
   }
 
@@ -59,25 +83,38 @@ public:
 
 private:
   FHttpResponsePtr _pResponse;
-  CesiumAsync::HttpHeaders _headers;
+  mutable std::once_flag _headersParsed;
+  mutable CesiumAsync::HttpHeaders _headers;
 };
 
+/**
+ * A completed Unreal HTTP request. Like the headers of the response, the URL,
+ * method and headers of the request are only converted when they are first
+ * accessed.
+ */
 class UnrealAssetRequest : public CesiumAsync::IAssetRequest {
 public:
   UnrealAssetRequest(FHttpRequestPtr pRequest, FHttpResponsePtr pResponse)
       : _pRequest(pRequest),
-        _pResponse(std::make_unique<UnrealAssetResponse>(pResponse)) {
-    this->_headers = parseHeaders(this->_pRequest->GetAllHeaders());
-    this->_url = TCHAR_TO_UTF8(*this->_pRequest->GetURL());
-    this->_method = TCHAR_TO_UTF8(*this->_pRequest->GetVerb());
+        _pResponse(std::make_unique<UnrealAssetResponse>(pResponse)),
+        _converted(),
+        _url(),
+        _method(),
+        _headers() {}
+
+  virtual const std::string& method() const {
+    this->convert();
+    return this->_method;
   }
 
-  virtual const std::string& method() const { return this->_method; }
-
-  virtual const std::string& url() const { return this->_url; }
+  virtual const std::string& url() const {
+    this->convert();
+    return this->_url;
+  }
 
   virtual const CesiumAsync::HttpHeaders& headers() const override {
-    return _headers;
+    this->convert();
+    return this->_headers;
   }
 
   virtual const CesiumAsync::IAssetResponse* response() const override {
@@ -85,14 +122,43 @@ public:
   }
 
 private:
+  void convert() const {
+    std::call_once(this->_converted, [this]() {
+      this->_url = TCHAR_TO_UTF8(*this->_pRequest->GetURL());
+      this->_method = TCHAR_TO_UTF8(*this->_pRequest->GetVerb());
+      this->_headers = parseHeaders(this->_pRequest->GetAllHeaders());
+    });
+  }
+
   FHttpRequestPtr _pRequest;
   std::unique_ptr<UnrealAssetResponse> _pResponse;
-  std::string _url;
-  std::string _method;
-  CesiumAsync::HttpHeaders _headers;
+  mutable std::once_flag _converted;
+  mutable std::string _url;
+  mutable std::string _method;
+  mutable CesiumAsync::HttpHeaders _headers;
 };
 
-UnrealAssetAccessor::UnrealAssetAccessor() : _userAgent() {
+namespace {
+/**
+ * Identifies a request by its URL and headers, so that only requests that
+ * would get the same response are coalesced.
+ */
+std::string createRequestKey(
+    const std::string& url,
+    const std::vector<CesiumAsync::IAssetAccessor::THeader>& headers) {
+  std::string key = url;
+  for (const CesiumAsync::IAssetAccessor::THeader& header : headers) {
+    key += '\n';
+    key += header.first;
+    key += ": ";
+    key += header.second;
+  }
+  return key;
+}
+} // namespace
+
+UnrealAssetAccessor::UnrealAssetAccessor(Priority priority)
+    : _priority(priority), _userAgent(), _cancelled(false) {
   FString OsVersion, OsSubVersion;
   FPlatformMisc::GetOSVersions(OsVersion, OsSubVersion);
 
@@ -126,25 +192,44 @@ UnrealAssetAccessor::requestAsset(
 
   CESIUM_TRACE_BEGIN_IN_TRACK("requestAsset");
 
+  if (this->_cancelled) {
+    CESIUM_TRACE_END_IN_TRACK("requestAsset");
+    return asyncSystem
+        .createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
+            [](const auto& promise) {
+              promise.reject(std::runtime_error("Request cancelled."));
+            });
+  }
+
   const FString& userAgent = this->_userAgent;
+  Priority priority = this->_priority;
+  const void* pOwner = this;
 
   return asyncSystem.createFuture<std::shared_ptr<CesiumAsync::IAssetRequest>>(
-      [&url, &headers, &userAgent](const auto& promise) {
-        FHttpModule& httpModule = FHttpModule::Get();
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> pRequest =
-            httpModule.CreateRequest();
-        pRequest->SetURL(UTF8_TO_TCHAR(url.c_str()));
-
-        for (const CesiumAsync::IAssetAccessor::THeader& header : headers) {
-          pRequest->SetHeader(
-              UTF8_TO_TCHAR(header.first.c_str()),
-              UTF8_TO_TCHAR(header.second.c_str()));
-        }
-
-        pRequest->AppendToHeader(TEXT("User-Agent"), userAgent);
-
-        pRequest->OnProcessRequestComplete().BindLambda(
-            [promise, CESIUM_TRACE_LAMBDA_CAPTURE_TRACK()](
+      [&url, &headers, &userAgent, priority, pOwner](const auto& promise) {
+        // The request may be created again when it is retried, so the
+        // function keeps copies of what it needs.
+        auto createRequest = [url = FString(UTF8_TO_TCHAR(url.c_str())),
+                              headers,
+                              userAgent]() {
+          FHttpModule& httpModule = FHttpModule::Get();
+          TSharedRef<IHttpRequest, ESPMode::ThreadSafe> pRequest =
+              httpModule.CreateRequest();
+          pRequest->SetURL(url);
+
+          for (const CesiumAsync::IAssetAccessor::THeader& header : headers) {
+            pRequest->SetHeader(
+                UTF8_TO_TCHAR(header.first.c_str()),
+                UTF8_TO_TCHAR(header.second.c_str()));
+          }
+
+          pRequest->AppendToHeader(TEXT("User-Agent"), userAgent);
+          return pRequest;
+        };
+
+        auto completeRequest =
+            [CESIUM_TRACE_LAMBDA_CAPTURE_TRACK()](
+                const std::vector<CesiumRequestScheduler::Promise>& promises,
                 FHttpRequestPtr pRequest,
                 FHttpResponsePtr pResponse,
                 bool connectedSuccessfully) mutable {
@@ -152,19 +237,38 @@ UnrealAssetAccessor::requestAsset(
               CESIUM_TRACE_END_IN_TRACK("requestAsset");
 
               if (connectedSuccessfully) {
-                promise.resolve(
-                    std::make_unique<UnrealAssetRequest>(pRequest, pResponse));
+                std::shared_ptr<CesiumAsync::IAssetRequest> pAssetRequest =
+                    std::make_shared<UnrealAssetRequest>(pRequest, pResponse);
+                for (const CesiumRequestScheduler::Promise& waiting :
+                     promises) {
+                  waiting.resolve(std::shared_ptr(pAssetRequest));
+                }
               } else {
-                switch (pRequest->GetStatus()) {
-                case EHttpRequestStatus::Failed_ConnectionError:
-                  promise.reject(std::runtime_error("Connection failed."));
-                default:
-                  promise.reject(std::runtime_error("Request failed."));
+                const char* message =
+                    pRequest->GetStatus() ==
+                            EHttpRequestStatus::Failed_ConnectionError
+                        ? "Connection failed."
+                        : "Request failed.";
+                for (const CesiumRequestScheduler::Promise& waiting :
+                     promises) {
+                  waiting.reject(std::runtime_error(message));
                 }
               }
-            });
-
-        pRequest->ProcessRequest();
+            };
+
+        bool scheduled = CesiumRequestScheduler::getInstance().request(
+            url,
+            createRequestKey(url, headers),
+            pOwner,
+            priority,
+            promise,
+            std::move(createRequest),
+            std::move(completeRequest));
+        if (!scheduled) {
+          // The same request is already queued or in flight, and its response
+          // will resolve this promise too.
+          CESIUM_TRACE_END_IN_TRACK("requestAsset");
+        }
       });
 }
 
@@ -209,6 +313,7 @@ UnrealAssetAccessor::post(
                 switch (pRequest->GetStatus()) {
                 case EHttpRequestStatus::Failed_ConnectionError:
                   promise.reject(std::runtime_error("Connection failed."));
+                  break;
                 default:
                   promise.reject(std::runtime_error("Request failed."));
                 }
@@ -219,7 +324,14 @@ UnrealAssetAccessor::post(
       });
 }
 
+void UnrealAssetAccessor::cancelRequests() {
+  this->_cancelled = true;
+  CesiumRequestScheduler::getInstance().cancel(this);
+}
+
 void UnrealAssetAccessor::tick() noexcept {
+  CesiumRequestScheduler::getInstance().tick();
+
   FHttpManager& manager = FHttpModule::Get().GetHttpManager();
   manager.Tick(0.0f);
 }
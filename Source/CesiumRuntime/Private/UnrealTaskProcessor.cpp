@@ -1,8 +1,11 @@
 // Copyright 2020-2021 CesiumGS, Inc. and Contributors
 
 #include "UnrealTaskProcessor.h"
-#include "Async/Async.h"
+#include "CesiumWorkerPool.h"
+
+UnrealTaskProcessor::UnrealTaskProcessor(Priority priority)
+    : _priority(priority) {}
 
 void UnrealTaskProcessor::startTask(std::function<void()> f) {
-  AsyncTask(ENamedThreads::Type::AnyThread, [f]() { f(); });
+  CesiumWorkerPool::startTask(this->_priority, std::move(f));
 }
@@ -7,19 +7,29 @@
 #include "CesiumCreditSystem.h"
 #include "CesiumExclusionZone.h"
 #include "CesiumGeoreference.h"
+#include "CesiumTilesetMemoryUsage.h"
+#include "CesiumTilesetStatistics.h"
 #include "CoreMinimal.h"
 #include "CustomDepthParameters.h"
+#include "Engine/EngineTypes.h"
 #include "GameFramework/Actor.h"
 #include "Interfaces/IHttpRequest.h"
 #include <PhysicsEngine/BodyInstance.h>
 #include <chrono>
 #include <glm/mat4x4.hpp>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Cesium3DTileset.generated.h"
 
 class UMaterialInterface;
 class ACesiumCartographicSelection;
+class CesiumExclusionZoneTileExcluder;
+class CesiumOcclusionTileExcluder;
+class CesiumTilesetStatisticsCollector;
+class UCesiumGltfComponent;
+class UnrealAssetAccessor;
 
 namespace Cesium3DTilesSelection {
 class Tileset;
@@ -189,6 +199,48 @@ public:
       meta = (ClampMin = 0.0))
   float MaximumScreenSpaceError = 16.0;
 
+  /**
+   * Whether to fade tiles in and out when the level-of-detail changes.
+   *
+   * When this is true, a tile that replaces another one is faded in while the
+   * tile it replaces is faded out, instead of one being swapped for the other
+   * in a single frame. Both tiles stay loaded and visible until the transition
+   * completes.
+   *
+   * The fade is only visible with a custom Material that reads the
+   * "FadePercentage" scalar parameter, which goes from 0 to 1 as a tile fades
+   * in, for example to dither the tile with DitherTemporalAA into its opacity
+   * mask. The default Cesium materials ignore it.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      Category = "Cesium|Level of Detail")
+  bool EnableLodTransitions = false;
+
+  /**
+   * The time, in seconds, that it takes to fade a tile in or out when
+   * "Enable Lod Transitions" is set.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      Category = "Cesium|Level of Detail",
+      meta = (EditCondition = "EnableLodTransitions", ClampMin = 0.0))
+  float LodTransitionLength = 0.5f;
+
+  /**
+   * The number of bytes that may be cached in addition to the Maximum Cached
+   * Bytes while tiles are fading out, so that they are not unloaded before
+   * their transition completes.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      Category = "Cesium|Level of Detail",
+      meta = (EditCondition = "EnableLodTransitions", ClampMin = 0))
+  int64 MaximumLodTransitionCachedBytes = 64 * 1024 * 1024;
+
   /**
    * Whether to preload ancestor tiles.
    *
@@ -240,6 +292,9 @@ public:
   /**
    * @brief The maximum number of bytes that may be cached.
    *
+   * This includes both the tile content and the geometry, textures and
+   * collision meshes created from it, see GetMemoryUsage.
+   *
    * Note that this value, even if 0, will never
    * cause tiles that are needed for rendering to be unloaded. However, if the
    * total number of loaded bytes is greater than this value, tiles will be
@@ -267,6 +322,91 @@ public:
       meta = (ClampMin = 0))
   int32 LoadingDescendantLimit = 20;
 
+  /**
+   * Whether to skip tile selection in frames where the view of this tileset is
+   * unchanged and it is not waiting for any tiles.
+   *
+   * Tile selection traverses the tileset on the game thread every frame, which
+   * can take several milliseconds for large tilesets, even when the cameras
+   * are not moving. When this is true, that traversal is skipped as long as
+   * the cameras, the tileset transform and the selection options stay the
+   * same and the previous traversal found no tiles left to load. The
+   * traversal is still done at least once every "Maximum Skipped View Updates"
+   * frames, so that tiles whose loading finishes in the meantime, and changes
+   * to raster overlays, show up with at most that much latency.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      AdvancedDisplay,
+      Category = "Cesium|Tile Loading")
+  bool SkipUnchangedViewUpdates = false;
+
+  /**
+   * The maximum number of consecutive frames in which tile selection may be
+   * skipped when "Skip Unchanged View Updates" is enabled.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      AdvancedDisplay,
+      Category = "Cesium|Tile Loading",
+      meta = (EditCondition = "SkipUnchangedViewUpdates", ClampMin = 0))
+  int32 MaximumSkippedViewUpdates = 10;
+
+  /**
+   * The time, in milliseconds, that may be spent in each frame on creating the
+   * meshes, materials, textures and collision meshes of tiles that are shown
+   * for the first time, or 0 for no limit.
+   *
+   * The tiles that do not fit in a frame are created in the following frames,
+   * at least one per frame. Until all of them are created, the tiles they
+   * replace remain visible, so that no holes appear.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      AdvancedDisplay,
+      Category = "Cesium|Tile Loading",
+      meta = (ClampMin = 0.0))
+  float MaximumTileCreationTimePerFrame = 5.0f;
+
+  /**
+   * Whether to prefetch the tiles needed by the views that are expected in the
+   * near future, for example along the path of a camera flight.
+   *
+   * Such views are registered with the UCesiumCameraSubsystem. The tiles for
+   * them are loaded with a separate, small budget, so that their content is
+   * already in the request cache when the camera gets there. Prefetched tiles
+   * are never rendered.
+   */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium|Tile Loading")
+  bool EnablePrefetching = false;
+
+  /**
+   * The maximum number of tiles that may be loaded at once for prefetching.
+   * These are loaded in addition to the "Maximum Simultaneous Tile Loads".
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      AdvancedDisplay,
+      Category = "Cesium|Tile Loading",
+      meta = (EditCondition = "EnablePrefetching", ClampMin = 0))
+  int32 MaximumSimultaneousPrefetchTileLoads = 4;
+
+  /**
+   * The maximum number of bytes that may be held by tiles that were loaded
+   * for prefetching.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      AdvancedDisplay,
+      Category = "Cesium|Tile Loading",
+      meta = (EditCondition = "EnablePrefetching", ClampMin = 0))
+  int64 MaximumPrefetchCachedBytes = 64 * 1024 * 1024;
+
   /**
    * Whether to cull tiles that are outside the frustum.
    *
@@ -292,6 +432,23 @@ public:
   UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium|Tile Culling")
   bool EnableFogCulling = true;
 
+  /**
+   * Whether to cull tiles that are occluded by other geometry.
+   *
+   * When this is true, the bounding volumes of the rendered tiles are tested
+   * by the occlusion culling of the Unreal Engine. Tiles whose bounding
+   * volumes were occluded in the previous frames are neither rendered nor
+   * refined, so their descendants are not loaded. This can greatly reduce the
+   * number of tiles loaded in dense cities, but tiles that become visible
+   * appear a few frames late.
+   *
+   * Only the player and editor viewports are tested. Tiles outside of their
+   * frustums, or inside the frustum of another camera such as a scene capture,
+   * are never culled this way.
+   */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium|Tile Culling")
+  bool EnableOcclusionCulling = false;
+
   /**
    * Whether a specified screen-space error should be enforced for tiles that
    * are outside the frustum or hidden in fog.
@@ -317,14 +474,14 @@ public:
 
   /**
    * A list of rectangles that are excluded from this tileset. Any tiles that
-   * overlap any of these rectangles are not shown. This is a crude method to
-   * avoid overlapping geometry coming from different tilesets. For example, to
+   * overlap any of these rectangles are not shown, and tiles that lie entirely
+   * inside one of them are not loaded either. This is a crude method to avoid
+   * overlapping geometry coming from different tilesets. For example, to
    * exclude Cesium OSM Buildings where there are photogrammetry assets.
    *
-   * Note that in the current version, excluded tiles are still loaded, they're
-   * just not displayed. Also, because the tiles shown when zoomed out cover a
-   * large area, using an exclusion zone often means the tileset won't be shown
-   * at all when zoomed out.
+   * Note that because the tiles shown when zoomed out cover a large area, using
+   * an exclusion zone often means the tileset won't be shown at all when zoomed
+   * out.
    *
    * This property is currently only supported for 3D Tiles that use "region"
    * for their bounding volumes. For other tilesets it is silently ignored.
@@ -450,6 +607,28 @@ private:
       meta = (EditCondition = "TilesetSource==ETilesetSource::FromCesiumIon"))
   FString IonAccessToken;
 
+  /**
+   * A bundle of this tileset's assets for a region, written with the
+   * CesiumPackage commandlet, to load the tileset and its raster overlays
+   * from instead of the network.
+   *
+   * Assets that are not in the bundle, such as the tiles outside of its
+   * region or with more detail than it was written for, are not loaded. A
+   * relative path is relative to the project directory.
+   *
+   * Bundles are memory mapped, and are not assets. To include a bundle in
+   * packaged builds, add its directory in Content to "Additional Non-Asset
+   * Directories To Copy" in the Packaging project settings, which copies it as
+   * a loose file rather than into a pak file that could not be mapped.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintGetter = GetOfflineBundle,
+      BlueprintSetter = SetOfflineBundle,
+      Category = "Cesium",
+      meta = (FilePathFilter = "cesiumbundle", RelativeToGameDir))
+  FFilePath OfflineBundle;
+
   /**
    * Whether to generate physics meshes for this tileset.
    *
@@ -516,6 +695,35 @@ private:
       meta = (EditCondition = "PlatformName != TEXT(\"Mac\")"))
   bool EnableWaterMask = false;
 
+  /**
+   * Whether to merge the small primitives of each tile that share a material
+   * into a single primitive.
+   *
+   * Some tilesets, such as those of buildings, have tiles with many small
+   * primitives, each of which is drawn with its own draw call. Merging them
+   * reduces the number of draw calls, at the cost of a little extra load time.
+   * Primitives with feature metadata or a water mask, and meshes that are
+   * drawn as instances, are never merged.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintGetter = GetMergeSmallPrimitives,
+      BlueprintSetter = SetMergeSmallPrimitives,
+      Category = "Cesium|Rendering")
+  bool MergeSmallPrimitives = false;
+
+  /**
+   * The maximum number of vertices that a primitive may have to be merged with
+   * other primitives when "Merge Small Primitives" is enabled.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintGetter = GetMaximumMergedPrimitiveVertices,
+      BlueprintSetter = SetMaximumMergedPrimitiveVertices,
+      Category = "Cesium|Rendering",
+      meta = (EditCondition = "MergeSmallPrimitives", ClampMin = 0))
+  int32 MaximumMergedPrimitiveVertices = 1024;
+
   /**
    * A custom Material to use to render this tileset, in order to implement
    * custom visual effects.
@@ -585,6 +793,12 @@ public:
   UFUNCTION(BlueprintSetter, Category = "Cesium")
   void SetIonAccessToken(FString InAccessToken);
 
+  UFUNCTION(BlueprintGetter, Category = "Cesium")
+  FFilePath GetOfflineBundle() const { return OfflineBundle; }
+
+  UFUNCTION(BlueprintSetter, Category = "Cesium")
+  void SetOfflineBundle(FFilePath InOfflineBundle);
+
   UFUNCTION(BlueprintGetter, Category = "Cesium|Physics")
   bool GetCreatePhysicsMeshes() const { return CreatePhysicsMeshes; }
 
@@ -609,6 +823,20 @@ public:
   UFUNCTION(BlueprintSetter, Category = "Cesium|Rendering")
   void SetEnableWaterMask(bool bEnableMask);
 
+  UFUNCTION(BlueprintGetter, Category = "Cesium|Rendering")
+  bool GetMergeSmallPrimitives() const { return MergeSmallPrimitives; }
+
+  UFUNCTION(BlueprintSetter, Category = "Cesium|Rendering")
+  void SetMergeSmallPrimitives(bool bMergeSmallPrimitives);
+
+  UFUNCTION(BlueprintGetter, Category = "Cesium|Rendering")
+  int32 GetMaximumMergedPrimitiveVertices() const {
+    return MaximumMergedPrimitiveVertices;
+  }
+
+  UFUNCTION(BlueprintSetter, Category = "Cesium|Rendering")
+  void SetMaximumMergedPrimitiveVertices(int32 MaximumVertices);
+
   UFUNCTION(BlueprintGetter, Category = "Cesium|Rendering")
   UMaterialInterface* GetMaterial() const { return Material; }
 
@@ -638,6 +866,33 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Cesium|Rendering")
   void PauseMovieSequencer();
 
+  /**
+   * Gets the memory currently used by the loaded tiles of this tileset.
+   *
+   * The sum of the ModelBytes and the bytes of the renderer resources is what
+   * is kept within MaximumCachedBytes.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Cesium|Tile Loading")
+  FCesiumTilesetMemoryUsage GetMemoryUsage() const;
+
+  /**
+   * Gets the statistics of the tile loading pipeline of this tileset, as of
+   * the last frame.
+   *
+   * The same values, summed up over all tilesets, are available as the
+   * "Cesium" stats group (`stat Cesium`) and the "Cesium" CSV profiler
+   * category.
+   */
+  UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Cesium|Debug")
+  FCesiumTilesetStatistics GetStatistics() const;
+
+  /**
+   * Resets the counts and latencies in the statistics of this tileset, which
+   * are otherwise accumulated from when the tileset was spawned.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium|Debug")
+  void ResetStatistics();
+
   /**
    * This method is not supposed to be called by clients. It is currently
    * only required by the UnrealResourcePreparer.
@@ -647,6 +902,91 @@ public:
    */
   const glm::dmat4& GetCesiumTilesetToUnrealRelativeWorldTransform() const;
 
+  /**
+   * This method is not supposed to be called by clients. It is currently
+   * only required by the UnrealResourcePreparer.
+   *
+   * Gets the transform from the "Cesium Tileset" reference frame to the frame
+   * of the component that all tiles are attached to. Tiles are positioned
+   * relative to this component, so that moving the tileset or rebasing the
+   * world origin only requires updating the transform of that one component.
+   */
+  const glm::dmat4& GetCesiumTilesetToTileAnchorTransform() const;
+
+  /**
+   * Updates the tile selection of this tileset for the given views, and shows
+   * and hides the tiles accordingly.
+   *
+   * This method is not supposed to be called by clients. It is called once per
+   * frame by the UCesiumTilesetManager for every tileset that ticked.
+   *
+   * @param frustums The views, in the "Cesium Tileset" reference frame.
+   * @param renderedFrustumCount The number of views at the start of the
+   * frustums that are rendered, see EnableOcclusionCulling.
+   * @param viewsUnchanged Whether the views are the same as in the previous
+   * call. This allows the update to be skipped, see SkipUnchangedViewUpdates.
+   * @return The result of the view update, or nullptr if the tileset is not
+   * loaded or the update was skipped.
+   */
+  const Cesium3DTilesSelection::ViewUpdateResult* UpdateView(
+      const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+      size_t renderedFrustumCount,
+      bool viewsUnchanged);
+
+  /**
+   * Loads the tiles that are needed for the given prefetch views, without
+   * rendering them. If prefetching is disabled, the resources used for
+   * prefetching are released. If no views are given, the tiles prefetched
+   * before are unloaded as needed, but the prefetch tileset is kept for the
+   * next views.
+   *
+   * This method is not supposed to be called by clients. It is called once per
+   * frame by the UCesiumTilesetManager, after UpdateView.
+   *
+   * @param frustums The prefetch views, in the "Cesium Tileset" reference
+   * frame.
+   */
+  void UpdatePrefetch(
+      const std::vector<Cesium3DTilesSelection::ViewState>& frustums);
+
+  /**
+   * Updates the statistics returned by GetStatistics at the end of a frame.
+   *
+   * This method is not supposed to be called by clients. It is called once per
+   * frame by the UCesiumTilesetManager, after UpdatePrefetch.
+   *
+   * @param pResult The result of UpdateView in this frame.
+   */
+  void UpdateStatistics(const Cesium3DTilesSelection::ViewUpdateResult* pResult);
+
+  /**
+   * Gets the number of bytes that this tileset may currently cache in addition
+   * to its MaximumCachedBytes, so that tiles that are fading out remain loaded.
+   *
+   * This method is not supposed to be called by clients. It is used by the
+   * UCesiumTilesetManager when it assigns the cache budget of the tileset.
+   */
+  int64 GetLodTransitionCachedBytes() const;
+
+  /**
+   * Adds the memory of renderer resources that were created for a tile of this
+   * tileset, so that they count towards its MaximumCachedBytes. It may be
+   * called from any thread.
+   *
+   * This method is not supposed to be called by clients. It is currently
+   * only required by the UnrealResourcePreparer.
+   */
+  void AddRendererMemoryUsage(const FCesiumTilesetMemoryUsage& Usage);
+
+  /**
+   * Subtracts the memory of renderer resources that were freed, after they
+   * were added with AddRendererMemoryUsage.
+   *
+   * This method is not supposed to be called by clients. It is currently
+   * only required by the UnrealResourcePreparer.
+   */
+  void SubtractRendererMemoryUsage(const FCesiumTilesetMemoryUsage& Usage);
+
   Cesium3DTilesSelection::Tileset* GetTileset() { return this->_pTileset; }
   const Cesium3DTilesSelection::Tileset* GetTileset() const {
     return this->_pTileset;
@@ -693,26 +1033,17 @@ protected:
 private:
   void LoadTileset();
   void DestroyTileset();
-
-  struct UnrealCameraParameters {
-    FVector2D viewportSize;
-    FVector location;
-    FRotator rotation;
-    double fieldOfViewDegrees;
-  };
-
-  static Cesium3DTilesSelection::ViewState CreateViewStateFromViewParameters(
-      const UnrealCameraParameters& camera,
-      const glm::dmat4& unrealWorldToTileset);
-
-  std::vector<UnrealCameraParameters> GetCameras() const;
-  std::vector<UnrealCameraParameters> GetPlayerCameras() const;
-  std::vector<UnrealCameraParameters> GetSceneCaptures() const;
+  void LoadPrefetchTileset();
+  void DestroyPrefetchTileset();
 
 public:
   /**
-   * Update the transforms of the glTF components based on the
-   * the transform of the root component.
+   * Update the transform of the tile anchor, which the glTF components are
+   * attached to, based on the transform of the root component.
+   *
+   * The glTF components themselves are only repositioned if the anchor has
+   * to be moved because it got too far from the origin of the Unreal world
+   * for single-precision positions relative to it to be accurate.
    *
    * This is supposed to be called during Tick, if the transform of
    * the root component has changed since the previous Tick.
@@ -727,6 +1058,22 @@ private:
    */
   void updateTilesetOptionsFromProperties();
 
+  /**
+   * Updates the tile excluder for the ExclusionZones from the current value of
+   * the property. The excluder is registered with the tileset when the tileset
+   * is loaded, so this does nothing before then.
+   */
+  void updateExclusionZoneExcluder();
+
+  /**
+   * Enables or disables the occlusion culling excluder according to
+   * EnableOcclusionCulling, and updates which tiles it finds occluded in the
+   * rendered views.
+   */
+  void updateOcclusionTileExcluder(
+      const std::vector<Cesium3DTilesSelection::ViewState>& frustums,
+      size_t renderedFrustumCount);
+
   /**
    * Update all the "_last..." fields of this instance based
    * on the given ViewUpdateResult, printing a log message
@@ -741,11 +1088,36 @@ private:
    * Creates the visual representations of the given tiles to
    * be rendered in the current frame.
    *
+   * The primitives of tiles that are shown for the first time are only created
+   * within the MaximumTileCreationTimePerFrame, and the tiles whose primitives
+   * do not fit are not shown yet.
+   *
    * @param tiles The tiles
+   * @return Whether all tiles are shown.
    */
-  void
+  bool
   showTilesToRender(const std::vector<Cesium3DTilesSelection::Tile*>& tiles);
 
+  /**
+   * Increments the collision settings version if the collision settings of
+   * the BodyInstance changed since they were last applied to the tiles.
+   */
+  void updateCollisionSettingsVersion();
+
+  /**
+   * Begins fading out the given tiles, which are no longer supposed to be
+   * rendered. They are hidden once their transition completes.
+   */
+  void fadeOutTiles(const std::vector<Cesium3DTilesSelection::Tile*>& tiles);
+
+  /**
+   * Advances the transitions of the tiles that are fading in or out.
+   *
+   * @param DeltaTime The time since the transitions were last advanced, in
+   * seconds.
+   */
+  void updateLodTransitions(float DeltaTime);
+
   /**
    * Will be called after the tileset is loaded or spawned, to register
    * a delegate that calls OnFocusEditorViewportOnThis when this
@@ -754,8 +1126,6 @@ private:
   void AddFocusViewportDelegate();
 
 #if WITH_EDITOR
-  std::vector<UnrealCameraParameters> GetEditorCameras() const;
-
   /**
    * Will focus all viewports on this tileset.
    *
@@ -771,6 +1141,33 @@ private:
 private:
   Cesium3DTilesSelection::Tileset* _pTileset;
 
+  // A second instance of the same tileset, which is only used to load the
+  // tiles for the prefetch views. Its tiles are never rendered.
+  Cesium3DTilesSelection::Tileset* _pPrefetchTileset;
+
+  // The accessors that download the assets of the tileset and of the prefetch
+  // tileset, or nullptr if they are loaded from an offline bundle. Their
+  // requests are cancelled before the tilesets are destroyed.
+  std::shared_ptr<UnrealAssetAccessor> _pUnrealAssetAccessor;
+  std::shared_ptr<UnrealAssetAccessor> _pPrefetchUnrealAssetAccessor;
+
+  // All tiles are attached to this component, and positioned relative to it
+  // with single precision. It is located at _tileAnchorPosition in the
+  // "Cesium Tileset" reference frame.
+  UPROPERTY()
+  USceneComponent* _pTileAnchor;
+  glm::dvec3 _tileAnchorPosition;
+  glm::dmat4 _tilesetToTileAnchor;
+
+  // Excludes tiles entirely inside the ExclusionZones during tile selection,
+  // so that they are never loaded, and hides the rendered tiles that overlap
+  // them. Registered in the TilesetOptions::excluders.
+  std::shared_ptr<CesiumExclusionZoneTileExcluder> _pExclusionZoneExcluder;
+
+  // Excludes tiles that were occluded in the previous frames when
+  // EnableOcclusionCulling is set. Registered in the TilesetOptions::excluders.
+  std::shared_ptr<CesiumOcclusionTileExcluder> _pOcclusionTileExcluder;
+
   // For debug output
   uint32_t _lastTilesRendered;
   uint32_t _lastTilesLoadingLowPriority;
@@ -784,6 +1181,19 @@ private:
 
   std::chrono::high_resolution_clock::time_point _startTime;
 
+  // State for SkipUnchangedViewUpdates. A view update is required when the
+  // tileset is created or its selection options change, and whenever the
+  // previous update still had tiles waiting to be loaded.
+  bool _viewUpdateRequired;
+  int32 _skippedViewUpdates;
+
+  // The collision settings of the BodyInstance that were last applied to the
+  // tiles. The version is incremented whenever they change, so that each tile
+  // only needs to apply them again if it has an older version.
+  uint32 _collisionSettingsVersion;
+  TEnumAsByte<ECollisionChannel> _lastCollisionObjectType;
+  FCollisionResponseContainer _lastCollisionResponses;
+
   bool _captureMovieMode;
   bool _beforeMoviePreloadAncestors;
   bool _beforeMoviePreloadSiblings;
@@ -803,4 +1213,24 @@ private:
   // Unreal Engine, then this field may be removed, and the
   // tilesToNoLongerRenderThisFrame may be hidden immediately.
   std::vector<Cesium3DTilesSelection::Tile*> _tilesToNoLongerRenderNextFrame;
+
+  // The renderer resources of the tiles that are fading in or out when
+  // EnableLodTransitions is set. They are weak pointers, so that a tile that
+  // is unloaded while fading is dropped from its list instead of dangling.
+  std::vector<TWeakObjectPtr<UCesiumGltfComponent>> _tilesFadingIn;
+  std::vector<TWeakObjectPtr<UCesiumGltfComponent>> _tilesFadingOut;
+
+  // The memory of the renderer resources of the loaded tiles and of the
+  // textures of the raster overlay tiles. The ModelBytes are not tracked here,
+  // but queried from the tileset.
+  FCesiumTilesetMemoryUsage _rendererMemoryUsage;
+
+  // Guards the renderer memory usage, which is added to by the load threads
+  // when they prepare tiles.
+  mutable std::mutex _rendererMemoryUsageMutex;
+
+  // Collects the statistics of the tile loading pipeline. It is shared with
+  // the resource preparer and the asset accessor of the tileset, which may
+  // outlive the tileset while requests complete.
+  std::shared_ptr<CesiumTilesetStatisticsCollector> _pStatisticsCollector;
 };
@@ -0,0 +1,74 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Rotator.h"
+#include "Math/Vector.h"
+#include "Math/Vector2D.h"
+
+#include "CesiumCamera.generated.h"
+
+/**
+ * A camera description that Cesium3DTilesets can use to decide what tiles
+ * need to be loaded to sufficiently cover the camera view.
+ */
+USTRUCT(BlueprintType)
+struct CESIUMRUNTIME_API FCesiumCamera {
+  GENERATED_USTRUCT_BODY()
+
+public:
+  /**
+   * The pixel dimensions of the viewport.
+   */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium")
+  FVector2D ViewportSize;
+
+  /**
+   * The Unreal location of the camera.
+   */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium")
+  FVector Location;
+
+  /**
+   * The Unreal rotation of the camera.
+   */
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cesium")
+  FRotator Rotation;
+
+  /**
+   * The horizontal field of view of the camera in degrees.
+   */
+  UPROPERTY(
+      EditAnywhere,
+      BlueprintReadWrite,
+      Category = "Cesium",
+      meta = (ClampMin = 0.0, ClampMax = 180.0))
+  float FieldOfViewDegrees;
+
+  FCesiumCamera()
+      : ViewportSize(1.0f, 1.0f),
+        Location(0.0f, 0.0f, 0.0f),
+        Rotation(0.0f, 0.0f, 0.0f),
+        FieldOfViewDegrees(90.0f) {}
+
+  FCesiumCamera(
+      const FVector2D& ViewportSize_,
+      const FVector& Location_,
+      const FRotator& Rotation_,
+      float FieldOfViewDegrees_)
+      : ViewportSize(ViewportSize_),
+        Location(Location_),
+        Rotation(Rotation_),
+        FieldOfViewDegrees(FieldOfViewDegrees_) {}
+
+  bool operator==(const FCesiumCamera& other) const {
+    return ViewportSize == other.ViewportSize && Location == other.Location &&
+           Rotation == other.Rotation &&
+           FieldOfViewDegrees == other.FieldOfViewDegrees;
+  }
+
+  bool operator!=(const FCesiumCamera& other) const {
+    return !(*this == other);
+  }
+};
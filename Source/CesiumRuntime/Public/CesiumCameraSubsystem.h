@@ -0,0 +1,170 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CesiumCamera.h"
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include <vector>
+
+#include "CesiumCameraSubsystem.generated.h"
+
+class AActor;
+class ULevel;
+class USceneCaptureComponent2D;
+
+/**
+ * Keeps track of the cameras in a World that Cesium3DTilesets use for tile
+ * selection.
+ *
+ * The set of cameras is gathered at most once per frame and shared by all
+ * tilesets in the World. It consists of the player cameras, the editor viewport
+ * cameras (when not playing), all tracked scene captures, and any cameras
+ * registered explicitly with AddCamera.
+ *
+ * Scene Capture 2D actors are tracked automatically as they are spawned or
+ * streamed in. Scene capture components attached to other actors can be
+ * volunteered with AddSceneCapture.
+ *
+ * In addition, it keeps track of prefetch cameras: views that are expected in
+ * the near future, such as the keypoints of a camera flight. Tilesets with
+ * EnablePrefetching load the tiles for these views ahead of time, without
+ * rendering them.
+ */
+UCLASS()
+class CESIUMRUNTIME_API UCesiumCameraSubsystem : public UWorldSubsystem {
+  GENERATED_BODY()
+
+public:
+  /**
+   * Gets the camera subsystem for the World of the given context object, or
+   * nullptr if there is no World.
+   */
+  UFUNCTION(
+      BlueprintCallable,
+      Category = "Cesium",
+      meta = (WorldContext = "WorldContextObject"))
+  static UCesiumCameraSubsystem* Get(const UObject* WorldContextObject);
+
+  /**
+   * Registers a camera to be used for tile selection by all tilesets in this
+   * World, and returns an ID that can be used to update or remove it.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  int32 AddCamera(const FCesiumCamera& Camera);
+
+  /**
+   * Updates a camera previously registered with AddCamera. Returns false if
+   * there is no camera with the given ID.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  bool UpdateCamera(int32 CameraId, const FCesiumCamera& Camera);
+
+  /**
+   * Removes a camera previously registered with AddCamera. Returns false if
+   * there is no camera with the given ID.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  bool RemoveCamera(int32 CameraId);
+
+  /**
+   * Volunteers a scene capture component to be used for tile selection. Only
+   * perspective captures with a render target are used. Components owned by
+   * Scene Capture 2D actors are tracked automatically and do not need to be
+   * added.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  void AddSceneCapture(USceneCaptureComponent2D* SceneCapture);
+
+  /**
+   * Stops using a scene capture component for tile selection.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  void RemoveSceneCapture(USceneCaptureComponent2D* SceneCapture);
+
+  /**
+   * Registers a set of cameras whose views are expected in the near future,
+   * so that tilesets with EnablePrefetching can load their tiles ahead of
+   * time. Returns an ID that can be used to remove them again.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  int32 AddPrefetchCameras(const TArray<FCesiumCamera>& Cameras);
+
+  /**
+   * Removes a set of cameras previously registered with AddPrefetchCameras.
+   * Returns false if there are no prefetch cameras with the given ID.
+   */
+  UFUNCTION(BlueprintCallable, Category = "Cesium")
+  bool RemovePrefetchCameras(int32 PrefetchId);
+
+  /**
+   * Gets all cameras that should currently be used for tile selection. The
+   * result is computed at most once per frame.
+   *
+   * The cameras of the views that are rendered, which are the player and
+   * editor viewport cameras, come first, see GetRenderedCameraCount.
+   */
+  const std::vector<FCesiumCamera>& GetCameras();
+
+  /**
+   * Gets the number of cameras at the start of GetCameras whose views are
+   * rendered, so that the renderer's occlusion culling results apply to them.
+   */
+  size_t GetRenderedCameraCount();
+
+  /**
+   * Gets all cameras whose tiles should currently be prefetched. These are the
+   * cameras registered with AddPrefetchCameras and, if the Camera Prefetch
+   * Lookahead Seconds setting is enabled, the current cameras extrapolated
+   * along their velocity. The result is computed at most once per frame.
+   */
+  const std::vector<FCesiumCamera>& GetPrefetchCameras();
+
+  // USubsystem overrides
+  virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+  virtual void Deinitialize() override;
+
+private:
+  void OnActorSpawned(AActor* Actor);
+  void OnLevelAdded(ULevel* Level, UWorld* World);
+  void TrackActor(AActor* Actor);
+  void ScanWorldForSceneCaptures();
+
+  void AddPlayerCameras(std::vector<FCesiumCamera>& cameras) const;
+  void AddSceneCaptureCameras(std::vector<FCesiumCamera>& cameras);
+  void AddExtrapolatedCameras(
+      std::vector<FCesiumCamera>& cameras,
+      float lookaheadSeconds) const;
+#if WITH_EDITOR
+  void AddEditorCameras(std::vector<FCesiumCamera>& cameras) const;
+#endif
+
+  TArray<TWeakObjectPtr<USceneCaptureComponent2D>> _sceneCaptures;
+  TMap<int32, FCesiumCamera> _registeredCameras;
+  int32 _nextCameraId = 0;
+
+  TMap<int32, TArray<FCesiumCamera>> _registeredPrefetchCameras;
+  int32 _nextPrefetchId = 0;
+
+  bool _initialScanDone = false;
+  uint64 _lastFrameNumber = MAX_uint64;
+  // Whether cameras were added, updated or removed since they were gathered.
+  bool _camerasChanged = false;
+  std::vector<FCesiumCamera> _cameras;
+  size_t _renderedCameraCount = 0;
+
+  // The cameras of the previous frame, and when they were gathered, to
+  // estimate the velocity of the current cameras.
+  std::vector<FCesiumCamera> _previousCameras;
+  double _previousCamerasTime = 0.0;
+  double _camerasTime = 0.0;
+
+  uint64 _lastPrefetchFrameNumber = MAX_uint64;
+  std::vector<FCesiumCamera> _prefetchCameras;
+
+  FDelegateHandle _actorSpawnedHandle;
+  FDelegateHandle _levelAddedHandle;
+#if WITH_EDITOR
+  FDelegateHandle _levelActorAddedHandle;
+#endif
+};
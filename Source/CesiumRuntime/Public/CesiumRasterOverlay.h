@@ -61,6 +61,13 @@ public:
   UFUNCTION(BlueprintCallable, Category = "Cesium")
   void Refresh();
 
+  /**
+   * Creates the native raster overlay with the current properties of this
+   * component, without adding it to a tileset. This is used to add the
+   * overlay to a tileset that is not owned by an actor.
+   */
+  std::unique_ptr<Cesium3DTilesSelection::RasterOverlay> CreateNativeOverlay();
+
   UFUNCTION(BlueprintCallable, Category = "Cesium")
   float GetMaximumScreenSpaceError() const;
 
@@ -12,4 +12,7 @@ public:
   /** IModuleInterface implementation */
   virtual void StartupModule() override;
   virtual void ShutdownModule() override;
+
+private:
+  FDelegateHandle _endFrameHandle;
 };
@@ -0,0 +1,247 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Engine/EngineTypes.h"
+#include "CesiumRuntimeSettings.generated.h"
+
+/**
+ * The storage of the request cache.
+ */
+UENUM()
+enum class ECesiumRequestCacheType : uint8 {
+  /**
+   * Stores the responses in SQLite databases.
+   */
+  SQLite UMETA(DisplayName = "SQLite"),
+
+  /**
+   * Appends the responses to large memory-mapped files, which is faster to
+   * read for caches of many gigabytes, such as caches that are filled in
+   * advance for offline use.
+   */
+  FlatFile UMETA(DisplayName = "Memory-Mapped Files")
+};
+
+/**
+ * Stores project-wide settings for the Cesium Runtime module.
+ */
+UCLASS(Config = Engine, DefaultConfig, meta = (DisplayName = "Cesium"))
+class CESIUMRUNTIME_API UCesiumRuntimeSettings : public UDeveloperSettings {
+  GENERATED_UCLASS_BODY()
+
+public:
+  /**
+   * Whether the total number of simultaneous tile loads of all tilesets in a
+   * World should be limited by Total Maximum Simultaneous Tile Loads.
+   *
+   * When this is false, each tileset is only limited by its own Maximum
+   * Simultaneous Tile Loads.
+   */
+  UPROPERTY(Config, EditAnywhere, Category = "Tile Loading")
+  bool LimitTotalSimultaneousTileLoads = false;
+
+  /**
+   * The maximum number of tiles that may be loaded at once by all tilesets in
+   * a World, combined.
+   *
+   * The budget is shared between the tilesets according to how many tiles
+   * each of them is waiting for, with tiles needed to meet the tileset's
+   * screen-space error served first. A tileset is never given more than its
+   * own Maximum Simultaneous Tile Loads, and every tileset may always load at
+   * least one tile at a time, so that no tileset is starved.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Tile Loading",
+      meta = (EditCondition = "LimitTotalSimultaneousTileLoads", ClampMin = 1))
+  int32 TotalMaximumSimultaneousTileLoads = 40;
+
+  /**
+   * Whether the total number of bytes cached by all tilesets in a World should
+   * be limited by Total Maximum Cached Bytes.
+   *
+   * When this is false, each tileset is only limited by its own Maximum Cached
+   * Bytes.
+   */
+  UPROPERTY(Config, EditAnywhere, Category = "Tile Loading")
+  bool LimitTotalCachedBytes = false;
+
+  /**
+   * The maximum number of bytes that may be cached by all tilesets in a World,
+   * combined.
+   *
+   * The budget is shared between the tilesets in proportion to the number of
+   * tiles each of them is rendering. A tileset is never given more than its
+   * own Maximum Cached Bytes. As with the per-tileset limit, tiles that are
+   * needed for rendering are never unloaded.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Tile Loading",
+      meta = (EditCondition = "LimitTotalCachedBytes", ClampMin = 0))
+  int64 TotalMaximumCachedBytes = 512 * 1024 * 1024;
+
+  /**
+   * How many seconds ahead to predict the location of each camera from its
+   * current velocity, in order to prefetch the tiles at the predicted
+   * location. Only tilesets with Enable Prefetching do so. A value of zero
+   * disables the prediction, while prefetch cameras registered explicitly,
+   * for example by camera flights, are still used.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Tile Loading",
+      meta = (ClampMin = 0.0, Units = "s"))
+  float CameraPrefetchLookaheadSeconds = 0.0f;
+
+  /**
+   * The number of threads that load tiles, parsing them and building their
+   * meshes. A value of zero uses as many threads as Unreal's task graph.
+   *
+   * Tiles for the current views are loaded before tiles that are prefetched.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Worker Threads",
+      meta = (ClampMin = 0, ConfigRestartRequired = true))
+  int32 WorkerThreadCount = 0;
+
+  /**
+   * The mask of the CPU cores the tile loading threads may run on, with one
+   * bit per core. A value of zero lets them run on any core.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Worker Threads",
+      meta = (ConfigRestartRequired = true))
+  int64 WorkerThreadAffinityMask = 0;
+
+  /**
+   * The maximum number of requests that may be in flight to one host at a
+   * time, for hosts that are not listed in Maximum Requests Per Host
+   * Overrides. Requests to hosts that have as many requests in flight wait,
+   * and requests for the current views are sent before prefetching requests.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Requests",
+      meta = (ClampMin = 1, ConfigRestartRequired = true))
+  int32 MaximumRequestsPerHost = 16;
+
+  /**
+   * The maximum number of requests that may be in flight to specific hosts at
+   * a time, by host name with an optional port, such as "assets.cesium.com"
+   * or "localhost:8080".
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Requests",
+      meta = (ConfigRestartRequired = true))
+  TMap<FString, int32> MaximumRequestsPerHostOverrides;
+
+  /**
+   * Whether the number of requests in flight to each host adapts to how the
+   * host responds. It starts at the host's maximum, is halved when the host
+   * answers with 429 Too Many Requests or 503 Service Unavailable or when
+   * connections fail, and grows back to the maximum while requests succeed.
+   * When this is false, every host may always have its maximum number of
+   * requests in flight.
+   *
+   * Either way, requests answered with 429 or 503 are retried after the delay
+   * given by the host's Retry-After header.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Requests",
+      meta = (ConfigRestartRequired = true))
+  bool AdaptRequestsPerHost = true;
+
+  /**
+   * How the request cache stores responses. Changing this starts a new, empty
+   * cache.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ConfigRestartRequired = true))
+  ECesiumRequestCacheType RequestCacheType = ECesiumRequestCacheType::SQLite;
+
+  /**
+   * The directory the request cache is stored in. Relative paths are relative
+   * to the project directory. When this is empty, the cache is stored in the
+   * engine's user directory, where it is shared by all projects.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ConfigRestartRequired = true))
+  FDirectoryPath RequestCacheDirectory;
+
+  /**
+   * The number of databases the request cache is split into, by host.
+   * Requests to hosts in different databases are read and written without
+   * waiting for each other.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ClampMin = 1, ConfigRestartRequired = true))
+  int32 RequestCacheShardCount = 1;
+
+  /**
+   * The maximum number of responses kept in the request cache, all databases
+   * combined. The cache is pruned when it is opened, every ten minutes, and
+   * after many requests, in the background. Expired responses are removed
+   * first, and then the least recently used ones.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ClampMin = 1, ConfigRestartRequired = true))
+  int32 RequestCacheMaximumItems = 4096;
+
+  /**
+   * The maximum size of the responses kept in the request cache, in bytes, or
+   * zero for no limit. When the cache is pruned, the least recently used
+   * responses are removed until it fits.
+   *
+   * SQLite databases count the size of the response bodies, and return the
+   * space of removed responses to the file system when pruning. The files of
+   * the Memory-Mapped Files cache type may be larger by the space of removed
+   * responses that was not reclaimed yet.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ClampMin = 0, ConfigRestartRequired = true))
+  int64 RequestCacheMaximumBytes = 0;
+
+  /**
+   * The number of days after which cached responses expire, even if the
+   * server allowed caching them for longer, or zero for no limit. Expired
+   * responses are requested again from the server, and removed when the
+   * cache is pruned.
+   */
+  UPROPERTY(
+      Config,
+      EditAnywhere,
+      Category = "Request Cache",
+      meta = (ClampMin = 0, ConfigRestartRequired = true))
+  int32 RequestCacheMaximumAgeDays = 0;
+};
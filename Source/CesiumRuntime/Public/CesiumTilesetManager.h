@@ -0,0 +1,104 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "Cesium3DTilesSelection/ViewState.h"
+#include "CesiumCamera.h"
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+#include "CesiumTilesetManager.generated.h"
+
+class ACesium3DTileset;
+
+/**
+ * Updates the tile selection of all Cesium3DTilesets in a World together,
+ * once per frame.
+ *
+ * Each tileset requests an update from its own Tick. After all actors have
+ * ticked, the manager gathers the cameras once, creates the view states once
+ * for each distinct tileset transform, distributes the global tile loading and
+ * caching budgets from the Cesium project settings across the tilesets, and
+ * then updates the view of each tileset.
+ */
+UCLASS()
+class CESIUMRUNTIME_API UCesiumTilesetManager : public UWorldSubsystem,
+                                                public FTickableGameObject {
+  GENERATED_BODY()
+
+public:
+  /**
+   * Gets the tileset manager for the World of the given context object, or
+   * nullptr if there is no World.
+   */
+  static UCesiumTilesetManager* Get(const UObject* WorldContextObject);
+
+  /**
+   * Creates a view state in the "Cesium Tileset" reference frame for the given
+   * camera.
+   *
+   * @param camera The camera, in Unreal relative world coordinates.
+   * @param unrealWorldToTileset The transformation from Unreal relative world
+   * coordinates to the tileset's coordinates.
+   */
+  static Cesium3DTilesSelection::ViewState CreateViewState(
+      const FCesiumCamera& camera,
+      const glm::dmat4& unrealWorldToTileset);
+
+  /**
+   * Requests that the given tileset's view be updated in this frame. This is
+   * called by the tileset itself while ticking.
+   */
+  void RequestUpdate(ACesium3DTileset* pTileset);
+
+  // FTickableGameObject overrides
+  virtual void Tick(float DeltaTime) override;
+  virtual ETickableTickType GetTickableTickType() const override;
+  virtual bool IsTickableInEditor() const override { return true; }
+  virtual UWorld* GetTickableGameObjectWorld() const override;
+  virtual TStatId GetStatId() const override;
+
+  // USubsystem overrides
+  virtual void Deinitialize() override;
+
+private:
+  /**
+   * The demand of a tileset observed in its most recent view update, which is
+   * used to distribute the global budgets in the next frame.
+   */
+  struct TilesetDemand {
+    uint32_t tilesLoadingHighPriority = 0;
+    uint32_t tilesLoadingMediumPriority = 0;
+    uint32_t tilesLoadingLowPriority = 0;
+    size_t tilesRendered = 0;
+  };
+
+  /**
+   * What the manager remembers about a tileset between frames.
+   */
+  struct TilesetState {
+    TilesetDemand demand;
+    glm::dmat4 unrealWorldToTileset{0.0};
+  };
+
+  struct TilesetEntry {
+    ACesium3DTileset* pTileset;
+    TilesetDemand demand;
+    int32 maximumSimultaneousTileLoads;
+    int64 maximumCachedBytes;
+  };
+
+  void distributeTileLoads(
+      std::vector<TilesetEntry>& entries,
+      int32 totalTileLoads) const;
+  void distributeCachedBytes(
+      std::vector<TilesetEntry>& entries,
+      int64 totalCachedBytes) const;
+
+  TArray<TWeakObjectPtr<ACesium3DTileset>> _tilesetsToUpdate;
+  TMap<TWeakObjectPtr<ACesium3DTileset>, TilesetState> _states;
+  std::vector<FCesiumCamera> _lastCameras;
+};
@@ -0,0 +1,73 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CesiumTilesetMemoryUsage.generated.h"
+
+/**
+ * The memory used by the loaded tiles of a tileset, in bytes.
+ */
+USTRUCT(BlueprintType)
+struct CESIUMRUNTIME_API FCesiumTilesetMemoryUsage {
+  GENERATED_USTRUCT_BODY()
+
+public:
+  /**
+   * The bytes of the tile content held by cesium-native, such as the glTF
+   * buffers and images that the renderer resources were created from.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 ModelBytes = 0;
+
+  /**
+   * The bytes of the vertex and index buffers of the tiles, and of the
+   * per-instance data of instanced primitives.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 GeometryBytes = 0;
+
+  /**
+   * The bytes of the textures of the tiles, including the textures of the
+   * raster overlays draped over them.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 TextureBytes = 0;
+
+  /**
+   * The bytes of the collision meshes of the tiles.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 PhysicsBytes = 0;
+
+  /**
+   * Gets the bytes of all resources created for the renderer and the physics
+   * engine, that is, everything except the ModelBytes.
+   */
+  int64 GetRendererBytes() const {
+    return this->GeometryBytes + this->TextureBytes + this->PhysicsBytes;
+  }
+
+  /**
+   * Gets the bytes of all resources.
+   */
+  int64 GetTotalBytes() const {
+    return this->ModelBytes + this->GetRendererBytes();
+  }
+
+  FCesiumTilesetMemoryUsage& operator+=(const FCesiumTilesetMemoryUsage& rhs) {
+    this->ModelBytes += rhs.ModelBytes;
+    this->GeometryBytes += rhs.GeometryBytes;
+    this->TextureBytes += rhs.TextureBytes;
+    this->PhysicsBytes += rhs.PhysicsBytes;
+    return *this;
+  }
+
+  FCesiumTilesetMemoryUsage& operator-=(const FCesiumTilesetMemoryUsage& rhs) {
+    this->ModelBytes -= rhs.ModelBytes;
+    this->GeometryBytes -= rhs.GeometryBytes;
+    this->TextureBytes -= rhs.TextureBytes;
+    this->PhysicsBytes -= rhs.PhysicsBytes;
+    return *this;
+  }
+};
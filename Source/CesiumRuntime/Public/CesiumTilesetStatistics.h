@@ -0,0 +1,188 @@
+// Copyright 2020-2021 CesiumGS, Inc. and Contributors
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CesiumTilesetStatistics.generated.h"
+
+/**
+ * The latencies of one stage of the tile loading pipeline.
+ */
+USTRUCT(BlueprintType)
+struct CESIUMRUNTIME_API FCesiumLatencyStatistics {
+  GENERATED_USTRUCT_BODY()
+
+public:
+  /**
+   * The number of times the stage completed.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 Count = 0;
+
+  /**
+   * The average time the stage took, in milliseconds.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  float AverageMilliseconds = 0.0f;
+
+  /**
+   * The longest time the stage took, in milliseconds.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  float MaximumMilliseconds = 0.0f;
+
+  /**
+   * The number of times the stage took a time in each range. The first entry
+   * counts times below 1 ms, entry i counts times from 2^(i-1) ms up to 2^i ms,
+   * and the last entry counts times of 1024 ms and above.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  TArray<int64> Histogram;
+};
+
+/**
+ * Statistics about the tile loading pipeline of a tileset, which are updated
+ * once per frame.
+ *
+ * Tiles are requested, then prepared for rendering in a worker thread, and
+ * finally turned into Unreal components in the game thread, whose meshes,
+ * materials and textures are only created when the tile is first shown. The
+ * counts and latencies are accumulated since the tileset was loaded or since
+ * the statistics were last reset, the other values describe the last frame.
+ */
+USTRUCT(BlueprintType)
+struct CESIUMRUNTIME_API FCesiumTilesetStatistics {
+  GENERATED_USTRUCT_BODY()
+
+public:
+  /**
+   * The number of tiles rendered in the last frame.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 TilesRendered = 0;
+
+  /**
+   * The number of tiles that the tile selection wants to load, but whose
+   * loading has not started yet.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 TilesWaitingToLoad = 0;
+
+  /**
+   * The number of requests that have not completed yet, including requests
+   * that are answered from the request cache.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 RequestsInFlight = 0;
+
+  /**
+   * The number of tiles that are being prepared for rendering in a worker
+   * thread.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 LoadThreadPreparesInFlight = 0;
+
+  /**
+   * The number of tiles that were prepared in a worker thread and wait for
+   * their Unreal components to be created in the game thread.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 MainThreadPreparesPending = 0;
+
+  /**
+   * The number of loaded tiles whose meshes, materials and textures have not
+   * been created yet, because they have not been shown yet.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 TilesWaitingToBeShown = 0;
+
+  /**
+   * The time from starting a request until its response is available.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  FCesiumLatencyStatistics RequestLatency;
+
+  /**
+   * The time spent preparing a tile for rendering in a worker thread, which
+   * includes building its meshes, textures and collision meshes.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  FCesiumLatencyStatistics LoadThreadLatency;
+
+  /**
+   * The time spent creating the meshes, materials and textures of a tile in
+   * the game thread when it is first shown.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  FCesiumLatencyStatistics MainThreadLatency;
+
+  /**
+   * The number of completed requests.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 Requests = 0;
+
+  /**
+   * The number of completed requests that were answered from the request
+   * cache, without downloading the response.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 CacheHits = 0;
+
+  /**
+   * The fraction of the completed requests that were answered from the
+   * request cache, from 0.0 to 1.0.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  float CacheHitRate = 0.0f;
+
+  /**
+   * The number of bytes downloaded.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 BytesDownloaded = 0;
+
+  /**
+   * The number of loaded tiles that were shown.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 TilesShown = 0;
+
+  /**
+   * The number of loaded tiles that were unloaded without ever being shown,
+   * for example because the camera moved on while they were loading. Their
+   * download and preparation in a worker thread were wasted, but no meshes,
+   * materials or textures were created for them.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int64 TilesDiscarded = 0;
+
+  /**
+   * The fraction of the loaded tiles that were unloaded without ever being
+   * shown, from 0.0 to 1.0.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  float DiscardedTileRate = 0.0f;
+
+  /**
+   * The number of tiles whose meshes, materials and textures were created in
+   * the last frame, because they were shown for the first time.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 TilesCreatedLastFrame = 0;
+
+  /**
+   * The number of tiles that were shown and whose Unreal components were
+   * destroyed in the last frame.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  int32 TilesDestroyedLastFrame = 0;
+
+  /**
+   * The time the tileset spent in the game thread in the last frame, in
+   * milliseconds. This includes tile selection, creating and destroying the
+   * Unreal components of tiles, and showing and hiding them.
+   */
+  UPROPERTY(BlueprintReadOnly, Category = "Cesium")
+  float GameThreadMilliseconds = 0.0f;
+};
@@ -158,6 +158,7 @@ public:
 
   virtual bool ShouldTickIfViewportsOnly() const override;
   virtual void Tick(float DeltaSeconds) override;
+  virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
   virtual void PostLoad() override;
   // virtual void Serialize(FArchive& Ar) override;
 
@@ -212,6 +213,18 @@ private:
    */
   void _handleFlightStep(float DeltaSeconds);
 
+  /**
+   * @brief Registers views along the current flight with the
+   * UCesiumCameraSubsystem, so that tilesets can prefetch the tiles needed
+   * during the flight and at its destination.
+   */
+  void _addFlightPrefetchCameras();
+
+  /**
+   * @brief Removes the views registered by _addFlightPrefetchCameras, if any.
+   */
+  void _removeFlightPrefetchCameras();
+
   // helper variables for FlyToLocation
   bool _bFlyingToLocation = false;
   bool _bCanInterruptFlight = false;
@@ -220,4 +233,8 @@ private:
   FQuat _flyToDestinationRotation;
 
   std::vector<glm::dvec3> _keypoints;
+
+  // The ID of the prefetch cameras of the current flight, or -1 if there are
+  // none.
+  int32 _flightPrefetchId = -1;
 };
@@ -4,12 +4,30 @@
 
 #include "CesiumAsync/AsyncSystem.h"
 #include "CesiumAsync/IAssetAccessor.h"
+#include "UnrealTaskProcessor.h"
+#include <atomic>
 #include <cstddef>
 
+/**
+ * Requests assets with Unreal's HTTP module.
+ *
+ * GET requests are scheduled with the requests of all other accessors, with a
+ * limit on the requests in flight to each host that adapts to how the host
+ * responds. A GET request for an asset that is already being requested with
+ * the same headers, for example by another tileset or raster overlay, is not
+ * sent again. It is resolved with the response of the request in flight
+ * instead.
+ */
 class CESIUMRUNTIME_API UnrealAssetAccessor
     : public CesiumAsync::IAssetAccessor {
 public:
-  UnrealAssetAccessor();
+  using Priority = UnrealTaskProcessor::Priority;
+
+  /**
+   * Creates an accessor whose GET requests are started before the waiting
+   * requests of lower priority to the same host.
+   */
+  UnrealAssetAccessor(Priority priority = Priority::High);
 
   virtual CesiumAsync::Future<std::shared_ptr<CesiumAsync::IAssetRequest>>
   requestAsset(
@@ -26,6 +44,16 @@ public:
 
   virtual void tick() noexcept override;
 
+  /**
+   * Cancels the GET requests of this accessor that are queued or in flight,
+   * and rejects all GET requests that are made afterwards. It is called when
+   * the assets are no longer needed, for example before the tileset that
+   * requested them is destroyed, so that it does not wait for them.
+   */
+  void cancelRequests();
+
 private:
+  Priority _priority;
   FString _userAgent;
+  std::atomic<bool> _cancelled;
 };
@@ -4,8 +4,36 @@
 
 #include "CesiumAsync/ITaskProcessor.h"
 
+/**
+ * @brief Runs the tasks of cesium-native in Cesium's own pool of worker
+ * threads, rather than in Unreal's task graph, so that tile loading does not
+ * compete with the engine's work in the task graph.
+ */
 class CESIUMRUNTIME_API UnrealTaskProcessor
     : public CesiumAsync::ITaskProcessor {
 public:
+  /**
+   * @brief The priority of the tasks started by a task processor.
+   *
+   * The worker threads only run low priority tasks when there are no high
+   * priority tasks waiting.
+   */
+  enum class Priority {
+    /**
+     * @brief For work that is needed for the current views.
+     */
+    High,
+
+    /**
+     * @brief For work that will only be needed later, such as prefetching.
+     */
+    Low
+  };
+
+  UnrealTaskProcessor(Priority priority = Priority::High);
+
   virtual void startTask(std::function<void()> f) override;
-};
\ No newline at end of file
+
+private:
+  Priority _priority;
+};